@@ -2,6 +2,18 @@
 
 
 #include <stdint.h>
+#include <stddef.h>
+#include <math.h>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define DUMMY_HAS_MMAP 1
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#else
+#define DUMMY_HAS_MMAP 0
+#endif
 
 // Define Arduino constants
 #define HIGH 0x1
@@ -9,19 +21,223 @@
 #define INPUT 0x0
 #define OUTPUT 0x1
 
+// Define analog pins (as on the Uno/Micro)
+#define A0 14
+#define A1 15
+#define A2 16
+#define A3 17
+#define A4 18
+#define A5 19
+#define A6 20
+#define A7 21
+
 // Define Arduino types and functions
 typedef unsigned long millis_t;
 
+// Deterministic virtual time. millis()/micros() never read a real clock: time only moves when the
+// host code moves it, so runs are repeatable and can go much faster (or slower) than real time.
+//   - manually: dummyAdvanceMicros()/dummySetMicros(), or delay()/delayMicroseconds(), which
+//     advance the clock instead of sleeping
+//   - in lockstep with the code under test: dummySetAutoAdvance() advances the clock on every
+//     millis()/micros() call and dummySetAnalogReadMicros() on every analogRead() (the ADC
+//     conversion time, ~112us on an AVR at 16 MHz)
+// millis()/micros() wrap at DUMMY_CLOCK_BITS bits. That defaults to the width of millis_t, which on
+// an LP64 host is 64 bits, so they never wrap in practice (and TimeElapsed/TaskScheduler, whose
+// differences are taken in unsigned long, stay correct however long a replay runs). Define it as 32
+// to get a board's wrap, at 2^32us (~71.6 minutes) for micros(), e.g. to check code that keeps its
+// time differences in uint32_t.
+#ifndef DUMMY_CLOCK_BITS
+#define DUMMY_CLOCK_BITS (sizeof(millis_t) * 8) ///< width at which millis()/micros() wrap
+#endif
+
+/// @return millis_t t wrapped to DUMMY_CLOCK_BITS bits
+inline millis_t dummyClockWrap(uint64_t t) {
+	return DUMMY_CLOCK_BITS >= 64 ? (millis_t)t : (millis_t)(t & ((1ull << (DUMMY_CLOCK_BITS % 64)) - 1));
+}
+
+struct DummyClock {
+	uint64_t us = 0;
+	unsigned long advance_per_call_us = 0;  ///< added after each millis()/micros() call
+	unsigned long advance_per_read_us = 0;  ///< added after each analogRead()
+};
+
+inline DummyClock& dummyClock() {
+	static DummyClock clock;
+	return clock;
+}
+
+/// @return uint64_t virtual time in microseconds (never wraps, does not auto-advance)
+inline uint64_t dummyMicros64() { return dummyClock().us; }
+
+inline void dummySetMicros(uint64_t us) { dummyClock().us = us; }
+
+inline void dummyAdvanceMicros(uint64_t us) { dummyClock().us += us; }
+
+inline void dummySetAutoAdvance(unsigned long us_per_call) { dummyClock().advance_per_call_us = us_per_call; }
+
+inline void dummySetAnalogReadMicros(unsigned long us_per_read) { dummyClock().advance_per_read_us = us_per_read; }
+
 inline millis_t millis() {
-	return 0;  // Dummy implementation
+	DummyClock& clock = dummyClock();
+	millis_t t = dummyClockWrap(clock.us / 1000);
+	clock.us += clock.advance_per_call_us;
+	return t;
 }
 
 inline millis_t micros() {
-	return 0;  // Dummy implementation
+	DummyClock& clock = dummyClock();
+	millis_t t = dummyClockWrap(clock.us);
+	clock.us += clock.advance_per_call_us;
+	return t;
 }
 
 inline void delay(millis_t ms) {
-	// Dummy implementation
+	dummyClock().us += (uint64_t)ms * 1000;
+}
+
+inline void delayMicroseconds(unsigned int us) {
+	dummyClock().us += us;
+}
+
+// Analog inputs. A pin either replays a recorded trace (dummyLoadAnalogTrace()/dummySetAnalogTrace())
+// or produces a synthetic signal (dummySetAnalogSignal()):
+//   offset + amplitude * sin(2*pi * n/period_reads) + uniform noise in [-noise, noise], clamped to 0...1023,
+// where n counts that pin's reads. Pins that were never configured read 512 (the 10-bit ADC midpoint).
+//
+// A trace is an array of raw ADC codes (uint16_t, native byte order). With a sample period it is
+// replayed against the virtual clock: analogRead() returns the sample at
+// (dummyMicros64() - start) / period_us, so the code under test sees the signal it would have seen
+// at that time however often it reads. With period_us=0 each read returns the next sample. Past the
+// end a trace either loops or holds its last sample (see dummyAnalogTraceDone()).
+struct DummyAnalogSignal {
+	int offset = 512;
+	int amplitude = 0;
+	unsigned long period_reads = 0; ///< 0 disables the sine
+	int noise = 0;
+	unsigned long n_reads = 0;
+
+	const uint16_t* trace = nullptr; ///< replayed instead of the synthetic signal if set
+	size_t trace_size = 0;
+	unsigned long trace_period_us = 0;
+	uint64_t trace_start_us = 0;
+	bool trace_loop = false;
+	void* trace_map = nullptr;       ///< the mapping when the trace was loaded from a file
+	size_t trace_map_size = 0;
+};
+
+#define DUMMY_ANALOG_PINS 32
+
+inline DummyAnalogSignal* dummyAnalogSignals() {
+	static DummyAnalogSignal signals[DUMMY_ANALOG_PINS];
+	return signals;
+}
+
+inline void dummySetAnalogSignal(uint8_t pin, int offset, int amplitude=0, unsigned long period_reads=0, int noise=0) {
+	DummyAnalogSignal& sig = dummyAnalogSignals()[pin % DUMMY_ANALOG_PINS];
+	sig.offset = offset;
+	sig.amplitude = amplitude;
+	sig.period_reads = period_reads;
+	sig.noise = noise;
+	sig.n_reads = 0;
+}
+
+/// @brief stops replaying a pin's trace (unmapping it if it was loaded from a file)
+inline void dummyClearAnalogTrace(uint8_t pin) {
+	DummyAnalogSignal& sig = dummyAnalogSignals()[pin % DUMMY_ANALOG_PINS];
+#if DUMMY_HAS_MMAP
+	if (sig.trace_map) munmap(sig.trace_map, sig.trace_map_size);
+#endif
+	sig.trace = nullptr;
+	sig.trace_size = 0;
+	sig.trace_map = nullptr;
+	sig.trace_map_size = 0;
+}
+
+/**
+ * @brief replays samples (not copied, must outlive the replay) on a pin, starting now
+ * @param period_us time between samples in virtual microseconds, or 0 for one sample per read
+ * @param loop (default=false) if true the trace repeats, else it holds its last sample
+ */
+inline void dummySetAnalogTrace(uint8_t pin, const uint16_t* samples, size_t size, unsigned long period_us, bool loop=false) {
+	dummyClearAnalogTrace(pin);
+	DummyAnalogSignal& sig = dummyAnalogSignals()[pin % DUMMY_ANALOG_PINS];
+	sig.trace = size ? samples : nullptr;
+	sig.trace_size = size;
+	sig.trace_period_us = period_us;
+	sig.trace_start_us = dummyMicros64();
+	sig.trace_loop = loop;
+	sig.n_reads = 0;
+}
+
+/// @brief replays a pin's trace again from its first sample, starting now
+inline void dummyRestartAnalogTrace(uint8_t pin) {
+	DummyAnalogSignal& sig = dummyAnalogSignals()[pin % DUMMY_ANALOG_PINS];
+	sig.trace_start_us = dummyMicros64();
+	sig.n_reads = 0;
+}
+
+#if DUMMY_HAS_MMAP
+/**
+ * @brief memory-maps a recorded trace file and replays it on a pin (see dummySetAnalogTrace()).
+ * Pages are read from disk as the replay reaches them, so traces can be much larger than memory.
+ * @param header_bytes (default=0) bytes to skip at the start of the file; must be even, since the
+ * samples are read in place as uint16_t (the mapping itself is page-aligned)
+ * @return long number of samples, or -1 if the file couldn't be opened or mapped or header_bytes is odd
+ */
+inline long dummyLoadAnalogTrace(uint8_t pin, const char* path, unsigned long period_us, bool loop=false, size_t header_bytes=0) {
+	if (header_bytes % alignof(uint16_t)) return -1;
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return -1;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || (size_t)st.st_size <= header_bytes) { close(fd); return -1; }
+	void* map = mmap(nullptr, (size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd);
+	if (map == MAP_FAILED) return -1;
+	madvise(map, (size_t)st.st_size, MADV_SEQUENTIAL);
+
+	size_t size = ((size_t)st.st_size - header_bytes) / sizeof(uint16_t);
+	dummySetAnalogTrace(pin, (const uint16_t*)((const char*)map + header_bytes), size, period_us, loop);
+	DummyAnalogSignal& sig = dummyAnalogSignals()[pin % DUMMY_ANALOG_PINS];
+	sig.trace_map = map;
+	sig.trace_map_size = (size_t)st.st_size;
+	return (long)size;
+}
+#endif
+
+/// @return size_t index of the trace sample a read of this pin would return now
+inline size_t dummyAnalogTraceIndex(uint8_t pin) {
+	const DummyAnalogSignal& sig = dummyAnalogSignals()[pin % DUMMY_ANALOG_PINS];
+	uint64_t i = sig.trace_period_us ? (dummyMicros64() - sig.trace_start_us) / sig.trace_period_us : sig.n_reads;
+	return i > (uint64_t)SIZE_MAX ? SIZE_MAX : (size_t)i;
+}
+
+/// @return bool true if a non-looping trace has been replayed to its end (or the pin has no trace)
+inline bool dummyAnalogTraceDone(uint8_t pin) {
+	const DummyAnalogSignal& sig = dummyAnalogSignals()[pin % DUMMY_ANALOG_PINS];
+	return !sig.trace || (!sig.trace_loop && dummyAnalogTraceIndex(pin) >= sig.trace_size);
+}
+
+inline int analogRead(uint8_t pin) {
+	static uint32_t lcg = 12345; // deterministic noise so runs are repeatable
+	DummyAnalogSignal& sig = dummyAnalogSignals()[pin % DUMMY_ANALOG_PINS];
+	int n;
+	if (sig.trace) {
+		size_t i = dummyAnalogTraceIndex(pin);
+		if (i >= sig.trace_size) i = sig.trace_loop ? i % sig.trace_size : sig.trace_size - 1;
+		n = sig.trace[i];
+	} else {
+		double v = sig.offset;
+		if (sig.period_reads) v += sig.amplitude * sin(6.283185307179586 * (double)(sig.n_reads % sig.period_reads) / sig.period_reads);
+		if (sig.noise) {
+			lcg = lcg * 1664525u + 1013904223u;
+			v += (int)(lcg >> 16) % (2 * sig.noise + 1) - sig.noise;
+		}
+		n = (int)(v + 0.5);
+		n = n < 0 ? 0 : (n > 1023 ? 1023 : n);
+	}
+	++sig.n_reads;
+	dummyClock().us += dummyClock().advance_per_read_us;
+	return n;
 }
 
 // Add other necessary Arduino functions and types as needed
\ No newline at end of file
@@ -0,0 +1,213 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdarg.h>
+#include <errno.h>
+#include <time.h>
+#include <algorithm>
+#include <atomic>
+#include <new>
+#include <vector>
+
+#include "TimeElapsedClocks.h"
+#include "cpu_dispatch.h"
+
+//**** allocation counting ***************************************************
+
+// atomic: ThreadPool workers allocate concurrently in the parallel suites (constant-initialized,
+// so it is usable by allocations made before main())
+#if defined(__GLIBC__)
+static std::atomic<unsigned long long> g_mallocs{0};
+static const bool g_counting_allocs = true;
+
+extern "C" void* __libc_malloc(size_t size);
+extern "C" void* __libc_calloc(size_t n, size_t size);
+extern "C" void* __libc_realloc(void* ptr, size_t size);
+extern "C" void* __libc_memalign(size_t alignment, size_t size);
+
+extern "C" void* malloc(size_t size) { g_mallocs.fetch_add(1, std::memory_order_relaxed); return __libc_malloc(size); }
+extern "C" void* calloc(size_t n, size_t size) { g_mallocs.fetch_add(1, std::memory_order_relaxed); return __libc_calloc(n, size); }
+extern "C" void* realloc(void* ptr, size_t size) { g_mallocs.fetch_add(1, std::memory_order_relaxed); return __libc_realloc(ptr, size); }
+
+// the aligned allocators (alignas() types such as ShardedWelford's shards come through these)
+extern "C" void* memalign(size_t alignment, size_t size) { g_mallocs.fetch_add(1, std::memory_order_relaxed); return __libc_memalign(alignment, size); }
+extern "C" void* aligned_alloc(size_t alignment, size_t size) { return memalign(alignment, size); }
+extern "C" int posix_memalign(void** ptr, size_t alignment, size_t size) {
+	if (!alignment || (alignment & (alignment - 1)) || alignment % sizeof(void*)) return EINVAL;
+	void* p = memalign(alignment, size);
+	if (!p) return ENOMEM;
+	*ptr = p;
+	return 0;
+}
+
+// libstdc++ builds every other aligned new (array, nothrow) on this one; freed by the default aligned delete
+void* operator new(size_t size, std::align_val_t alignment) {
+	size_t a = (size_t)alignment < sizeof(void*) ? sizeof(void*) : (size_t)alignment;
+	for (;;) {
+		if (void* p = memalign(a, size ? size : 1)) return p;
+		std::new_handler handler = std::get_new_handler();
+		if (!handler) throw std::bad_alloc();
+		handler();
+	}
+}
+#else
+static std::atomic<unsigned long long> g_mallocs{0};
+static const bool g_counting_allocs = false;
+#endif
+
+//**** registry **************************************************************
+
+struct BenchSuite {
+	const char* name;
+	BenchSuiteFunc func;
+};
+
+static std::vector<BenchSuite>& suites() {
+	static std::vector<BenchSuite> s;
+	return s;
+}
+
+BenchSuiteRegistrar::BenchSuiteRegistrar(const char* name, BenchSuiteFunc func) {
+	suites().push_back(BenchSuite{name, func});
+}
+
+static BenchOptions g_options;
+static const char* g_current_suite = "";
+static std::vector<BenchResult> g_results;
+static FILE* g_table = stdout; // stderr when the JSON goes to stdout
+
+std::string benchFmt(const char* fmt, ...) {
+	char buf[256];
+	va_list args;
+	va_start(args, fmt);
+	vsnprintf(buf, sizeof(buf), fmt, args);
+	va_end(args);
+	return buf;
+}
+
+//**** measuring *************************************************************
+
+void benchMeasure(const char* name, const std::string& params, double items_per_op, void (*op)(void*, uint64_t), void* ctx) {
+	std::string full = std::string(g_current_suite) + "/" + name;
+	if (!g_options.filter.empty() && (full + " " + params).find(g_options.filter) == std::string::npos) return;
+
+	// warm up, then grow the batch until it takes at least min_time_ms
+	uint64_t min_ns = (uint64_t)(g_options.min_time_ms * 1e6);
+	uint64_t iterations = 1;
+	op(ctx, 1);
+	for (;;) {
+		uint64_t t0 = SteadyClock::now();
+		op(ctx, iterations);
+		uint64_t ns = SteadyClock::now() - t0;
+		if (ns >= min_ns || iterations >= (1ull << 40)) break;
+		uint64_t grow = ns ? (uint64_t)(1.2 * min_ns / ns * iterations) : iterations * 10;
+		iterations = std::max(iterations + 1, std::min(grow, iterations * 10));
+	}
+
+	std::vector<double> ns_per_op;
+	ns_per_op.reserve(g_options.reps); // so the vector itself isn't counted as an allocation
+	unsigned long long mallocs_before = g_mallocs.load(std::memory_order_relaxed);
+	for (int r = 0; r < g_options.reps; r++) {
+		uint64_t t0 = SteadyClock::now();
+		op(ctx, iterations);
+		ns_per_op.push_back((double)(SteadyClock::now() - t0) / iterations);
+	}
+	unsigned long long mallocs = g_mallocs.load(std::memory_order_relaxed) - mallocs_before;
+	std::sort(ns_per_op.begin(), ns_per_op.end());
+
+	BenchResult res;
+	res.suite = g_current_suite;
+	res.name = name;
+	res.params = params;
+	res.iterations = iterations;
+	res.ns_per_op_min = ns_per_op.front();
+	res.ns_per_op_median = ns_per_op[ns_per_op.size() / 2];
+	res.ops_per_sec = 1e9 / res.ns_per_op_median;
+	res.items_per_sec = items_per_op * res.ops_per_sec;
+	res.allocs_per_op = g_counting_allocs ? (double)mallocs / ((double)iterations * g_options.reps) : -1;
+	g_results.push_back(res);
+
+	fprintf(g_table, "%-44s %-22s %12.1f %12.1f %14.4g %14.4g %9.2f\n", full.c_str(), params.c_str(), res.ns_per_op_min,
+		res.ns_per_op_median, res.ops_per_sec, res.items_per_sec, res.allocs_per_op);
+	fflush(g_table);
+}
+
+//**** output ****************************************************************
+
+static void jsonString(FILE* f, const std::string& s) {
+	fputc('"', f);
+	for (char c : s) {
+		if (c == '"' || c == '\\') fprintf(f, "\\%c", c);
+		else if (c == '\n') fputs("\\n", f);
+		else if (c == '\t') fputs("\\t", f);
+		else if ((unsigned char)c < 0x20) fprintf(f, "\\u%04x", (unsigned char)c);
+		else fputc(c, f);
+	}
+	fputc('"', f);
+}
+
+static void writeJson(FILE* f) {
+	ClockCalibration cal = clockCalibrate<SteadyClock>();
+	fprintf(f, "{\n  \"timestamp\": %lld,\n", (long long)time(nullptr));
+	fprintf(f, "  \"clock\": {\"name\": \"steady_clock\", \"read_overhead_ns\": %.2f, \"resolution_ns\": %llu},\n",
+		cal.read_overhead_ns, (unsigned long long)cal.resolution_ns);
+	fprintf(f, "  \"options\": {\"min_time_ms\": %g, \"reps\": %d},\n", g_options.min_time_ms, g_options.reps);
+#if IS_HAS_CPU_DISPATCH
+	fprintf(f, "  \"cpu\": {\"detected\": \"%s\", \"kernels\": \"%s\"},\n", cpuDispatchName(cpuDispatchDetected()),
+		cpuDispatchName(cpuKernels().level));
+#endif
+	fprintf(f, "  \"results\": [\n");
+	for (size_t i = 0; i < g_results.size(); i++) {
+		const BenchResult& r = g_results[i];
+		fprintf(f, "    {\"suite\": ");
+		jsonString(f, r.suite);
+		fprintf(f, ", \"name\": ");
+		jsonString(f, r.name);
+		fprintf(f, ", \"params\": ");
+		jsonString(f, r.params);
+		fprintf(f, ", \"iterations\": %llu, \"ns_per_op_min\": %.3f, \"ns_per_op_median\": %.3f, "
+			"\"ops_per_sec\": %.6g, \"items_per_sec\": %.6g, \"allocs_per_op\": %.3f}%s\n",
+			(unsigned long long)r.iterations, r.ns_per_op_min, r.ns_per_op_median, r.ops_per_sec,
+			r.items_per_sec, r.allocs_per_op, i + 1 < g_results.size() ? "," : "");
+	}
+	fprintf(f, "  ]\n}\n");
+}
+
+static void usage(const char* argv0) {
+	printf("usage: %s [--json FILE|-] [--filter TEXT] [--min-time-ms MS] [--reps N] [--list]\n", argv0);
+}
+
+int main(int argc, char** argv) {
+	const char* json_path = nullptr;
+	bool list = false;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--json") && i + 1 < argc) json_path = argv[++i];
+		else if (!strcmp(argv[i], "--filter") && i + 1 < argc) g_options.filter = argv[++i];
+		else if (!strcmp(argv[i], "--min-time-ms") && i + 1 < argc) g_options.min_time_ms = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--reps") && i + 1 < argc) g_options.reps = std::max(1, atoi(argv[++i]));
+		else if (!strcmp(argv[i], "--list")) list = true;
+		else { usage(argv[0]); return strcmp(argv[i], "--help") ? 1 : 0; }
+	}
+
+	if (list) {
+		for (const BenchSuite& s : suites()) printf("%s\n", s.name);
+		return 0;
+	}
+
+	if (json_path && !strcmp(json_path, "-")) g_table = stderr;
+	fprintf(g_table, "%-44s %-22s %12s %12s %14s %14s %9s\n", "case", "params", "ns/op(min)", "ns/op(med)", "ops/s", "items/s", "allocs/op");
+	for (const BenchSuite& s : suites()) {
+		g_current_suite = s.name;
+		s.func();
+	}
+
+	if (json_path) {
+		FILE* f = strcmp(json_path, "-") ? fopen(json_path, "w") : stdout;
+		if (!f) { perror(json_path); return 1; }
+		writeJson(f);
+		if (f != stdout) fclose(f);
+	}
+	return 0;
+}
@@ -0,0 +1,81 @@
+#pragma once
+
+/**************************************************************************************************
+* @file  bench.h
+*
+* @brief minimal microbenchmark harness for is_eeMath (host only)
+***************************************************************************************************/
+
+/*
+	Each bench_*.cpp registers one or more suites with IS_BENCH_SUITE(name) { ... }, and inside a
+	suite each case is measured with benchRun(). benchRun() calibrates the iteration count so a batch
+	takes at least --min-time-ms, runs --reps batches and reports the fastest and median ns/op,
+	throughput (ops/s and items/s) and heap allocations per op (malloc/calloc/realloc and aligned
+	allocation calls, counted by interposing them on glibc).
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+
+/// @brief keeps the compiler from optimizing away a value or the work that produced it
+template <typename T>
+inline void benchKeep(T const& value) {
+	asm volatile("" : : "r,m"(value) : "memory");
+}
+
+/// @brief keeps the compiler from assuming anything about memory (e.g. after writing outputs)
+inline void benchClobber() {
+	asm volatile("" : : : "memory");
+}
+
+struct BenchResult {
+	std::string suite;
+	std::string name;
+	std::string params;
+	uint64_t iterations;      ///< ops per batch
+	double ns_per_op_min;     ///< fastest batch
+	double ns_per_op_median;  ///< median batch
+	double ops_per_sec;       ///< from the median
+	double items_per_sec;     ///< from the median, 0 if items_per_op was 0
+	double allocs_per_op;     ///< allocation calls per op (-1 if allocations can't be counted here)
+};
+
+struct BenchOptions {
+	double min_time_ms = 20;  ///< minimum time per batch
+	int reps = 5;             ///< batches per case
+	std::string filter;       ///< only run cases whose "suite/name" contains this
+};
+
+typedef void (*BenchSuiteFunc)();
+
+struct BenchSuiteRegistrar {
+	BenchSuiteRegistrar(const char* name, BenchSuiteFunc func);
+};
+
+#define IS_BENCH_SUITE(name) \
+	static void bench_suite_##name(); \
+	static BenchSuiteRegistrar bench_suite_registrar_##name(#name, bench_suite_##name); \
+	static void bench_suite_##name()
+
+/// @brief (internal) measures one case. Use benchRun().
+void benchMeasure(const char* name, const std::string& params, double items_per_op, void (*op)(void*, uint64_t), void* ctx);
+
+/**
+ * @brief measures op(), called iterations times per batch
+ *
+ * @param name case name, e.g. "polyfit"
+ * @param params parameters that distinguish this case, e.g. "size=256 deg=3"
+ * @param items_per_op work items each op processes (e.g. data points), for items/s (0 for none)
+ * @param op the operation; it must benchKeep() its result
+ */
+template <typename Op>
+void benchRun(const char* name, const std::string& params, double items_per_op, Op op) {
+	benchMeasure(name, params, items_per_op, [](void* ctx, uint64_t iterations) {
+		Op& f = *(Op*)ctx;
+		for (uint64_t i = 0; i < iterations; i++) f();
+	}, &op);
+}
+
+/// @return std::string printf-style formatting, for params
+std::string benchFmt(const char* fmt, ...);
@@ -0,0 +1,67 @@
+#include "bench.h"
+
+#include "TimeElapsed.h"
+#include "TimeElapsedClocks.h"
+#include "TimeElapsedGroup.h"
+#include "LatencyHistogram.h"
+
+// a time function that advances on every call, so TimeElapsed does real work without touching
+// Arduino_dummy's virtual clock
+static TimeElapsed_t g_fake_time = 2;
+static TimeElapsed_t benchTimeFunc() { return g_fake_time += 3; }
+
+template <typename Clock>
+static void benchClock(const char* name) {
+	benchRun(name, "now()", 1, [] { benchKeep(Clock::now()); });
+	ClockTimeElapsed<Clock> te(true);
+	benchRun(name, "ClockTimeElapsed::elapsed()", 1, [&] { benchKeep(te.elapsed()); });
+}
+
+IS_BENCH_SUITE(TimeElapsed) {
+	TimeElapsed te(true, benchTimeFunc);
+	benchRun("TimeElapsed::elapsed", "time_func", 1, [&] { benchKeep(te.elapsed()); });
+
+	TimeElapsed_t now = 100;
+	benchRun("TimeElapsed::elapsed", "update=now", 1, [&] { benchKeep(te.elapsed(now += 3)); });
+
+	benchRun("TimeElapsed::pause+resume", "time_func", 1, [&] {
+		te.pause();
+		benchKeep(te.resume());
+	});
+
+	const int n_timers = TIMEELAPSEDGROUP_MAX;
+	TimeElapsedGroup group(benchTimeFunc);
+	for (int i = 0; i < n_timers; i++) group.add(i % 4 != 3); // a quarter stopped
+	benchRun("TimeElapsedGroup::tick", benchFmt("timers=%d", n_timers), n_timers, [&] { benchKeep(group.tick()); });
+
+	TimeElapsed singles[TIMEELAPSEDGROUP_MAX];
+	for (int i = 0; i < n_timers; i++) singles[i] = TimeElapsed(true, benchTimeFunc);
+	benchRun("TimeElapsed::elapsed x n", benchFmt("timers=%d", n_timers), n_timers, [&] {
+		for (int i = 0; i < n_timers; i++) benchKeep(singles[i].elapsed());
+	});
+
+	// latency distribution: record() cost, queries, and elapsed() feeding a histogram via the hook
+	LatencyHistogram<> hist, other;
+	uint32_t value = 1;
+	benchRun("LatencyHistogram::record", benchFmt("%d bytes", (int)sizeof(hist)), 1, [&] {
+		value = value * 1664525u + 1013904223u;
+		hist.record(value >> (12 + (value & 7)));
+	});
+	benchRun("LatencyHistogram::valueAtPercentile", "p99.9", 1, [&] { benchKeep(hist.valueAtPercentile(99.9)); });
+	benchRun("LatencyHistogram::merge", benchFmt("counts=%d", hist.COUNTS_LEN), 1, [&] {
+		other.merge(hist);
+		benchKeep(other.count());
+	});
+
+	TimeElapsed hooked(true, benchTimeFunc);
+	hist.attach(hooked);
+	benchRun("TimeElapsed::elapsed", "time_func + LatencyHistogram", 1, [&] { benchKeep(hooked.elapsed()); });
+
+	benchClock<SteadyClock>("SteadyClock");
+#if defined(CLOCK_MONOTONIC_RAW)
+	benchClock<MonotonicRawClock>("MonotonicRawClock");
+#endif
+#if defined(TIMEELAPSED_HAS_TSC)
+	benchClock<TscClock>("TscClock");
+#endif
+}
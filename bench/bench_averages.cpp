@@ -0,0 +1,74 @@
+#include "bench.h"
+
+#include <math.h>
+#include <mutex>
+#include <vector>
+
+#include "welford_averages.h"
+#include "ShardedWelford.h"
+#include "ThreadPool.h"
+
+#define BENCH_AVG_BLOCK 1024
+
+IS_BENCH_SUITE(averages) {
+	std::vector<float> in(BENCH_AVG_BLOCK);
+	for (int i = 0; i < BENCH_AVG_BLOCK; i++) in[i] = 512 + 3 * sinf(i * 0.37f);
+
+	WelfordOnlineStats welford;
+	benchRun("WelfordOnlineStats::update", benchFmt("block=%d", BENCH_AVG_BLOCK), BENCH_AVG_BLOCK, [&] {
+		for (int i = 0; i < BENCH_AVG_BLOCK; i++) welford.update(in[i]);
+		benchKeep(welford.mean());
+	});
+
+	AdaptiveWelford adaptive;
+	benchRun("AdaptiveWelford::update", benchFmt("block=%d", BENCH_AVG_BLOCK), BENCH_AVG_BLOCK, [&] {
+		for (int i = 0; i < BENCH_AVG_BLOCK; i++) adaptive.update(in[i]);
+		benchKeep(adaptive.mean());
+	});
+
+	benchRun("AdaptiveWelford::remove_outliers", "full buffer", 1, [&] {
+		AdaptiveWelford a;
+		for (int i = 0; i < 100; i++) a.update(in[i]);
+		a.remove_outliers();
+		benchKeep(a.mean());
+	});
+
+	DecayingAverage decaying(0.3);
+	benchRun("DecayingAverage::accumulate", benchFmt("block=%d", BENCH_AVG_BLOCK), BENCH_AVG_BLOCK, [&] {
+		for (int i = 0; i < BENCH_AVG_BLOCK; i++) benchKeep(decaying.accumulate(in[i]));
+	});
+
+	// one metric fed from t threads at once: a mutex around one WelfordOnlineStats vs ShardedWelford
+	struct Shared {
+		const float* in;
+		std::mutex mutex;
+		WelfordOnlineStats locked;
+		ShardedWelford sharded;
+	} shared;
+	shared.in = in.data();
+	std::vector<int> thread_counts;
+	for (int t = 1; t < ThreadPool::shared().threads(); t *= 2) thread_counts.push_back(t);
+	thread_counts.push_back(ThreadPool::shared().threads());
+	for (int t : thread_counts) {
+		benchRun("WelfordOnlineStats::update + mutex", benchFmt("t=%d block=%d", t, BENCH_AVG_BLOCK), t * BENCH_AVG_BLOCK, [&] {
+			ThreadPool::shared().parallelFor(t, [](int, void* ctx) {
+				Shared& s = *(Shared*)ctx;
+				for (int i = 0; i < BENCH_AVG_BLOCK; i++) {
+					std::lock_guard<std::mutex> lock(s.mutex);
+					s.locked.update(s.in[i]);
+				}
+			}, &shared, t);
+			benchKeep(shared.locked.mean());
+		});
+		benchRun("ShardedWelford::update", benchFmt("t=%d block=%d", t, BENCH_AVG_BLOCK), t * BENCH_AVG_BLOCK, [&] {
+			ThreadPool::shared().parallelFor(t, [](int, void* ctx) {
+				Shared& s = *(Shared*)ctx;
+				for (int i = 0; i < BENCH_AVG_BLOCK; i++) s.sharded.update(s.in[i]);
+			}, &shared, t);
+			benchKeep(shared.sharded.mean());
+		});
+	}
+	benchRun("ShardedWelford::snapshot", benchFmt("shards=%d", shared.sharded.shards()), 1, [&] {
+		benchKeep(shared.sharded.snapshot().mean);
+	});
+}
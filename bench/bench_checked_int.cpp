@@ -0,0 +1,67 @@
+#include "bench.h"
+
+#include <vector>
+
+#include "checked_int.h"
+
+#define BENCH_CHECKED_BLOCK 4096
+
+// the same clamp written the obvious way, with branches, for comparison with the block functions
+static int scaleBranchy(const uint16_t* x, uint16_t* out, int n, int16_t gain, int shift, int16_t offset, uint16_t lo, uint16_t hi) {
+	int clamped = 0;
+	for (int i = 0; i < n; i++) {
+		int32_t v = (((int32_t)x[i] * gain + (1 << (shift - 1))) >> shift) + offset;
+		if (v < lo) {
+			v = lo;
+			clamped++;
+		}
+		else if (v > hi) {
+			v = hi;
+			clamped++;
+		}
+		out[i] = (uint16_t)v;
+	}
+	return clamped;
+}
+
+IS_BENCH_SUITE(checked_int) {
+	std::vector<int16_t> a(BENCH_CHECKED_BLOCK), b(BENCH_CHECKED_BLOCK), s_out(BENCH_CHECKED_BLOCK);
+	std::vector<uint16_t> codes(BENCH_CHECKED_BLOCK), u_out(BENCH_CHECKED_BLOCK);
+	uint32_t seed = 12345;
+	for (int i = 0; i < BENCH_CHECKED_BLOCK; i++) {
+		seed = seed * 1664525u + 1013904223u;
+		a[i] = (int16_t)(seed >> 16);
+		b[i] = (int16_t)seed;
+		codes[i] = (uint16_t)(seed >> 20); // 12-bit ADC codes
+	}
+
+	int64_t x = 1;
+	benchRun("satAdd<int64_t>", "scalar", 1, [&] {
+		benchClobber();
+		x = is::satAdd<int64_t>(x, 0x123456789LL) - 0x123456788LL;
+		benchKeep(x);
+	});
+	int32_t y = 3;
+	benchRun("satMul<int32_t>", "scalar", 1, [&] {
+		benchClobber();
+		y = is::satMul<int32_t>(y, 70000) / 70000 + 1;
+		benchKeep(y);
+	});
+
+	benchRun("satAddBlock<int16_t>", benchFmt("n=%d", BENCH_CHECKED_BLOCK), BENCH_CHECKED_BLOCK, [&] {
+		benchKeep(is::satAddBlock(a.data(), b.data(), s_out.data(), BENCH_CHECKED_BLOCK));
+	});
+	benchRun("satSubBlock<int16_t>", benchFmt("n=%d", BENCH_CHECKED_BLOCK), BENCH_CHECKED_BLOCK, [&] {
+		benchKeep(is::satSubBlock(a.data(), b.data(), s_out.data(), BENCH_CHECKED_BLOCK));
+	});
+
+	// 12-bit ADC codes through a gain of ~1.07 and an offset, clamped to the 12-bit DAC range
+	const int16_t gain = 17500, offset = -40;
+	const int shift = 14;
+	benchRun("satScaleBlock<uint16_t>", benchFmt("n=%d", BENCH_CHECKED_BLOCK), BENCH_CHECKED_BLOCK, [&] {
+		benchKeep(is::satScaleBlock(codes.data(), u_out.data(), BENCH_CHECKED_BLOCK, gain, shift, offset, (uint16_t)0, (uint16_t)4095));
+	});
+	benchRun("scale + branchy clamp", benchFmt("n=%d", BENCH_CHECKED_BLOCK), BENCH_CHECKED_BLOCK, [&] {
+		benchKeep(scaleBranchy(codes.data(), u_out.data(), BENCH_CHECKED_BLOCK, gain, shift, offset, 0, 4095));
+	});
+}
@@ -0,0 +1,63 @@
+#include "bench.h"
+
+#include <math.h>
+#include <vector>
+
+#include "cpu_dispatch.h"
+#include "matrices.h"
+#include "polynomial.h"
+#include "sigmoid.h"
+#include "welford_averages.h"
+
+#if IS_HAS_CPU_DISPATCH
+
+// every dispatched kernel at every level this CPU supports (IS_EEMATH_CPU caps the rest of the run)
+IS_BENCH_SUITE(cpu_dispatch) {
+	const int n = 128, size = 4096, deg = 5, block = 4096;
+	std::vector<double> a((size_t)n * n), b((size_t)n * n), c((size_t)n * n);
+	std::vector<double*> A(n), B(n), C(n);
+	for (int i = 0; i < n; i++) {
+		A[i] = &a[(size_t)i * n];
+		B[i] = &b[(size_t)i * n];
+		C[i] = &c[(size_t)i * n];
+	}
+	for (size_t i = 0; i < a.size(); i++) {
+		a[i] = sin((double)i);
+		b[i] = cos(0.7 * i);
+	}
+	std::vector<double> x(size), y(size), coeffs(deg + 1);
+	for (int i = 0; i < size; i++) {
+		x[i] = (double)i / size;
+		y[i] = 0.5 * exp(2 * x[i]);
+	}
+	std::vector<float> in(block), out(block);
+	for (int i = 0; i < block; i++) in[i] = 1000 + 3 * sinf(0.1f * i);
+
+	const CpuDispatchLevel initial = cpuKernels().level;
+	for (int l = 0; l <= initial; l++) {
+		CpuDispatchLevel level = (CpuDispatchLevel)l;
+		cpuDispatchSet(level);
+		const char* name = cpuDispatchName(level);
+
+		benchRun("multiplyMatrices", benchFmt("n=%d %s", n, name), (double)n * n * n, [&] {
+			is::multiplyMatrices(A.data(), B.data(), C.data(), n, n, n);
+			benchClobber();
+		});
+		benchRun("polyfit", benchFmt("size=%d deg=%d %s", size, deg, name), size, [&] {
+			is::polyfit(x.data(), y.data(), size, deg, coeffs.data());
+			benchKeep(coeffs[0]);
+		});
+		benchRun("sigmoidBlock", benchFmt("block=%d %s", block, name), block, [&] {
+			sigmoidBlock(in.data(), out.data(), block, 1000, 0.5f);
+			benchClobber();
+		});
+		WelfordOnlineStats stats;
+		benchRun("WelfordOnlineStats::updateBlock", benchFmt("block=%d %s", block, name), block, [&] {
+			stats.updateBlock(in.data(), block);
+			benchKeep(stats);
+		});
+	}
+	cpuDispatchSet(initial);
+}
+
+#endif
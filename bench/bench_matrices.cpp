@@ -0,0 +1,110 @@
+#include "bench.h"
+
+#include <vector>
+
+#include "matrices.h"
+#include "ThreadPool.h"
+
+// rows of a square n x n matrix as double** (the layout the matrices.h kernels take)
+struct BenchMatrix {
+	std::vector<double> data;
+	std::vector<double*> rows;
+	BenchMatrix(int n, int m, double seed=1.0) : data((size_t)n * m), rows(n) {
+		for (int i = 0; i < n; i++) rows[i] = &data[(size_t)i * m];
+		for (size_t i = 0; i < data.size(); i++) data[i] = seed + (double)((i * 7919) % 1000) / 1000.0;
+	}
+	double** ptr() { return rows.data(); }
+	// restores the data and the row order (luFactor() and gaussianElimination() permute the row pointers)
+	void copyFrom(const BenchMatrix& src) {
+		data = src.data;
+		for (size_t i = 0; i < rows.size(); i++) rows[i] = &data[i * (data.size() / rows.size())];
+	}
+};
+
+IS_BENCH_SUITE(matrices) {
+	const int ns[] = {8, 32, 128};
+
+	for (int n : ns) {
+		BenchMatrix A(n, n), B(n, n, 2.0), C(n, n);
+		benchRun("multiplyMatrices", benchFmt("n=%d", n), (double)n * n * n, [&] {
+			is::multiplyMatrices(A.ptr(), B.ptr(), C.ptr(), n, n, n);
+			benchClobber();
+		});
+
+		benchRun("transposeMatrices", benchFmt("n=%d", n), (double)n * n, [&] {
+			is::transposeMatrices(A.ptr(), C.ptr(), n, n);
+			benchClobber();
+		});
+
+		std::vector<double> x(n, 1.0), y(n);
+		benchRun("multiplyMatrixWithVector", benchFmt("n=%d", n), (double)n * n, [&] {
+			is::multiplyMatrixWithVector(A.ptr(), x.data(), y.data(), n, n);
+			benchClobber();
+		});
+
+		// gaussianElimination destroys its inputs, so each op restores them first (included in the time)
+		BenchMatrix M(n, n), work(n, n);
+		for (int i = 0; i < n; i++) M.rows[i][i] += n; // diagonally dominant
+		std::vector<double> b(n, 1.0), b_work(n), coeffs(n);
+		benchRun("gaussianElimination", benchFmt("n=%d (with copy)", n), 1, [&] {
+			work.copyFrom(M);
+			b_work = b;
+			is::gaussianElimination(work.ptr(), b_work.data(), coeffs.data(), n);
+			benchKeep(coeffs[0]);
+		});
+
+		// SPD system (M^T*M): factor (with copy, as above), then solves against the factor
+		BenchMatrix MT(n, n), S(n, n);
+		is::transposeMatrices(M.ptr(), MT.ptr(), n, n);
+		is::multiplyMatrices(MT.ptr(), M.ptr(), S.ptr(), n, n, n);
+		benchRun("choleskyFactor", benchFmt("n=%d (with copy)", n), 1, [&] {
+			work.data = S.data;
+			benchKeep(is::choleskyFactor(work.ptr(), n));
+		});
+		benchRun("ldltFactor", benchFmt("n=%d (with copy)", n), 1, [&] {
+			work.data = S.data;
+			benchKeep(is::ldltFactor(work.ptr(), n));
+		});
+		work.data = S.data;
+		is::choleskyFactor(work.ptr(), n);
+		benchRun("choleskySolve", benchFmt("n=%d", n), 1, [&] {
+			is::choleskySolve(work.ptr(), b.data(), coeffs.data(), n);
+			benchKeep(coeffs[0]);
+		});
+	}
+
+	// large dense systems: blocked LU by thread count (up to the machine's) vs unblocked elimination
+	std::vector<int> thread_counts;
+	for (int t = 1; t < ThreadPool::shared().threads(); t *= 2) thread_counts.push_back(t);
+	thread_counts.push_back(ThreadPool::shared().threads());
+	for (int n : {256, 512, 1024}) {
+		BenchMatrix M(n, n), work(n, n);
+		for (int i = 0; i < n; i++) M.rows[i][i] += n;
+		std::vector<double> b(n, 1.0), b_work(n), x(n);
+		std::vector<int> perm(n);
+		double flops = 2.0 / 3 * n * n * n;
+		if (n <= 512) {
+			benchRun("gaussianElimination", benchFmt("n=%d (with copy)", n), flops, [&] {
+				work.copyFrom(M);
+				b_work = b;
+				is::gaussianElimination(work.ptr(), b_work.data(), x.data(), n);
+				benchKeep(x[0]);
+			});
+		}
+		for (int t : thread_counts) {
+			benchRun("luFactor", benchFmt("n=%d t=%d (with copy)", n, t), flops, [&] {
+				work.copyFrom(M);
+				benchKeep(is::luFactor(work.ptr(), perm.data(), n, nullptr, t));
+			});
+		}
+
+		const int n_rhs = 64;
+		BenchMatrix B(n_rhs, n), X(n_rhs, n);
+		work.copyFrom(M);
+		is::luFactor(work.ptr(), perm.data(), n);
+		benchRun("luSolveMany", benchFmt("n=%d rhs=%d", n, n_rhs), n_rhs, [&] {
+			is::luSolveMany(work.ptr(), perm.data(), B.ptr(), X.ptr(), n, n_rhs);
+			benchKeep(X.data[0]);
+		});
+	}
+}
@@ -0,0 +1,104 @@
+#include "bench.h"
+
+#include <math.h>
+#include <vector>
+
+#include "ParRateCurveModel.h"
+#include "CurveRecord.h"
+#include "PitchPAR.h"
+#include "RCGlide.h"
+#include "ADCScheduler.h"
+#include "DiffAmpADC.h"
+
+#define BENCH_MODEL_BLOCK 1024
+
+IS_BENCH_SUITE(models) {
+	std::vector<float> v(BENCH_MODEL_BLOCK), out(BENCH_MODEL_BLOCK);
+	for (int i = 0; i < BENCH_MODEL_BLOCK; i++) v[i] = 5.0f * i / BENCH_MODEL_BLOCK;
+
+	// ParRateCurveModel: LUT vs exact polynomial
+	std::vector<double> fv(64), frate(64);
+	for (int i = 0; i < 64; i++) { fv[i] = 5.0 * i / 63; frate[i] = exp(0.8 * fv[i]); }
+	ParRateCurveModel<float> model;
+	model.fit(fv.data(), frate.data(), 64, 5);
+	model.buildLookup(0, 5, 256);
+	benchRun("ParRateCurveModel::rate", benchFmt("lut=256 block=%d", BENCH_MODEL_BLOCK), BENCH_MODEL_BLOCK, [&] {
+		for (int i = 0; i < BENCH_MODEL_BLOCK; i++) out[i] = model.rate(v[i]);
+		benchClobber();
+	});
+	benchRun("ParRateCurveModel::rateExact", benchFmt("deg=5 block=%d", BENCH_MODEL_BLOCK), BENCH_MODEL_BLOCK, [&] {
+		for (int i = 0; i < BENCH_MODEL_BLOCK; i++) out[i] = model.rateExact(v[i]);
+		benchClobber();
+	});
+
+	// inverse: rate -> voltage, table + Newton vs bisecting the forward polynomial
+	std::vector<float> rates(BENCH_MODEL_BLOCK);
+	for (int i = 0; i < BENCH_MODEL_BLOCK; i++) rates[i] = model.rateExact(v[i]);
+	model.buildInverse(0, 5);
+	benchRun("ParRateCurveModel::voltage", benchFmt("inverse=64 newton=2 block=%d", BENCH_MODEL_BLOCK), BENCH_MODEL_BLOCK, [&] {
+		for (int i = 0; i < BENCH_MODEL_BLOCK; i++) out[i] = model.voltage(rates[i]);
+		benchClobber();
+	});
+	benchRun("bisect rateExact", benchFmt("24 steps block=%d", BENCH_MODEL_BLOCK), BENCH_MODEL_BLOCK, [&] {
+		for (int i = 0; i < BENCH_MODEL_BLOCK; i++) {
+			float lo = 0, hi = 5;
+			for (int k = 0; k < 24; k++) {
+				float mid = (lo + hi) / 2;
+				if (model.rateExact(mid) < rates[i]) lo = mid;
+				else hi = mid;
+			}
+			out[i] = lo;
+		}
+		benchClobber();
+	});
+
+	// CurveRecordView: evaluating in place
+	uint8_t rec_f[64], rec_q[64];
+	model.writeRecord(rec_f, sizeof(rec_f), 1, CURVE_FLOAT32);
+	model.writeRecord(rec_q, sizeof(rec_q), 2, CURVE_INT16);
+	CurveRecordView view_f(rec_f), view_q(rec_q);
+	benchRun("CurveRecordView::evalBlock", benchFmt("float32 block=%d", BENCH_MODEL_BLOCK), BENCH_MODEL_BLOCK, [&] {
+		view_f.evalBlock(v.data(), out.data(), BENCH_MODEL_BLOCK);
+		benchClobber();
+	});
+	benchRun("CurveRecordView::evalBlock", benchFmt("int16 block=%d", BENCH_MODEL_BLOCK), BENCH_MODEL_BLOCK, [&] {
+		view_q.evalBlock(v.data(), out.data(), BENCH_MODEL_BLOCK);
+		benchClobber();
+	});
+
+	// PitchPAR: table vs computed
+	PitchPAR pitch(42);
+	std::vector<uint16_t> codes(128);
+	benchRun("PitchPAR::dacCode", "128 notes", 128, [&] {
+		for (int n = 0; n < 128; n++) codes[n] = pitch.dacCode(n);
+		benchClobber();
+	});
+	benchRun("PitchPAR::midiToDACExact", "128 notes", 128, [&] {
+		for (int n = 0; n < 128; n++) codes[n] = pitch.midiToDACExact(n);
+		benchClobber();
+	});
+
+	// RCGlide: all voices, one block
+	RCGlide glide(RCGLIDE_MAX_VOICES, 1.0f / 48000);
+	std::vector<float> frames(RCGLIDE_MAX_VOICES * 64);
+	for (int i = 0; i < RCGLIDE_MAX_VOICES; i++) glide.start(i, 0, 1e6f, 10.0f); // long glides (no settling)
+	benchRun("RCGlide::processBlock", benchFmt("voices=%d samples=64", RCGLIDE_MAX_VOICES), RCGLIDE_MAX_VOICES * 64, [&] {
+		glide.processBlock(frames.data(), 64);
+		benchClobber();
+	});
+
+	// ADC paths against Arduino_dummy's synthetic analogRead()
+	dummySetAnalogSignal(A0, 512, 100, 64, 2);
+	ADCScheduler sched(PRIORITY_WEIGHTED);
+	sched.addChannel(A0, 3);
+	sched.addChannel(A1, 1);
+	int16_t block[ADCSCHEDULER_RING_SIZE];
+	benchRun("ADCScheduler::run+readBlock", "16 conversions", 16, [&] {
+		sched.run(16);
+		benchKeep(sched.readBlock(0, block, ADCSCHEDULER_RING_SIZE));
+		benchKeep(sched.readBlock(1, block, ADCSCHEDULER_RING_SIZE));
+	});
+
+	DiffAmpADC adc(A0);
+	benchRun("DiffAmpADC::readNOversampled", "extra_bits=2", 16, [&] { benchKeep(adc.readNOversampled(2)); });
+}
@@ -0,0 +1,100 @@
+#include "bench.h"
+
+#include <math.h>
+#include <vector>
+
+#include "polynomial.h"
+
+IS_BENCH_SUITE(polynomial) {
+	const int sizes[] = {16, 256, 4096};
+	const int degs[] = {1, 3, 5, 8};
+
+	for (int size : sizes) {
+		std::vector<double> x(size), y(size);
+		for (int i = 0; i < size; i++) {
+			x[i] = (double)i / size;
+			y[i] = 0.5 * exp(2 * x[i]) + 0.01 * sin(97 * x[i]);
+		}
+		for (int deg : degs) {
+			if (deg >= size) continue;
+			std::vector<double> coeffs(deg + 1);
+			benchRun("polyfit", benchFmt("size=%d deg=%d", size, deg), size, [&] {
+				is::polyfit(x.data(), y.data(), size, deg, coeffs.data());
+				benchKeep(coeffs[0]);
+			});
+		}
+	}
+
+	// many y-vectors on one x grid: the normal equations are factored once
+	const int n_ys = 64, size = 256, deg = 5;
+	std::vector<double> x(size), y_data((size_t)n_ys * size), c_data((size_t)n_ys * (deg + 1));
+	std::vector<double*> ys(n_ys), cs(n_ys);
+	for (int i = 0; i < size; i++) x[i] = (double)i / size;
+	for (int r = 0; r < n_ys; r++) {
+		ys[r] = &y_data[(size_t)r * size];
+		cs[r] = &c_data[(size_t)r * (deg + 1)];
+		for (int i = 0; i < size; i++) ys[r][i] = exp((1 + 0.01 * r) * x[i]);
+	}
+	benchRun("polyfitMany", benchFmt("ys=%d size=%d deg=%d", n_ys, size, deg), n_ys, [&] {
+		is::polyfitMany(x.data(), ys.data(), n_ys, size, deg, cs.data());
+		benchKeep(c_data[0]);
+	});
+	benchRun("polyfit x n", benchFmt("ys=%d size=%d deg=%d", n_ys, size, deg), n_ys, [&] {
+		for (int r = 0; r < n_ys; r++) is::polyfit(x.data(), ys[r], size, deg, cs[r]);
+		benchKeep(c_data[0]);
+	});
+
+	// weighted and robust fits of data with glitches, reusing one workspace (no allocation per fit)
+	std::vector<double> yg(ys[0], ys[0] + size), w(size, 1.0), coeffs(deg + 1);
+	for (int i = 0; i < size; i += 17) yg[i] += 3;
+	is::PolyfitWorkspace ws(deg, size);
+	benchRun("polyfitWeighted", benchFmt("size=%d deg=%d ws", size, deg), size, [&] {
+		is::polyfitWeighted(x.data(), yg.data(), w.data(), size, deg, coeffs.data(), &ws);
+		benchKeep(coeffs[0]);
+	});
+	benchRun("polyfitRobust", benchFmt("size=%d deg=%d huber", size, deg), size, [&] {
+		is::polyfitRobust(x.data(), yg.data(), nullptr, size, deg, coeffs.data(), ws);
+		benchKeep(coeffs[0]);
+	});
+	benchRun("polyfitRobust", benchFmt("size=%d deg=%d tukey", size, deg), size, [&] {
+		is::polyfitRobust(x.data(), yg.data(), nullptr, size, deg, coeffs.data(), ws, is::POLYFIT_TUKEY);
+		benchKeep(coeffs[0]);
+	});
+
+	// degree selection: 5-fold cross-validation over degrees 1...8, serial and on the thread pool
+	std::vector<double> xs(4096), ysel(4096), csel(9);
+	for (int i = 0; i < 4096; i++) {
+		xs[i] = (double)i / 4096;
+		ysel[i] = 0.5 * exp(2 * xs[i]) + 0.01 * sin(97 * xs[i]);
+	}
+	for (int threads : {1, 0}) {
+		benchRun("polyfitSelect", benchFmt("size=4096 deg<=8 cv5 t=%s", threads ? "1" : "all"), 4096, [&] {
+			benchKeep(is::polyfitSelect(xs.data(), ysel.data(), 4096, 8, csel.data(), nullptr, is::POLYFIT_CV, 5, threads));
+		});
+	}
+	benchRun("polyfitSelect", "size=4096 deg<=8 bic", 4096, [&] {
+		benchKeep(is::polyfitSelect(xs.data(), ysel.data(), 4096, 8, csel.data(), nullptr, is::POLYFIT_BIC));
+	});
+
+	// recalibrating a fit for a new gain/offset: coefficient arithmetic vs refitting the data
+	std::vector<double> xr(4096), c_fit(deg + 1), c_new(deg + 1);
+	for (int i = 0; i < 4096; i++) xr[i] = 1.25 * xs[i] - 0.1;
+	is::polyfit(xs.data(), ysel.data(), 4096, deg, c_fit.data());
+	benchRun("polyAffine", benchFmt("deg=%d", deg), 1, [&] {
+		is::polyAffine(c_fit.data(), deg, 0.8, 0.08, c_new.data());
+		benchKeep(c_new[0]);
+	});
+	benchRun("polyfit refit", benchFmt("size=4096 deg=%d", deg), 1, [&] {
+		is::polyfit(xr.data(), ysel.data(), 4096, deg, c_new.data());
+		benchKeep(c_new[0]);
+	});
+
+	for (int deg : degs) {
+		std::vector<double> coeffs(deg + 1, 0.5);
+		double x = 0.3;
+		benchRun("polyval", benchFmt("deg=%d", deg), 1, [&] {
+			benchKeep(x);
+			benchKeep(is::polyval(coeffs.data(), deg, x));
+		});
+	}
+}
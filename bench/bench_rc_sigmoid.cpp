@@ -0,0 +1,92 @@
+#include "bench.h"
+
+#include <math.h>
+#include <vector>
+
+#include "approx.h"
+#include "rc.h"
+#include "sigmoid.h"
+
+#define BENCH_EVAL_BLOCK 1024
+
+IS_BENCH_SUITE(rc_sigmoid) {
+	std::vector<double> in(BENCH_EVAL_BLOCK), out(BENCH_EVAL_BLOCK);
+	for (int i = 0; i < BENCH_EVAL_BLOCK; i++) in[i] = (i + 0.5) / BENCH_EVAL_BLOCK; // 0...1 exclusive
+
+	benchRun("nTauOfPcnt01", benchFmt("block=%d", BENCH_EVAL_BLOCK), BENCH_EVAL_BLOCK, [&] {
+		for (int i = 0; i < BENCH_EVAL_BLOCK; i++) out[i] = nTauOfPcnt01(in[i]);
+		benchClobber();
+	});
+
+	benchRun("pcnt01OfnTau", benchFmt("block=%d", BENCH_EVAL_BLOCK), BENCH_EVAL_BLOCK, [&] {
+		for (int i = 0; i < BENCH_EVAL_BLOCK; i++) out[i] = pcnt01OfnTau(in[i] * 5);
+		benchClobber();
+	});
+
+	benchRun("sigmoid", benchFmt("block=%d", BENCH_EVAL_BLOCK), BENCH_EVAL_BLOCK, [&] {
+		for (int i = 0; i < BENCH_EVAL_BLOCK; i++) out[i] = sigmoid(in[i]);
+		benchClobber();
+	});
+
+	benchRun("sigmoid_n1_p1", benchFmt("block=%d", BENCH_EVAL_BLOCK), BENCH_EVAL_BLOCK, [&] {
+		for (int i = 0; i < BENCH_EVAL_BLOCK; i++) out[i] = sigmoid_n1_p1(in[i] * 2 - 1);
+		benchClobber();
+	});
+
+	std::vector<float> in_f(in.begin(), in.end()), out_f(BENCH_EVAL_BLOCK);
+
+	benchRun("nTauOfPcnt01Fast", benchFmt("block=%d", BENCH_EVAL_BLOCK), BENCH_EVAL_BLOCK, [&] {
+		for (int i = 0; i < BENCH_EVAL_BLOCK; i++) out_f[i] = nTauOfPcnt01Fast(in_f[i]);
+		benchClobber();
+	});
+
+	benchRun("pcnt01OfnTauFast", benchFmt("block=%d", BENCH_EVAL_BLOCK), BENCH_EVAL_BLOCK, [&] {
+		for (int i = 0; i < BENCH_EVAL_BLOCK; i++) out_f[i] = pcnt01OfnTauFast(in_f[i] * 5);
+		benchClobber();
+	});
+
+	benchRun("sigmoidFast", benchFmt("block=%d", BENCH_EVAL_BLOCK), BENCH_EVAL_BLOCK, [&] {
+		for (int i = 0; i < BENCH_EVAL_BLOCK; i++) out_f[i] = sigmoidFast(in_f[i]);
+		benchClobber();
+	});
+
+	benchRun("sigmoid_n1_p1Fast", benchFmt("block=%d", BENCH_EVAL_BLOCK), BENCH_EVAL_BLOCK, [&] {
+		for (int i = 0; i < BENCH_EVAL_BLOCK; i++) out_f[i] = sigmoid_n1_p1Fast(in_f[i] * 2 - 1);
+		benchClobber();
+	});
+
+	// the approximations against libm's float versions
+	benchRun("expf", benchFmt("block=%d", BENCH_EVAL_BLOCK), BENCH_EVAL_BLOCK, [&] {
+		for (int i = 0; i < BENCH_EVAL_BLOCK; i++) out_f[i] = expf(in_f[i] * 20 - 10);
+		benchClobber();
+	});
+
+	benchRun("expApprox", benchFmt("block=%d", BENCH_EVAL_BLOCK), BENCH_EVAL_BLOCK, [&] {
+		for (int i = 0; i < BENCH_EVAL_BLOCK; i++) out_f[i] = expApprox(in_f[i] * 20 - 10);
+		benchClobber();
+	});
+
+	benchRun("logf", benchFmt("block=%d", BENCH_EVAL_BLOCK), BENCH_EVAL_BLOCK, [&] {
+		for (int i = 0; i < BENCH_EVAL_BLOCK; i++) out_f[i] = logf(in_f[i] * 100);
+		benchClobber();
+	});
+
+	benchRun("logApprox", benchFmt("block=%d", BENCH_EVAL_BLOCK), BENCH_EVAL_BLOCK, [&] {
+		for (int i = 0; i < BENCH_EVAL_BLOCK; i++) out_f[i] = logApprox(in_f[i] * 100);
+		benchClobber();
+	});
+
+	// a compile-time Chebyshev fit of the sigmoid's core on its usual input range
+	static constexpr is::ChebyshevApprox<9> sigmoid_cheb = is::chebyshevApprox<9>([](double x) {
+		double t = 1, term = 1; // 1 + e^-10(x-0.5) needs exp, which isn't constexpr: use its series
+		for (int k = 1; k < 60; k++) {
+			term *= -10 * (x - 0.5) / k;
+			t += term;
+		}
+		return 1 / (1 + t);
+	}, 0.0, 1.0);
+	benchRun("sigmoid chebyshevApprox<9>", benchFmt("block=%d", BENCH_EVAL_BLOCK), BENCH_EVAL_BLOCK, [&] {
+		for (int i = 0; i < BENCH_EVAL_BLOCK; i++) out[i] = sigmoid_cheb.eval(in[i]);
+		benchClobber();
+	});
+}
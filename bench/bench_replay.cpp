@@ -0,0 +1,54 @@
+#include "bench.h"
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <vector>
+
+#include "DiffAmpADC.h"
+#include "TimeElapsed.h"
+#include "welford_averages.h"
+
+// Replays a recorded ADC trace through the library on Arduino_dummy's virtual clock, as a test
+// harness would replay production captures. One op is a whole capture, so the real-time factor of
+// the replay is the capture's length divided by ns/op.
+
+#define BENCH_REPLAY_RATE_HZ 1000
+#define BENCH_REPLAY_SECONDS 600
+
+IS_BENCH_SUITE(replay) {
+#if DUMMY_HAS_MMAP
+	// write a synthetic "capture" (a slow sine with noise) to a temporary file, then map it back
+	const size_t n_samples = (size_t)BENCH_REPLAY_RATE_HZ * BENCH_REPLAY_SECONDS;
+	char path[] = "/tmp/is_eeMath_traceXXXXXX";
+	int fd = mkstemp(path);
+	FILE* f = fd >= 0 ? fdopen(fd, "wb") : nullptr;
+	if (!f) { perror("replay trace"); return; }
+	std::vector<uint16_t> samples(n_samples);
+	uint32_t lcg = 1;
+	for (size_t i = 0; i < n_samples; i++) {
+		lcg = lcg * 1664525u + 1013904223u;
+		samples[i] = (uint16_t)(512 + 400 * sin(i * 0.001) + (int)(lcg >> 29) - 4);
+	}
+	fwrite(samples.data(), sizeof(uint16_t), n_samples, f);
+	fclose(f);
+	long loaded = dummyLoadAnalogTrace(A0, path, 1000000 / BENCH_REPLAY_RATE_HZ);
+	unlink(path); // the mapping keeps the data alive
+	if (loaded != (long)n_samples) { fprintf(stderr, "replay: couldn't map the trace\n"); return; }
+
+	DiffAmpADC adc(A0);
+	WelfordOnlineStats stats;
+	TimeElapsed te;
+	benchRun("DiffAmpADC+Welford", benchFmt("%ds@%dHz mmap", BENCH_REPLAY_SECONDS, BENCH_REPLAY_RATE_HZ), n_samples, [&] {
+		dummyRestartAnalogTrace(A0);
+		te.clearAndStart();
+		while (!dummyAnalogTraceDone(A0)) {
+			stats.update(adc.readNormalized());
+			benchKeep(te.elapsed());
+			delayMicroseconds(1000000 / BENCH_REPLAY_RATE_HZ);
+		}
+		benchKeep(stats.mean());
+	});
+	dummyClearAnalogTrace(A0);
+#endif
+}
@@ -0,0 +1,49 @@
+#include "bench.h"
+
+#include <math.h>
+#include <vector>
+
+#include "spline.h"
+
+#define BENCH_SPLINE_BLOCK 1024
+
+IS_BENCH_SUITE(spline) {
+	const int knots[] = {16, 256};
+	std::vector<float> v(BENCH_SPLINE_BLOCK), v_random(BENCH_SPLINE_BLOCK), out(BENCH_SPLINE_BLOCK);
+	uint32_t lcg = 1;
+	for (int i = 0; i < BENCH_SPLINE_BLOCK; i++) {
+		v[i] = 5.0f * i / BENCH_SPLINE_BLOCK;
+		lcg = lcg * 1664525u + 1013904223u;
+		v_random[i] = 5.0f * (lcg >> 8) / (1 << 24);
+	}
+
+	for (int n : knots) {
+		std::vector<double> x(n), x_warped(n), y(n);
+		for (int i = 0; i < n; i++) {
+			x[i] = 5.0 * i / (n - 1);
+			x_warped[i] = 5.0 * pow((double)i / (n - 1), 1.5);
+			y[i] = exp(0.8 * x[i]) + 0.05 * sin(40 * x[i]);
+		}
+
+		is::CubicSpline<float> spline;
+		benchRun("CubicSpline::interpolate", benchFmt("knots=%d", n), n, [&] {
+			benchKeep(spline.interpolate(x.data(), y.data(), n));
+		});
+		benchRun("CubicSpline::smooth", benchFmt("knots=%d", n), n, [&] {
+			benchKeep(spline.smooth(x.data(), y.data(), nullptr, n, 1e-3));
+		});
+
+		for (int warped = 0; warped < 2; warped++) {
+			spline.interpolate(warped ? x_warped.data() : x.data(), y.data(), n);
+			const char* knot_type = warped ? "non-uniform" : "uniform";
+			benchRun("CubicSpline::eval", benchFmt("knots=%d %s random", n, knot_type), BENCH_SPLINE_BLOCK, [&] {
+				for (int i = 0; i < BENCH_SPLINE_BLOCK; i++) out[i] = spline.eval(v_random[i]);
+				benchClobber();
+			});
+			benchRun("CubicSpline::evalBlock", benchFmt("knots=%d %s sorted", n, knot_type), BENCH_SPLINE_BLOCK, [&] {
+				spline.evalBlock(v.data(), out.data(), BENCH_SPLINE_BLOCK);
+				benchClobber();
+			});
+		}
+	}
+}
@@ -0,0 +1,76 @@
+#include "check.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <math.h>
+#include <vector>
+
+//**** registry **************************************************************
+
+struct CheckSuite {
+	const char* name;
+	CheckSuiteFunc func;
+};
+
+static std::vector<CheckSuite>& suites() {
+	static std::vector<CheckSuite> s;
+	return s;
+}
+
+CheckSuiteRegistrar::CheckSuiteRegistrar(const char* name, CheckSuiteFunc func) {
+	suites().push_back(CheckSuite{name, func});
+}
+
+static const char* g_current_suite = "";
+static unsigned long g_checks = 0;
+static unsigned long g_failures = 0;
+
+//**** checking **************************************************************
+
+bool checkResult(bool ok, const char* expr, const char* file, int line) {
+	g_checks++;
+	if (!ok) {
+		g_failures++;
+		fprintf(stderr, "%s:%d: [%s] failed: %s\n", file, line, g_current_suite, expr);
+	}
+	return ok;
+}
+
+bool checkNear(double a, double b, double tol, const char* expr_a, const char* expr_b, const char* file, int line) {
+	g_checks++;
+	bool ok = fabs(a - b) <= tol; // false for NaN
+	if (!ok) {
+		g_failures++;
+		fprintf(stderr, "%s:%d: [%s] failed: %s (%.17g) vs %s (%.17g), tolerance %g\n", file, line, g_current_suite,
+			expr_a, a, expr_b, b, tol);
+	}
+	return ok;
+}
+
+static void usage(const char* argv0) {
+	printf("usage: %s [--filter TEXT] [--list]\n", argv0);
+}
+
+int main(int argc, char** argv) {
+	const char* filter = nullptr;
+	bool list = false;
+	for (int i = 1; i < argc; i++) {
+		if (!strcmp(argv[i], "--filter") && i + 1 < argc) filter = argv[++i];
+		else if (!strcmp(argv[i], "--list")) list = true;
+		else { usage(argv[0]); return strcmp(argv[i], "--help") ? 1 : 0; }
+	}
+
+	int run = 0;
+	for (const CheckSuite& s : suites()) {
+		if (list) { printf("%s\n", s.name); continue; }
+		if (filter && !strstr(s.name, filter)) continue;
+		g_current_suite = s.name;
+		unsigned long failures_before = g_failures;
+		s.func();
+		printf("%-30s %s\n", s.name, g_failures == failures_before ? "ok" : "FAILED");
+		run++;
+	}
+	if (list) return 0;
+	printf("%d suites, %lu checks, %lu failed\n", run, g_checks, g_failures);
+	return g_failures ? 1 : 0;
+}
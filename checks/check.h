@@ -0,0 +1,39 @@
+#pragma once
+
+/**************************************************************************************************
+* @file  check.h
+*
+* @brief minimal behaviour checks for is_eeMath (host only), run by ctest next to the benchmarks
+***************************************************************************************************/
+
+/*
+	Each check_*.cpp registers one or more suites with IS_CHECK_SUITE(name) { ... }, and inside a
+	suite states what must hold with CHECK(cond) and CHECK_NEAR(a, b, tol). A failed check prints
+	its file, line and expression (and both values for CHECK_NEAR) and the suite carries on, so one
+	run shows every failure; is_eeMath_checks exits non-zero if any check failed.
+
+		cmake --build build --target is_eeMath_checks && (cd build && ctest --output-on-failure)
+*/
+
+typedef void (*CheckSuiteFunc)();
+
+struct CheckSuiteRegistrar {
+	CheckSuiteRegistrar(const char* name, CheckSuiteFunc func);
+};
+
+#define IS_CHECK_SUITE(name) \
+	static void check_suite_##name(); \
+	static CheckSuiteRegistrar check_suite_registrar_##name(#name, check_suite_##name); \
+	static void check_suite_##name()
+
+/// @brief (internal) records one check. Use CHECK().
+bool checkResult(bool ok, const char* expr, const char* file, int line);
+
+/// @brief (internal) records one comparison. Use CHECK_NEAR().
+bool checkNear(double a, double b, double tol, const char* expr_a, const char* expr_b, const char* file, int line);
+
+/// @return bool cond, after recording a failure if it is false
+#define CHECK(cond) checkResult((cond), #cond, __FILE__, __LINE__)
+
+/// @return bool |a - b| <= tol, after recording a failure (with both values) if not
+#define CHECK_NEAR(a, b, tol) checkNear((a), (b), (tol), #a, #b, __FILE__, __LINE__)
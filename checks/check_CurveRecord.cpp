@@ -0,0 +1,105 @@
+#include "check.h"
+
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "CurveRecord.h"
+#include "polynomial.h"
+
+IS_CHECK_SUITE(CurveRecord) {
+	const double coeffs[4] = {0.25, -1.5, 2.0, 10.0}; // in u = (x - 2) * 0.5
+	const float x_offset = 2.0f, x_scale = 0.5f;
+	uint8_t buf[256];
+
+	// float32 round trip: header fields, coefficients and evaluation
+	size_t size = curveRecordWrite(buf, sizeof(buf), 42, coeffs, 3, x_offset, x_scale, CURVE_FLOAT32);
+	CHECK(size == curveRecordSize(3, CURVE_FLOAT32));
+	CurveRecordView rec(buf);
+	CHECK(rec.valid(size));
+	CHECK(rec.channelId() == 42);
+	CHECK(rec.degree() == 3);
+	CHECK(rec.format() == CURVE_FLOAT32);
+	CHECK(rec.size() == size);
+	CHECK(rec.xOffset() == x_offset && rec.xScale() == x_scale);
+	for (int i = 0; i <= 3; i++) CHECK(rec.coeff(i) == (float)coeffs[i]);
+	for (float x = -4; x <= 8; x += 0.75f) {
+		double want = is::polyval(coeffs, 3, (x - 2.0) * 0.5);
+		CHECK_NEAR(rec.eval(x), want, 1e-5 * (1 + fabs(want)));
+	}
+	float xs[3] = {0, 2, 5}, ys[3];
+	rec.evalBlock(xs, ys, 3);
+	for (int i = 0; i < 3; i++) CHECK(ys[i] == rec.eval(xs[i]));
+
+	// int16: each coefficient within half a quantization step of coeff_scale = max|coeff| / 32767
+	uint8_t buf16[256];
+	size_t size16 = curveRecordWrite(buf16, sizeof(buf16), 7, coeffs, 3, x_offset, x_scale, CURVE_INT16);
+	CHECK(size16 == curveRecordSize(3, CURVE_INT16) && size16 < size);
+	CurveRecordView rec16(buf16);
+	CHECK(rec16.valid(size16));
+	CHECK(rec16.format() == CURVE_INT16);
+	CHECK_NEAR(rec16.coeffScale(), 10.0 / 32767, 1e-9);
+	for (int i = 0; i <= 3; i++) CHECK_NEAR(rec16.coeff(i), coeffs[i], 0.5 * rec16.coeffScale() * 1.0001);
+	CHECK_NEAR(rec16.eval(3.0f), is::polyval(coeffs, 3, 0.5), 1e-3);
+
+	// corruption: any flipped bit, a wrong version or a short buffer is rejected
+	for (size_t i = 0; i < size; i++) {
+		for (int bit = 0; bit < 8; bit++) {
+			buf[i] ^= (uint8_t)(1 << bit);
+			if (!CHECK(!rec.valid(size))) printf("  (byte %zu bit %d)\n", i, bit);
+			buf[i] ^= (uint8_t)(1 << bit);
+		}
+	}
+	CHECK(rec.valid(size));
+	CHECK(!rec.valid(size - 1));
+	CHECK(!CurveRecordView().valid());
+	CHECK(curveRecordWrite(buf, size - 1, 42, coeffs, 3) == 0);
+	CHECK(curveRecordWrite(buf, sizeof(buf), 42, coeffs, -1) == 0);
+}
+
+IS_CHECK_SUITE(CurveBank) {
+	const double a[2] = {1, 2}, b[3] = {3, -1, 0.5};
+	uint8_t ra[64], rb[64], bank[256];
+	CurveRecordView rec_a(ra), rec_b(rb);
+	CHECK(curveRecordWrite(ra, sizeof(ra), 100, a, 1) > 0);
+	CHECK(curveRecordWrite(rb, sizeof(rb), 200, b, 2, 0, 1, CURVE_INT16) > 0);
+
+	size_t offset = curveBankBegin(bank, sizeof(bank), 2);
+	CHECK(offset == CURVE_BANK_HEADER_SIZE + 2 * 4);
+	offset = curveBankAppend(bank, sizeof(bank), offset, 0, rec_a);
+	offset = curveBankAppend(bank, sizeof(bank), offset, 1, rec_b);
+	CHECK(offset == CURVE_BANK_HEADER_SIZE + 2 * 4 + rec_a.size() + rec_b.size());
+	size_t size = offset;
+
+	CurveBankView view(bank);
+	CHECK(view.valid(size));
+	CHECK(view.count() == 2);
+	CHECK(memcmp(view.record(0)._data, ra, rec_a.size()) == 0);
+	CHECK(memcmp(view.record(1)._data, rb, rec_b.size()) == 0);
+	CHECK(view.find(200)._data == view.record(1)._data);
+	CHECK(view.find(300)._data == nullptr);
+	CHECK(view.find(100).eval(2.0f) == 4.0f); // x + 2
+
+	// a corrupt record fails the full check but not the header-only one; a truncated bank fails both
+	bank[size - 3] ^= 0x10;
+	CHECK(!view.valid(size));
+	CHECK(view.valid(size, false));
+	bank[size - 3] ^= 0x10;
+	CHECK(!view.valid(size - rec_b.size() - 1, false));
+	CHECK(!view.valid(CURVE_BANK_HEADER_SIZE + 4));
+
+	// an offset past the end is rejected even though offset + header would wrap
+	uint8_t bad[CURVE_BANK_HEADER_SIZE + 4];
+	CHECK(curveBankBegin(bad, sizeof(bad), 1) == sizeof(bad));
+	const uint32_t huge = 0xFFFFFFF0u;
+	memcpy(bad + CURVE_BANK_HEADER_SIZE, &huge, 4);
+	CHECK(!CurveBankView(bad).valid(sizeof(bad), false));
+
+	// out of room
+	CHECK(curveBankBegin(bank, CURVE_BANK_HEADER_SIZE + 7, 2) == 0);
+	CHECK(curveBankAppend(bank, CURVE_BANK_HEADER_SIZE + 8 + rec_a.size() - 1, CURVE_BANK_HEADER_SIZE + 8, 0, rec_a) == 0);
+
+	// an index past the bank's count, which would write beyond its offsets table
+	CHECK(curveBankBegin(bank, sizeof(bank), 2) > 0);
+	CHECK(curveBankAppend(bank, sizeof(bank), CURVE_BANK_HEADER_SIZE + 8, 2, rec_a) == 0);
+}
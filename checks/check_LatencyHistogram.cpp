@@ -0,0 +1,68 @@
+#include "check.h"
+
+#include "LatencyHistogram.h"
+
+typedef LatencyHistogram<2, 20, uint16_t> CheckHistogram;
+
+IS_CHECK_SUITE(LatencyHistogram_buckets) {
+	// 2 digits: values below 256 have their own count, then each doubling has 128 buckets
+	CHECK(CheckHistogram::SUB_COUNT == 256 && CheckHistogram::HALF_COUNT == 128);
+	for (uint32_t v = 0; v < 256; v++) CHECK(CheckHistogram::indexOf(v) == (int)v);
+	CHECK(CheckHistogram::indexOf(256) == 256 && CheckHistogram::indexOf(257) == 256);
+	CHECK(CheckHistogram::lowestValueAt(256) == 256 && CheckHistogram::highestValueAt(256) == 257);
+	CHECK(CheckHistogram::indexOf(511) == 383 && CheckHistogram::indexOf(512) == 384);
+	CHECK(CheckHistogram::lowestValueAt(384) == 512 && CheckHistogram::highestValueAt(384) == 515);
+	CHECK(CheckHistogram::indexOf(CheckHistogram::HIGHEST) == CheckHistogram::COUNTS_LEN - 1);
+	CHECK(CheckHistogram::highestValueAt(CheckHistogram::COUNTS_LEN - 1) == CheckHistogram::HIGHEST);
+
+	// every value falls in a bucket that holds it, the buckets tile the range with no gaps, and
+	// each is narrow enough for 2 significant digits (width <= value / 128)
+	int last = -1;
+	for (uint32_t v = 0; v <= CheckHistogram::HIGHEST; v++) {
+		int i = CheckHistogram::indexOf(v);
+		uint32_t lo = CheckHistogram::lowestValueAt(i), hi = CheckHistogram::highestValueAt(i);
+		bool ok = i >= 0 && i < CheckHistogram::COUNTS_LEN && lo <= v && v <= hi && (i == last || (i == last + 1 && lo == v));
+		ok = ok && (v < 256 ? hi == lo : (hi - lo + 1) * 128 <= lo);
+		if (!CHECK(ok)) break;
+		last = i;
+	}
+}
+
+IS_CHECK_SUITE(LatencyHistogram_percentiles) {
+	CheckHistogram h;
+	CHECK(h.valueAtPercentile(50) == 0 && h.count() == 0 && h.minValue() == 0);
+	for (uint32_t v = 1; v <= 1000; v++) h.record(v);
+	CHECK(h.count() == 1000 && h.minValue() == 1 && h.maxValue() == 1000);
+	CHECK(h.valueAtPercentile(0) == 1);
+	CHECK(h.valueAtPercentile(100) == 1000);
+	uint32_t p50 = h.valueAtPercentile(50), p90 = h.valueAtPercentile(90), p99 = h.valueAtPercentile(99);
+	CHECK(p50 >= 500 && p50 <= 503); // the top of 500's bucket (512 > 500 >= 256: width 2)
+	CHECK(p90 >= 900 && p90 <= 903);
+	CHECK(p99 >= 990 && p99 <= 993);
+	CHECK_NEAR(h.mean(), 500.5, 1.0);
+
+	// merging is the same as recording both sets in one
+	CheckHistogram a, b, both;
+	for (uint32_t v = 0; v < 5000; v += 3) { a.record(v); both.record(v); }
+	for (uint32_t v = 7; v < 90000; v += 11) { b.record(v); both.record(v); }
+	a.merge(b);
+	CHECK(a.count() == both.count() && a.minValue() == both.minValue() && a.maxValue() == both.maxValue());
+	for (double p = 0; p <= 100; p += 2.5) CHECK(a.valueAtPercentile(p) == both.valueAtPercentile(p));
+
+	// values above HIGHEST are counted as HIGHEST
+	CheckHistogram c;
+	c.record(10);
+	c.record((TimeElapsed64_t)CheckHistogram::HIGHEST + 5);
+	CHECK(c.clamped() == 1 && c.maxValue() == CheckHistogram::HIGHEST);
+	CHECK(c.valueAtPercentile(100) == CheckHistogram::HIGHEST);
+
+	// a bucket saturates instead of wrapping, and percentiles stay on the saturated counts
+	CheckHistogram s;
+	for (int i = 0; i < 70000; i++) s.record(100);
+	CHECK(s.saturated());
+	CHECK(s._counts[CheckHistogram::indexOf(100)] == 65535);
+	CHECK(s.count() == 70000);
+	CHECK(s.valueAtPercentile(50) == 100 && s.valueAtPercentile(100) == 100);
+	s.clear();
+	CHECK(!s.saturated() && s.count() == 0);
+}
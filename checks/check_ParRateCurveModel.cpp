@@ -0,0 +1,35 @@
+#include "check.h"
+
+#include <stdint.h>
+#include <math.h>
+
+#include "ParRateCurveModel.h"
+
+IS_CHECK_SUITE(ParRateCurveModel_record) {
+	double coeffs[4] = {-0.1, 2, 30, 50}; // -0.1v^3 + 2v^2 + 30v + 50, times 2: up to ~900 over 0...10
+	ParRateCurveModel<double> model(2, coeffs, 4);
+	uint8_t buf[128];
+
+	// before buildLookup() the record is in v itself
+	size_t size = model.writeRecord(buf, sizeof(buf), 3);
+	CurveRecordView rec(buf);
+	CHECK(size > 0 && rec.valid(size));
+	CHECK(rec.xOffset() == 0 && rec.xScale() == 1);
+
+	// after it, x is the lookup range normalised to -1...1, which int16 quantizes to ~1e-4 of full scale
+	CHECK(model.buildLookup(0, 10, 64));
+	const CurveRecordFormat formats[2] = {CURVE_FLOAT32, CURVE_INT16};
+	for (CurveRecordFormat format : formats) {
+		size = model.writeRecord(buf, sizeof(buf), 3, format);
+		CHECK(size > 0 && rec.valid(size));
+		CHECK(rec.xOffset() == 5 && rec.xScale() == 0.2f);
+		double tol = format == CURVE_INT16 ? 0.05 : 1e-3;
+		for (double v = 0; v <= 10; v += 0.5) CHECK_NEAR(rec.eval((float)v), model.rateExact(v), tol);
+
+		// loading converts back to v
+		ParRateCurveModel<double> loaded;
+		CHECK(loaded.loadRecord(rec));
+		CHECK(loaded.multiplier == 1);
+		for (double v = 0; v <= 10; v += 0.5) CHECK_NEAR(loaded.rateExact(v), model.rateExact(v), tol);
+	}
+}
@@ -0,0 +1,19 @@
+#include "check.h"
+
+#include <string.h>
+
+#define IS_PROFILER_ENABLED 1
+#include "ScopeProfiler.h"
+
+IS_CHECK_SUITE(ScopeProfiler_register) {
+	// ids are handed out in order until they run out, then the last one is shared; the counter must not
+	// wrap around (uint8_t) and start reissuing taken ids however many scopes register
+	for (int i = 0; i < PROFILER_MAX_SCOPES - 1; i++) CHECK(profilerRegisterScope("scope") == i);
+	CHECK(profilerRegisterScope("last") == PROFILER_MAX_SCOPES - 1);
+	bool capped = true;
+	for (int i = 0; i < 600; i++) capped = capped && profilerRegisterScope("extra") == PROFILER_MAX_SCOPES - 1;
+	CHECK(capped);
+	CHECK(profilerScopeCount() == PROFILER_MAX_SCOPES);
+	CHECK(strcmp(profilerScopeName(PROFILER_MAX_SCOPES - 1), "last") == 0);
+	CHECK(profilerScopeName(PROFILER_MAX_SCOPES) == nullptr);
+}
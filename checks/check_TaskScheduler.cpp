@@ -0,0 +1,140 @@
+#include "check.h"
+
+#include "TaskScheduler.h"
+
+// a clock the checks set by hand
+static TimeElapsed_t g_now = 0;
+static TimeElapsed_t checkNow() { return g_now; }
+
+// each run appends its ctx (a tag) to g_order
+static int g_order[32];
+static int g_order_len = 0;
+static void recordRun(void* tag) {
+	if (g_order_len < 32) g_order[g_order_len++] = (int)(intptr_t)tag;
+}
+
+static void resetOrder() { g_order_len = 0; }
+
+// runs with the deadlines given as delays from start (which may be just before the clock wraps)
+static void checkDeadlineOrder(TimeElapsed_t start) {
+	g_now = start;
+	resetOrder();
+	TaskScheduler sched(checkNow);
+	const TimeElapsed_t delays[5] = {30, 10, 50, 20, 5};
+	for (int i = 0; i < 5; i++) CHECK(sched.addOneShot(recordRun, delays[i], (void*)(intptr_t)delays[i]) == i);
+	CHECK(sched.nextDue() == 4);
+	CHECK(sched.timeUntilNext() == 5);
+
+	CHECK(sched.runDue() == 0); // nothing is due yet
+	g_now = start + 35;
+	CHECK(sched.runDue() == 4);
+	CHECK(g_order_len == 4);
+	const int want[4] = {5, 10, 20, 30};
+	for (int i = 0; i < 4 && i < g_order_len; i++) CHECK(g_order[i] == want[i]);
+	CHECK(sched.nextDue() == 2);
+	CHECK(sched.timeUntilNext() == 15);
+	CHECK(!sched.task(1).active && sched.task(2).active);
+	g_now = start + 100;
+	CHECK(sched.runDue() == 1);
+	CHECK(sched.nextDue() == -1);
+	CHECK(sched.timeUntilNext() == 0);
+}
+
+static TaskScheduler* g_sched = nullptr;
+
+// cancels itself and adds a one-shot that reuses its id, 7 from now
+static void cancelAndReplace(void* tag) {
+	recordRun(tag);
+	g_sched->cancel(0);
+	g_sched->addOneShot(recordRun, 7, (void*)(intptr_t)99);
+}
+
+// moves itself 40 later instead of its period
+static void rescheduleSelf(void* tag) {
+	recordRun(tag);
+	g_sched->reschedule(0, 40);
+}
+
+// takes 25 of the clock
+static void slowRun(void* tag) {
+	recordRun(tag);
+	g_now += 25;
+}
+
+IS_CHECK_SUITE(TaskScheduler) {
+	checkDeadlineOrder(0);
+	checkDeadlineOrder((TimeElapsed_t)0 - 12); // deadlines on both sides of the wrap
+
+	// periodic: deadlines advance by exactly one period, runs start on time
+	{
+		g_now = 0;
+		resetOrder();
+		TaskScheduler sched(checkNow);
+		int id = sched.addTask(recordRun, 10, 10, (void*)1);
+		for (g_now = 0; g_now <= 100; g_now++) sched.runDue();
+		CHECK(sched.task(id).runs == 10);
+		CHECK(sched.task(id).deadline == 110);
+		CHECK(sched.task(id).max_jitter == 0);
+		CHECK(sched.task(id).overruns == 0);
+	}
+
+	// a run that ends after its next deadline is an overrun, and the periods it covered are skipped
+	{
+		g_now = 0;
+		resetOrder();
+		TaskScheduler sched(checkNow);
+		int id = sched.addTask(slowRun, 10, 10, (void*)1);
+		g_now = 10;
+		CHECK(sched.runDue() == 1); // ends at 35: the deadlines at 20 and 30 are missed
+		CHECK(sched.task(id).overruns == 1);
+		CHECK(sched.task(id).missed == 2);
+		CHECK(sched.task(id).deadline == 40);
+		CHECK(sched.task(id).max_run_time == 25);
+	}
+
+	// max_runs stops early; the rest run on the next call
+	{
+		g_now = 0;
+		resetOrder();
+		TaskScheduler sched(checkNow);
+		for (int i = 0; i < 3; i++) sched.addOneShot(recordRun, i, (void*)(intptr_t)i);
+		g_now = 5;
+		CHECK(sched.runDue(2) == 2);
+		CHECK(sched.runDue() == 1);
+		CHECK(g_order_len == 3 && g_order[0] == 0 && g_order[1] == 1 && g_order[2] == 2);
+	}
+
+	// a task that reschedules itself keeps the deadline it set rather than being advanced by its period
+	{
+		g_now = 0;
+		resetOrder();
+		TaskScheduler sched(checkNow);
+		g_sched = &sched;
+		CHECK(sched.addTask(rescheduleSelf, 10, 10, (void*)1) == 0);
+		sched.addTask(recordRun, 100, 20, (void*)2);
+		g_now = 10;
+		CHECK(sched.runDue() == 1);
+		CHECK(sched.task(0).deadline == 50);
+		g_now = 20;
+		CHECK(sched.runDue() == 1);
+		CHECK(sched.nextDue() == 0);
+	}
+
+	// a task that cancels itself and whose id is reused at once: the new task keeps its own deadline
+	{
+		g_now = 0;
+		resetOrder();
+		TaskScheduler sched(checkNow);
+		g_sched = &sched;
+		CHECK(sched.addTask(cancelAndReplace, 10, 10, (void*)1) == 0);
+		g_now = 10;
+		CHECK(sched.runDue() == 1);
+		CHECK(sched.task(0).active && sched.task(0).period == 0 && sched.task(0).deadline == 17);
+		CHECK(sched.task(0).runs == 0);
+		g_now = 17;
+		CHECK(sched.runDue() == 1);
+		CHECK(g_order_len == 2 && g_order[1] == 99);
+		CHECK(sched.nextDue() == -1);
+	}
+	g_sched = nullptr;
+}
@@ -0,0 +1,34 @@
+#include "check.h"
+
+#include "TimeElapsed.h"
+
+IS_CHECK_SUITE(TimeElapsed_wraps) {
+	const TimeElapsed_t top = (TimeElapsed_t)~(TimeElapsed_t)0;
+
+	// a passed-in "now" a little older than the last one is no time passing, not a wrap
+	TimeElapsed te;
+	te.clearAndStart(1000);
+	CHECK(te.elapsed(2000) == 1000);
+	CHECK(te.elapsed(1990) == 1000);
+	CHECK(te._tn_wraps == 0 && te._elapsedOverflows() == 0);
+	CHECK(te.elapsed(2500) == 1500);
+	CHECK(te.elapsed64() == 1500);
+	CHECK(te.elapsed(2600) == 1600);
+	CHECK(te.pause(false) == 1600);
+	CHECK(te.resume(2550) == 1600); // resuming at a slightly older "now" too: it resumes at 2600
+	CHECK(te._tn_wraps == 0);
+	CHECK(te.elapsed(2650) == 1650);
+
+	// the time function wrapping is counted, and extended mode keeps counting past it
+	TimeElapsed ext;
+	ext.setExtended();
+	ext.clearAndStart(top - 9);
+	CHECK(ext.elapsed(5) == 15);
+	CHECK(ext._tn_wraps == 1);
+	CHECK(ext.elapsed64() == 15 && ext.elapsedSinceStart64() == 15);
+	ext.elapsed(top / 2);
+	ext.elapsed(top - 20); // forward steps of up to half the range are not wraps
+	CHECK(ext._tn_wraps == 1);
+	ext.elapsed(3);
+	CHECK(ext._tn_wraps == 2);
+}
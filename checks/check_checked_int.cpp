@@ -0,0 +1,81 @@
+#include "check.h"
+
+#include <stdint.h>
+
+#include "checked_int.h"
+
+// every int8_t/uint8_t pair against the same operation in int, which can't overflow
+template <typename T>
+static void checkExhaustive8() {
+	const int lo = is::IntLimits<T>::min(), hi = is::IntLimits<T>::max();
+	bool ok = true;
+	for (int a = lo; a <= hi && ok; a++) {
+		for (int b = lo; b <= hi && ok; b++) {
+			const int sums[3] = {a + b, a - b, a * b};
+			T wrapped[3], sat[3] = {is::satAdd<T>((T)a, (T)b), is::satSub<T>((T)a, (T)b), is::satMul<T>((T)a, (T)b)};
+			bool overflow[3] = {is::addOverflow<T>((T)a, (T)b, &wrapped[0]), is::subOverflow<T>((T)a, (T)b, &wrapped[1]),
+				is::mulOverflow<T>((T)a, (T)b, &wrapped[2])};
+			for (int k = 0; k < 3; k++) {
+				int v = sums[k];
+				ok = ok && overflow[k] == (v < lo || v > hi) && wrapped[k] == (T)v && sat[k] == (v < lo ? lo : (v > hi ? hi : v));
+			}
+		}
+		for (int shift = 0; shift <= 9 && ok; shift++) {
+			long v = (long)a * (1L << shift);
+			T r;
+			bool overflow = is::shlOverflow<T>((T)a, shift, &r);
+			ok = overflow == (v < lo || v > hi) && is::satShl<T>((T)a, shift) == (v < lo ? lo : (v > hi ? hi : v));
+		}
+	}
+	CHECK(ok);
+}
+
+IS_CHECK_SUITE(checked_int) {
+	CHECK(is::IntLimits<int8_t>::min() == INT8_MIN && is::IntLimits<int8_t>::max() == INT8_MAX);
+	CHECK(is::IntLimits<uint16_t>::max() == UINT16_MAX && is::IntLimits<uint16_t>::min() == 0);
+	CHECK(is::IntLimits<int64_t>::min() == INT64_MIN && is::IntLimits<int64_t>::max() == INT64_MAX);
+	CHECK(is::IntLimits<uint64_t>::max() == UINT64_MAX && is::IntLimits<uint32_t>::bits() == 32);
+
+	checkExhaustive8<int8_t>();
+	checkExhaustive8<uint8_t>();
+
+	// the limit cases of the wide types
+	int32_t r32;
+	CHECK(is::mulOverflow<int32_t>(INT32_MIN, -1, &r32) && r32 == INT32_MIN);
+	CHECK(is::satMul<int32_t>(INT32_MIN, -1) == INT32_MAX);
+	CHECK(is::satMul<int32_t>(INT32_MIN, 1) == INT32_MIN);
+	CHECK(is::satMul<int32_t>(-65536, 65536) == INT32_MIN);
+	CHECK(is::satSub<int32_t>(0, INT32_MIN) == INT32_MAX);
+	CHECK(is::satSub<int32_t>(-1, INT32_MIN) == INT32_MAX && is::safeToSub<int32_t>(-1, INT32_MIN));
+	CHECK(is::satAdd<int64_t>(INT64_MAX, 1) == INT64_MAX && is::satAdd<int64_t>(INT64_MIN, -1) == INT64_MIN);
+	CHECK(is::satAdd<int64_t>(INT64_MAX, INT64_MIN) == -1);
+	CHECK(is::satMul<int64_t>(INT64_MIN, -1) == INT64_MAX);
+	CHECK(is::satMul<uint64_t>(UINT64_MAX, 2) == UINT64_MAX && is::satMul<uint64_t>(UINT64_MAX, 0) == 0);
+	CHECK(is::satSub<uint32_t>(3, 5) == 0 && is::satAdd<uint32_t>(UINT32_MAX, 1) == UINT32_MAX);
+	CHECK(!is::safeToAdd<uint64_t>(UINT64_MAX, 1) && is::safeToAdd<uint64_t>(UINT64_MAX, 0));
+
+	// shifts: copies of the sign bit may go, anything else is an overflow; shifting by the width or more
+	int16_t r16;
+	CHECK(!is::shlOverflow<int16_t>(-1, 15, &r16) && r16 == INT16_MIN);
+	CHECK(is::shlOverflow<int16_t>(1, 15, &r16) && r16 == INT16_MIN);
+	CHECK(is::satShl<int16_t>(1, 15) == INT16_MAX && is::satShl<int16_t>(-2, 15) == INT16_MIN);
+	CHECK(is::satShl<uint32_t>(1, 32) == UINT32_MAX && is::satShl<uint32_t>(0, 40) == 0);
+	CHECK(is::satShl<int64_t>(-1, 64) == INT64_MIN && is::safeToShl<int64_t>(1, 62) && !is::safeToShl<int64_t>(1, 63));
+
+	// blocks: clamped elements are counted
+	const int16_t a[4] = {INT16_MAX, 100, INT16_MIN, -5}, b[4] = {1, 200, -1, 5};
+	int16_t out[4];
+	CHECK(is::satAddBlock(a, b, out, 4) == 2);
+	CHECK(out[0] == INT16_MAX && out[1] == 300 && out[2] == INT16_MIN && out[3] == 0);
+	CHECK(is::satSubBlock(a, b, out, 4) == 0);
+	CHECK(out[0] == INT16_MAX - 1 && out[1] == -100 && out[2] == INT16_MIN + 1 && out[3] == -10);
+
+	// gain 1.5 (Q14), offset -100, clamped to a 12-bit code; rounds half up
+	const uint16_t codes[5] = {0, 67, 1000, 2800, 65535};
+	uint16_t dac[5];
+	CHECK(is::satScaleBlock(codes, dac, 5, (int16_t)24576, 14, (int16_t)-100, (uint16_t)0, (uint16_t)4095) == 3);
+	CHECK(dac[0] == 0 && dac[1] == 1 && dac[2] == 1400 && dac[3] == 4095 && dac[4] == 4095);
+	uint8_t u8[3] = {0, 128, 255}, u8_out[3];
+	CHECK(is::satScaleBlock(u8, u8_out, 3, (int16_t)-1, 0, (int16_t)0) == 2); // negated: only 0 fits
+	CHECK(u8_out[0] == 0 && u8_out[1] == 0 && u8_out[2] == 0);
+}
@@ -0,0 +1,131 @@
+#include "check.h"
+
+#include <stdint.h>
+#include <math.h>
+#include <vector>
+
+#include "matrices.h"
+
+// an n x n matrix as the row pointers the solvers take
+struct CheckMatrix {
+	std::vector<double> data;
+	std::vector<double*> rows;
+
+	explicit CheckMatrix(int n) : data((size_t)n * n), rows(n) { _point(); }
+	CheckMatrix(const CheckMatrix& other) : data(other.data), rows(other.rows.size()) { _point(); }
+	void _point() {
+		for (size_t i = 0; i < rows.size(); i++) rows[i] = &data[i * rows.size()];
+	}
+	double** ptr() { return rows.data(); }
+};
+
+// ||A*x - b||inf / (||A||inf * ||x||inf): ~n * 1e-16 for a backward-stable solve
+static double relativeResidual(const CheckMatrix& A, const double* x, const double* b, int n) {
+	double r = 0, a = 0, xn = 0;
+	for (int i = 0; i < n; i++) {
+		double sum = -b[i], row = 0;
+		for (int j = 0; j < n; j++) {
+			sum += A.data[(size_t)i * n + j] * x[j];
+			row += fabs(A.data[(size_t)i * n + j]);
+		}
+		r = fmax(r, fabs(sum));
+		a = fmax(a, row);
+		xn = fmax(xn, fabs(x[i]));
+	}
+	return r / (a * xn);
+}
+
+IS_CHECK_SUITE(matrices_lu) {
+	// larger than MATRICES_LU_BLOCK so the blocked update and the pivoting across panels both run
+	const int n = 150;
+	CheckMatrix A(n);
+	std::vector<double> b(n), x_ge(n), x_lu(n);
+	uint32_t seed = 12345;
+	for (double& v : A.data) {
+		seed = seed * 1664525u + 1013904223u;
+		v = (double)(seed >> 8) / (1 << 24) - 0.5;
+	}
+	for (int i = 0; i < n; i++) b[i] = sin(i + 1.0);
+
+	CheckMatrix A_ge = A, A_lu = A; // the solvers overwrite A (and permute its row pointers)
+	std::vector<double> b_ge = b;
+	CHECK(is::gaussianElimination(A_ge.ptr(), b_ge.data(), x_ge.data(), n) == is::SOLVE_OK);
+
+	std::vector<int> perm(n);
+	double rcond = -1;
+	CHECK(is::luFactor(A_lu.ptr(), perm.data(), n, &rcond) != is::SOLVE_RANK_DEFICIENT);
+	CHECK(rcond > 0 && rcond <= 1);
+	is::luSolve(A_lu.ptr(), perm.data(), b.data(), x_lu.data(), n);
+
+	double res_ge = relativeResidual(A, x_ge.data(), b.data(), n);
+	double res_lu = relativeResidual(A, x_lu.data(), b.data(), n);
+	CHECK(res_lu < 1e-13);
+	CHECK(res_lu <= 10 * res_ge + 1e-15);
+	for (int i = 0; i < n; i++) CHECK_NEAR(x_lu[i], x_ge[i], 1e-9 * (1 + fabs(x_ge[i])));
+
+	// luSolveMany() gives the same answers as one luSolve() per right-hand side
+	std::vector<double> b2(n), x1(n), x2(n);
+	for (int i = 0; i < n; i++) b2[i] = cos(i * 0.5);
+	double* B[2] = {b.data(), b2.data()};
+	double* X[2] = {x1.data(), x2.data()};
+	is::luSolveMany(A_lu.ptr(), perm.data(), B, X, n, 2);
+	for (int i = 0; i < n; i++) CHECK(x1[i] == x_lu[i]);
+	CHECK(relativeResidual(A, x2.data(), b2.data(), n) < 1e-13);
+
+	// a repeated row: the matching unknown is set to 0 rather than inf/NaN
+	const int m = 4;
+	CheckMatrix S(m);
+	const double s_rows[m][m] = {{2, 1, 0, 1}, {1, 3, 1, 0}, {2, 1, 0, 1}, {0, 1, 4, 1}};
+	for (int i = 0; i < m; i++) for (int j = 0; j < m; j++) S.rows[i][j] = s_rows[i][j];
+	int s_perm[m];
+	double s_b[m] = {1, 2, 1, 3}, s_x[m];
+	CHECK(is::luFactor(S.ptr(), s_perm, m) == is::SOLVE_RANK_DEFICIENT);
+	is::luSolve(S.ptr(), s_perm, s_b, s_x, m);
+	for (int i = 0; i < m; i++) CHECK(isfinite(s_x[i]));
+}
+
+// factors A (n x n) with choleskyFactor() or ldltFactor() and checks the result for b = A * x_true
+static void checkSymmetricRankDeficient(bool ldlt) {
+	// rank 2: A = u*u^T + v*v^T, so columns 2 and 3 are combinations of columns 0 and 1
+	const int n = 4;
+	const double u[n] = {1, 2, 3, 4}, v[n] = {1, -1, 2, 0};
+	CheckMatrix A(n), F(n);
+	for (int i = 0; i < n; i++) for (int j = 0; j < n; j++) A.rows[i][j] = F.rows[i][j] = u[i] * u[j] + v[i] * v[j];
+	const double x_true[n] = {1, -2, 0.5, 3};
+	double b[n], x[n];
+	for (int i = 0; i < n; i++) {
+		b[i] = 0;
+		for (int j = 0; j < n; j++) b[i] += A.rows[i][j] * x_true[j];
+	}
+
+	double rcond = -1;
+	int rank = -1;
+	is::SolveStatus status = ldlt ? is::ldltFactor(F.ptr(), n, &rcond, &rank) : is::choleskyFactor(F.ptr(), n, &rcond, &rank);
+	CHECK(status == is::SOLVE_RANK_DEFICIENT);
+	CHECK(rank == 2);
+	CHECK(rcond == 0);
+	if (ldlt) is::ldltSolve(F.ptr(), b, x, n);
+	else is::choleskySolve(F.ptr(), b, x, n);
+	// a finite basic solution: the dependent unknowns are 0 and A*x still reproduces b
+	for (int i = 0; i < n; i++) CHECK(isfinite(x[i]));
+	CHECK(x[2] == 0 && x[3] == 0);
+	CHECK(relativeResidual(A, x, b, n) < 1e-12);
+
+	// not positive definite at all: reported, with rcond 0 and the rank before the failing column
+	CheckMatrix N(2);
+	N.rows[0][0] = 1, N.rows[0][1] = 2, N.rows[1][0] = 2, N.rows[1][1] = 1;
+	rcond = -1;
+	rank = -1;
+	status = ldlt ? is::ldltFactor(N.ptr(), 2, &rcond, &rank) : is::choleskyFactor(N.ptr(), 2, &rcond, &rank);
+	CHECK(status == is::SOLVE_NOT_POSITIVE_DEFINITE);
+	CHECK(rcond == 0);
+	CHECK(rank == 1);
+}
+
+IS_CHECK_SUITE(matrices_cholesky) {
+	checkSymmetricRankDeficient(false);
+}
+
+IS_CHECK_SUITE(matrices_ldlt) {
+	checkSymmetricRankDeficient(true);
+}
@@ -0,0 +1,40 @@
+#include "check.h"
+
+#include <stdint.h>
+#include <math.h>
+
+#include "polynomial.h"
+
+#define CHECK_SELECT_POINTS 80
+#define CHECK_SELECT_MAX_DEG 7
+
+IS_CHECK_SUITE(polyfitSelect) {
+	// a cubic plus small deterministic noise: every criterion should pick degree 3 and recover it
+	const double truth[4] = {3, 0.5, -2, 1}; // 3x^3 + 0.5x^2 - 2x + 1
+	double x[CHECK_SELECT_POINTS], y[CHECK_SELECT_POINTS];
+	uint32_t seed = 777;
+	for (int i = 0; i < CHECK_SELECT_POINTS; i++) {
+		x[i] = -1 + 2.0 * i / (CHECK_SELECT_POINTS - 1);
+		seed = seed * 1664525u + 1013904223u;
+		y[i] = is::polyval(truth, 3, x[i]) + 1e-3 * ((double)(seed >> 8) / (1 << 24) - 0.5);
+	}
+
+	const is::PolyfitCriterion criteria[3] = {is::POLYFIT_CV, is::POLYFIT_AIC, is::POLYFIT_BIC};
+	for (is::PolyfitCriterion criterion : criteria) {
+		double coeffs[CHECK_SELECT_MAX_DEG + 1];
+		is::PolyfitDegreeStats stats[CHECK_SELECT_MAX_DEG];
+		int deg = is::polyfitSelect(x, y, CHECK_SELECT_POINTS, CHECK_SELECT_MAX_DEG, coeffs, stats, criterion);
+		CHECK(deg == 3);
+		if (deg != 3) continue;
+		for (int i = 0; i <= 3; i++) CHECK_NEAR(coeffs[i], truth[i], 1e-3);
+		for (int d = 1; d <= CHECK_SELECT_MAX_DEG; d++) CHECK(stats[d - 1].deg == d);
+		// degree 2 can't follow a cubic; degree 3 is down at the noise (uniform +-5e-4 has RMS ~2.9e-4)
+		CHECK(stats[1].rmse > 100 * stats[2].rmse);
+		CHECK(stats[2].rmse < 5e-4);
+	}
+
+	// too few points or no degrees to choose from
+	double coeffs[2];
+	CHECK(is::polyfitSelect(x, y, 1, 1, coeffs) == -1);
+	CHECK(is::polyfitSelect(x, y, CHECK_SELECT_POINTS, 0, coeffs) == -1);
+}
@@ -0,0 +1,88 @@
+#include "check.h"
+
+#include <math.h>
+
+#include "spline.h"
+
+static double cubic(double x) { return 2 - x + 0.5 * x * x + 0.25 * x * x * x; }
+static double cubicSlope(double x) { return -1 + x + 0.75 * x * x; }
+
+IS_CHECK_SUITE(splineInterpolate) {
+	// natural spline through (0,0), (1,1), (2,0): M1 = -3, so the first segment is 1.5t - 0.5t^3
+	{
+		const double x[3] = {0, 1, 2}, y[3] = {0, 1, 0};
+		double c[8];
+		CHECK(is::splineInterpolate(x, y, 3, c));
+		const double want[8] = {0, 1.5, 0, -0.5, 1, 0, -1.5, 0.5};
+		for (int i = 0; i < 8; i++) CHECK_NEAR(c[i], want[i], 1e-12);
+		is::CubicSpline<double> s;
+		CHECK(s.interpolate(x, y, 3));
+		CHECK_NEAR(s.eval(0.5), 0.6875, 1e-12);
+		CHECK_NEAR(s.eval(1.5), 0.6875, 1e-12);
+		CHECK_NEAR(s.derivative(1.0), 0, 1e-12);
+	}
+
+	// a clamped spline with the true end slopes reproduces a cubic exactly, on uneven knots too
+	{
+		const double x[6] = {-2, -1.5, 0, 0.3, 1, 2.5};
+		double y[6];
+		for (int i = 0; i < 6; i++) y[i] = cubic(x[i]);
+		is::CubicSpline<double> s;
+		CHECK(s.interpolate(x, y, 6, is::SPLINE_CLAMPED, cubicSlope(-2), cubicSlope(2.5)));
+		for (double t = -2; t <= 2.5; t += 0.1) {
+			CHECK_NEAR(s.eval(t), cubic(t), 1e-12);
+			CHECK_NEAR(s.derivative(t), cubicSlope(t), 1e-11);
+		}
+	}
+
+	// evenly spaced knots (the O(1) segment lookup) give the same values as the search
+	{
+		double x[11], y[11], xs[7] = {-1, 0, 0.05, 0.37, 0.5, 0.99, 1.3}, ys[7];
+		for (int i = 0; i < 11; i++) x[i] = i * 0.1, y[i] = sin(3 * x[i]);
+		is::CubicSpline<double> s;
+		CHECK(s.interpolate(x, y, 11));
+		CHECK(s._uniform);
+		for (int i = 0; i < 11; i++) CHECK_NEAR(s.eval(x[i]), y[i], 1e-12);
+		s.evalBlock(xs, ys, 7);
+		for (int i = 0; i < 7; i++) CHECK(ys[i] == s.eval(xs[i]));
+		CHECK(s.segment(-1) == 0 && s.segment(0.05) == 0 && s.segment(0.37) == 3 && s.segment(1.3) == 9);
+	}
+
+	const double bad_x[3] = {0, 1, 1}, y[3] = {0, 1, 2};
+	double c[8];
+	CHECK(!is::splineInterpolate(bad_x, y, 3, c));
+	CHECK(!is::splineInterpolate(bad_x, y, 1, c));
+}
+
+IS_CHECK_SUITE(splineSmooth) {
+	const int n = 9;
+	double x[n], y[n], w[n];
+	for (int i = 0; i < n; i++) {
+		x[i] = i * i * 0.25; // uneven
+		y[i] = 1 + 2 * x[i] + (i % 2 ? 0.3 : -0.3);
+		w[i] = 1;
+	}
+
+	// lambda = 0 interpolates: the natural interpolating spline
+	double smooth[4 * (n - 1)], interp[4 * (n - 1)];
+	CHECK(is::splineSmooth(x, y, w, n, 0, smooth));
+	CHECK(is::splineInterpolate(x, y, n, interp));
+	for (int i = 0; i < 4 * (n - 1); i++) CHECK_NEAR(smooth[i], interp[i], 1e-9 * (1 + fabs(interp[i])));
+
+	// a huge lambda tends to the least-squares straight line
+	double sx = 0, sy = 0, sxx = 0, sxy = 0;
+	for (int i = 0; i < n; i++) sx += x[i], sy += y[i], sxx += x[i] * x[i], sxy += x[i] * y[i];
+	double slope = (n * sxy - sx * sy) / (n * sxx - sx * sx), intercept = (sy - slope * sx) / n;
+	is::CubicSpline<double> s;
+	CHECK(s.smooth(x, y, nullptr, n, 1e12));
+	for (int i = 0; i < n; i++) CHECK_NEAR(s.eval(x[i]), intercept + slope * x[i], 1e-4);
+
+	// data on a line is left alone for any lambda
+	for (int i = 0; i < n; i++) y[i] = 1 + 2 * x[i];
+	CHECK(s.smooth(x, y, w, n, 10));
+	for (double t = 0; t <= x[n - 1]; t += 0.5) CHECK_NEAR(s.eval(t), 1 + 2 * t, 1e-9);
+
+	w[3] = 0;
+	CHECK(!is::splineSmooth(x, y, w, n, 1, smooth));
+	CHECK(!is::splineSmooth(x, y, nullptr, 2, 1, smooth));
+}
@@ -0,0 +1,74 @@
+#include "ADCScheduler.h"
+
+ADCScheduler::ADCScheduler(ADCSchedulerMode mode, int(*read_func)(uint8_t)): _read_func{read_func}, _mode{mode} {}
+
+int ADCScheduler::addChannel(uint8_t pin, int weight) {
+	if (_n_channels >= ADCSCHEDULER_MAX_CHANNELS) return -1;
+	if (weight < 1) weight = 1;
+	_pins[_n_channels] = pin;
+	_weights[_n_channels] = weight;
+	_credits[_n_channels] = 0;
+	_dropped[_n_channels] = 0;
+	_weight_total += weight;
+	return _n_channels++;
+}
+
+void ADCScheduler::setWeight(uint8_t channel, int weight) {
+	if (channel >= _n_channels) return;
+	if (weight < 1) weight = 1;
+	_weight_total += weight - _weights[channel];
+	_weights[channel] = weight;
+	setMode(_mode); // restart the sequence so old credits don't skew the new weights
+}
+
+void ADCScheduler::setMode(ADCSchedulerMode mode) {
+	_mode = mode;
+	_next_rr = 0;
+	for (uint8_t i = 0; i < _n_channels; i++) _credits[i] = 0;
+}
+
+int ADCScheduler::nextChannel() {
+	if (_n_channels == 0) return -1;
+
+	if (_mode == ROUND_ROBIN) {
+		uint8_t ch = _next_rr;
+		if (++_next_rr >= _n_channels) _next_rr = 0;
+		return ch;
+	}
+
+	// PRIORITY_WEIGHTED: smooth weighted round robin
+	uint8_t best = 0;
+	for (uint8_t i = 0; i < _n_channels; i++) {
+		_credits[i] += _weights[i];
+		if (_credits[i] > _credits[best]) best = i;
+	}
+	_credits[best] -= _weight_total;
+	return best;
+}
+
+int ADCScheduler::tick() {
+	int ch = nextChannel();
+	if (ch < 0) return ch;
+	int16_t sample = (*_read_func)(_pins[ch]);
+	if (!_rings[ch].push(sample)) ++_dropped[ch];
+	return ch;
+}
+
+void ADCScheduler::run(unsigned conversions) {
+	for (unsigned i = 0; i < conversions; i++) tick();
+}
+
+unsigned ADCScheduler::readBlock(uint8_t channel, int16_t* out, unsigned max_samples) {
+	if (channel >= _n_channels) return 0;
+	return _rings[channel].popBlock(out, max_samples);
+}
+
+unsigned ADCScheduler::available(uint8_t channel) {
+	if (channel >= _n_channels) return 0;
+	return _rings[channel].size();
+}
+
+unsigned long ADCScheduler::dropped(uint8_t channel) {
+	if (channel >= _n_channels) return 0;
+	return _dropped[channel];
+}
@@ -0,0 +1,103 @@
+#pragma once
+
+/**************************************************************************************************
+* @file  ADCScheduler.h
+*
+* @brief ADCScheduler owns several ADC channels, decides which one to convert next and delivers
+* each channel's samples into its own lock-free ring (see SPSCRing.h).
+***************************************************************************************************/
+
+#include <Arduino.h>
+#include "SPSCRing.h"
+
+#ifndef ADCSCHEDULER_MAX_CHANNELS
+#define ADCSCHEDULER_MAX_CHANNELS 4 ///< number of channels an ADCScheduler can own
+#endif
+
+#ifndef ADCSCHEDULER_RING_SIZE
+#define ADCSCHEDULER_RING_SIZE 32 ///< per-channel ring size in samples (power of 2, holds one less)
+#endif
+
+typedef SPSCRing<int16_t, ADCSCHEDULER_RING_SIZE> ADCSampleRing;
+
+enum ADCSchedulerMode {
+	ROUND_ROBIN,      ///< every channel in turn, ignoring weights
+	PRIORITY_WEIGHTED ///< smooth weighted round robin: a channel of weight 3 is converted 3x as often as one of weight 1
+}; ///< enum for ADCScheduler obj._mode
+
+/**
+ * The producer side (tick() or run(), called from the loop, a timer ISR or a sampling thread) is
+ * the only writer of the rings and the consumer side (readBlock()) is the only reader, so the two
+ * may run concurrently without a lock. Channel setup (addChannel(), setWeight(), setMode()) must be
+ * done while the producer is not running.
+ *
+ * In PRIORITY_WEIGHTED mode each channel's credit grows by its weight every conversion and the
+ * channel with the most credit is converted and pays back the total weight. This spreads a
+ * channel's conversions evenly instead of bunching them, e.g. weights {pitch=3, mod=1} give
+ * pitch, pitch, mod, pitch, pitch, pitch, mod, pitch...
+ */
+class ADCScheduler {
+ public:
+	int (*_read_func)(uint8_t); // read function is normally analogRead() [Make getter/setter]
+	ADCSchedulerMode _mode;
+
+	uint8_t _n_channels = 0;
+	uint8_t _next_rr = 0;       // next channel in ROUND_ROBIN mode
+	int _weight_total = 0;      // sum of _weights
+	uint8_t _pins[ADCSCHEDULER_MAX_CHANNELS];
+	int _weights[ADCSCHEDULER_MAX_CHANNELS];
+	int _credits[ADCSCHEDULER_MAX_CHANNELS];
+	unsigned long _dropped[ADCSCHEDULER_MAX_CHANNELS]; // samples lost because the ring was full (producer-written)
+	ADCSampleRing _rings[ADCSCHEDULER_MAX_CHANNELS];
+
+	/**
+	 * @param mode (default=ROUND_ROBIN) how to pick the next channel
+	 * @param read_func (default=analogRead) function called with a channel's pin to do one conversion
+	 */
+	ADCScheduler(ADCSchedulerMode mode=ROUND_ROBIN, int(*read_func)(uint8_t)=analogRead);
+
+	/**
+	 * @brief adds a channel (must not be called while the producer is running)
+	 * @param pin passed to the read function, e.g. A0
+	 * @param weight (default=1) relative conversion rate in PRIORITY_WEIGHTED mode (must be >0)
+	 * @return int the new channel's index, or -1 if ADCSCHEDULER_MAX_CHANNELS are already in use
+	 */
+	int addChannel(uint8_t pin, int weight=1);
+
+	/// @brief changes a channel's weight (must not be called while the producer is running)
+	void setWeight(uint8_t channel, int weight);
+
+	/// @brief changes the mode and restarts the sequence (must not be called while the producer is running)
+	void setMode(ADCSchedulerMode mode);
+
+	//**** producer side **************************************************
+
+	/**
+	 * @brief picks the channel to convert next and advances the sequence (does not read)
+	 * @return int channel index or -1 if there are no channels
+	 */
+	int nextChannel();
+
+	/**
+	 * @brief does one conversion on nextChannel() and pushes it into that channel's ring
+	 * @return int the channel converted or -1 if there are no channels
+	 */
+	int tick();
+
+	/// @brief calls tick() conversions times
+	void run(unsigned conversions);
+
+	//**** consumer side **************************************************
+
+	/**
+	 * @brief moves up to max_samples of a channel's oldest samples into out
+	 * @return unsigned number of samples written to out
+	 */
+	unsigned readBlock(uint8_t channel, int16_t* out, unsigned max_samples);
+
+	/// @return unsigned number of a channel's samples waiting to be read
+	unsigned available(uint8_t channel);
+
+	/// @return unsigned long number of a channel's samples dropped because its ring was full
+	unsigned long dropped(uint8_t channel);
+};
@@ -0,0 +1,189 @@
+#include "CurveRecord.h"
+
+#include <string.h>
+#include <math.h>
+
+#if !defined(ARDUINO)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+// unaligned little-endian loads/stores (all supported targets are little-endian)
+static inline uint16_t loadU16(const uint8_t* p) { uint16_t v; memcpy(&v, p, 2); return v; }
+static inline uint32_t loadU32(const uint8_t* p) { uint32_t v; memcpy(&v, p, 4); return v; }
+static inline float loadF32(const uint8_t* p) { float v; memcpy(&v, p, 4); return v; }
+static inline int16_t loadI16(const uint8_t* p) { int16_t v; memcpy(&v, p, 2); return v; }
+static inline void storeU16(uint8_t* p, uint16_t v) { memcpy(p, &v, 2); }
+static inline void storeU32(uint8_t* p, uint32_t v) { memcpy(p, &v, 4); }
+static inline void storeF32(uint8_t* p, float v) { memcpy(p, &v, 4); }
+static inline void storeI16(uint8_t* p, int16_t v) { memcpy(p, &v, 2); }
+
+static inline int coeffBytes(CurveRecordFormat format) { return format == CURVE_INT16 ? 2 : 4; }
+
+uint16_t curveRecordCRC16(const uint8_t* data, size_t size) {
+	uint16_t crc = 0xFFFF;
+	for (size_t i = 0; i < size; i++) {
+		crc ^= (uint16_t)data[i] << 8;
+		for (int b = 0; b < 8; b++) crc = (crc & 0x8000) ? (crc << 1) ^ 0x1021 : crc << 1;
+	}
+	return crc;
+}
+
+size_t curveRecordSize(int degree, CurveRecordFormat format) {
+	return CURVE_RECORD_HEADER_SIZE + (degree + 1) * coeffBytes(format) + 2;
+}
+
+size_t curveRecordWrite(uint8_t* out, size_t out_size, uint16_t channel_id, const double* coeffs, int degree,
+	float x_offset, float x_scale, CurveRecordFormat format) {
+
+	if (degree < 0 || degree > 255) return 0;
+	size_t size = curveRecordSize(degree, format);
+	if (out_size < size || size > 0xFFFF) return 0;
+
+	float coeff_scale = 1.0;
+	if (format == CURVE_INT16) {
+		double max_abs = 0;
+		for (int i = 0; i <= degree; i++) if (fabs(coeffs[i]) > max_abs) max_abs = fabs(coeffs[i]);
+		coeff_scale = max_abs > 0 ? (float)(max_abs / 32767.0) : 1.0f;
+	}
+
+	out[0] = CURVE_RECORD_VERSION;
+	out[1] = (uint8_t)format;
+	storeU16(out + 2, channel_id);
+	out[4] = (uint8_t)degree;
+	out[5] = 0;
+	storeU16(out + 6, (uint16_t)size);
+	storeF32(out + 8, x_offset);
+	storeF32(out + 12, x_scale);
+	storeF32(out + 16, coeff_scale);
+
+	uint8_t* p = out + CURVE_RECORD_HEADER_SIZE;
+	for (int i = 0; i <= degree; i++) {
+		if (format == CURVE_INT16) {
+			storeI16(p, (int16_t)lround(coeffs[i] / coeff_scale));
+			p += 2;
+		} else {
+			storeF32(p, (float)coeffs[i]);
+			p += 4;
+		}
+	}
+	storeU16(p, curveRecordCRC16(out, size - 2));
+	return size;
+}
+
+//**** CurveRecordView *******************************************************
+
+bool CurveRecordView::valid(size_t max_size) const {
+	if (!_data || version() != CURVE_RECORD_VERSION) return false;
+	if (format() != CURVE_FLOAT32 && format() != CURVE_INT16) return false;
+	size_t size = this->size();
+	if (size != curveRecordSize(degree(), format())) return false;
+	if (max_size && size > max_size) return false;
+	return loadU16(_data + size - 2) == curveRecordCRC16(_data, size - 2);
+}
+
+uint16_t CurveRecordView::channelId() const { return loadU16(_data + 2); }
+
+uint16_t CurveRecordView::size() const { return loadU16(_data + 6); }
+
+float CurveRecordView::xOffset() const { return loadF32(_data + 8); }
+
+float CurveRecordView::xScale() const { return loadF32(_data + 12); }
+
+float CurveRecordView::coeffScale() const { return loadF32(_data + 16); }
+
+double CurveRecordView::coeff(int i) const {
+	const uint8_t* p = _data + CURVE_RECORD_HEADER_SIZE;
+	if (format() == CURVE_INT16) return loadI16(p + 2 * i) * (double)coeffScale();
+	return loadF32(p + 4 * i);
+}
+
+float CurveRecordView::eval(float x) const {
+	float u = (x - xOffset()) * xScale();
+	int deg = degree();
+	const uint8_t* p = _data + CURVE_RECORD_HEADER_SIZE;
+
+	if (format() == CURVE_INT16) {
+		// Horner on the integers, scaled once at the end
+		float y = loadI16(p);
+		for (int i = 1; i <= deg; i++) y = y * u + loadI16(p + 2 * i);
+		return y * coeffScale();
+	}
+	float y = loadF32(p);
+	for (int i = 1; i <= deg; i++) y = y * u + loadF32(p + 4 * i);
+	return y;
+}
+
+void CurveRecordView::evalBlock(const float* x, float* y, int count) const {
+	for (int i = 0; i < count; i++) y[i] = eval(x[i]);
+}
+
+//**** CurveBankView *********************************************************
+
+bool CurveBankView::valid(size_t size, bool check_records) const {
+	if (!_data || size < CURVE_BANK_HEADER_SIZE) return false;
+	if (memcmp(_data, "ISCB", 4) != 0 || _data[4] != CURVE_RECORD_VERSION) return false;
+	uint16_t n = count();
+	if (size < CURVE_BANK_HEADER_SIZE + 4 * (size_t)n) return false;
+	for (uint16_t i = 0; i < n; i++) {
+		uint32_t offset = loadU32(_data + CURVE_BANK_HEADER_SIZE + 4 * i);
+		if (offset > size || size - offset < CURVE_RECORD_HEADER_SIZE) return false; // (offset + header could wrap)
+		if (check_records && !record(i).valid(size - offset)) return false;
+	}
+	return true;
+}
+
+uint16_t CurveBankView::count() const { return loadU16(_data + 6); }
+
+CurveRecordView CurveBankView::record(uint16_t i) const {
+	return CurveRecordView(_data + loadU32(_data + CURVE_BANK_HEADER_SIZE + 4 * i));
+}
+
+CurveRecordView CurveBankView::find(uint16_t channel_id) const {
+	uint16_t n = count();
+	for (uint16_t i = 0; i < n; i++) {
+		CurveRecordView rec = record(i);
+		if (rec.channelId() == channel_id) return rec;
+	}
+	return CurveRecordView();
+}
+
+size_t curveBankBegin(uint8_t* out, size_t out_size, uint16_t count) {
+	size_t size = CURVE_BANK_HEADER_SIZE + 4 * (size_t)count;
+	if (out_size < size) return 0;
+	memcpy(out, "ISCB", 4);
+	out[4] = CURVE_RECORD_VERSION;
+	out[5] = 0;
+	storeU16(out + 6, count);
+	memset(out + CURVE_BANK_HEADER_SIZE, 0, 4 * (size_t)count);
+	return size;
+}
+
+size_t curveBankAppend(uint8_t* out, size_t out_size, size_t offset, uint16_t i, CurveRecordView record) {
+	if (i >= loadU16(out + 6)) return 0; // past the offsets table
+	size_t size = record.size();
+	if (offset + size > out_size) return 0;
+	memcpy(out + offset, record._data, size);
+	storeU32(out + CURVE_BANK_HEADER_SIZE + 4 * i, (uint32_t)offset);
+	return offset + size;
+}
+
+#if !defined(ARDUINO)
+const uint8_t* curveFileMap(const char* path, size_t* size) {
+	int fd = open(path, O_RDONLY);
+	if (fd < 0) return nullptr;
+	struct stat st;
+	if (fstat(fd, &st) != 0 || st.st_size == 0) { close(fd); return nullptr; }
+	void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+	close(fd); // the mapping stays valid after close
+	if (data == MAP_FAILED) return nullptr;
+	*size = st.st_size;
+	return (const uint8_t*)data;
+}
+
+void curveFileUnmap(const uint8_t* data, size_t size) {
+	if (data) munmap((void*)data, size);
+}
+#endif
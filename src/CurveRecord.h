@@ -0,0 +1,165 @@
+#pragma once
+
+/**************************************************************************************************
+* @file  CurveRecord.h
+*
+* @brief compact, versioned binary format for fitted polynomial curves (e.g. calibration curves)
+* that can be evaluated in place, straight from EEPROM/flash images or a memory-mapped file.
+***************************************************************************************************/
+
+/*
+	All multi-byte fields are little-endian (as are AVR, ARM and x86) and read with memcpy, so
+	a record may start at any address. The views below never copy or parse: they only hold a pointer
+	into the image, so on the device the image must be in data-addressable memory (RAM or memory-
+	mapped flash; AVR PROGMEM needs copying to RAM first).
+
+	Curve record (CURVE_RECORD_HEADER_SIZE + n_coeffs * coeff bytes + 2):
+	  off  type     field
+	  0    uint8    version       CURVE_RECORD_VERSION
+	  1    uint8    format        CURVE_FLOAT32 or CURVE_INT16
+	  2    uint16   channel_id
+	  4    uint8    degree        n_coeffs = degree + 1
+	  5    uint8    reserved      0
+	  6    uint16   size          total bytes in the record, including the CRC
+	  8    float32  x_offset      \ the polynomial is in u = (x - x_offset) * x_scale,
+	  12   float32  x_scale       / which keeps high-degree fits well conditioned
+	  16   float32  coeff_scale   coefficient = stored value * coeff_scale (1 for CURVE_FLOAT32)
+	  20   coeffs   highest power first, float32 or int16 each
+	  ..   uint16   crc           CRC-16/CCITT-FALSE of every byte before it
+
+	Curve bank (a file or flash region holding many records):
+	  0    char[4]  magic         "ISCB"
+	  4    uint8    version       CURVE_RECORD_VERSION
+	  5    uint8    reserved      0
+	  6    uint16   count
+	  8    uint32[count] offsets  of each record from the start of the bank
+*/
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define CURVE_RECORD_VERSION 1
+#define CURVE_RECORD_HEADER_SIZE 20
+#define CURVE_BANK_HEADER_SIZE 8
+
+enum CurveRecordFormat {
+	CURVE_FLOAT32 = 0, ///< coefficients stored as float32 (4 bytes each)
+	CURVE_INT16 = 1    ///< coefficients quantized to int16 with a shared coeff_scale (2 bytes each)
+}; ///< enum for the coefficient storage format of a curve record
+
+/**
+ * @brief CRC-16/CCITT-FALSE (poly 0x1021, init 0xFFFF), as stored at the end of each curve record
+ */
+uint16_t curveRecordCRC16(const uint8_t* data, size_t size);
+
+/**
+ * @brief writes one curve record
+ *
+ * @param out where to write the record
+ * @param out_size bytes available at out
+ * @param channel_id caller-defined id (e.g. which PAR or ADC channel this curve calibrates)
+ * @param coeffs degree + 1 polynomial coefficients in u = (x - x_offset) * x_scale, highest power first
+ * @param degree degree of the polynomial (0...255)
+ * @param x_offset see coeffs
+ * @param x_scale see coeffs
+ * @param format CURVE_FLOAT32 or CURVE_INT16 (coefficients scaled so the largest is +-32767, so the
+ * small ones lose precision unless x is normalised, e.g. to -1...1, to keep them of similar magnitude)
+ * @return size_t bytes written, or 0 if out_size was too small
+ */
+size_t curveRecordWrite(uint8_t* out, size_t out_size, uint16_t channel_id, const double* coeffs, int degree,
+	float x_offset=0.0, float x_scale=1.0, CurveRecordFormat format=CURVE_FLOAT32);
+
+/**
+ * @return size_t bytes curveRecordWrite() needs for a curve of this degree and format
+ */
+size_t curveRecordSize(int degree, CurveRecordFormat format=CURVE_FLOAT32);
+
+/**
+ * Zero-copy view of one curve record: evaluates the polynomial directly from the stored bytes.
+ * Construction only stores the pointer; call valid() once (e.g. at boot or when loading a file)
+ * if the image might be corrupt or from a different version.
+ */
+class CurveRecordView {
+ public:
+	const uint8_t* _data;
+
+	CurveRecordView(const uint8_t* data=nullptr) : _data{data} {}
+
+	/**
+	 * @brief checks the version, format, size and CRC
+	 * @param max_size (default=0) if >0, the record must also fit in this many bytes
+	 */
+	bool valid(size_t max_size=0) const;
+
+	uint8_t version() const { return _data[0]; }
+	CurveRecordFormat format() const { return (CurveRecordFormat)_data[1]; }
+	uint16_t channelId() const;
+	int degree() const { return _data[4]; }
+	uint16_t size() const;
+	float xOffset() const;
+	float xScale() const;
+	float coeffScale() const;
+
+	/// @return double the i-th coefficient (highest power first) in u = (x - xOffset()) * xScale()
+	double coeff(int i) const;
+
+	/// @return float the curve at x, by Horner's method directly on the stored coefficients
+	float eval(float x) const;
+
+	/// @brief evaluates the curve at count points of x into y
+	void evalBlock(const float* x, float* y, int count) const;
+};
+
+/**
+ * Zero-copy view of a bank of curve records with O(1) access by index.
+ */
+class CurveBankView {
+ public:
+	const uint8_t* _data;
+
+	CurveBankView(const uint8_t* data=nullptr) : _data{data} {}
+
+	/**
+	 * @brief checks the bank header and, if check_records, every record's CRC
+	 * @param size bytes in the bank image
+	 */
+	bool valid(size_t size, bool check_records=true) const;
+
+	uint16_t count() const;
+
+	/// @return CurveRecordView of the i-th record
+	CurveRecordView record(uint16_t i) const;
+
+	/**
+	 * @brief finds the first record with a channel id (a linear scan of the record headers)
+	 * @return CurveRecordView whose _data is nullptr if there is no such channel
+	 */
+	CurveRecordView find(uint16_t channel_id) const;
+};
+
+/**
+ * @brief writes a bank header and offsets table for count records and returns where the first
+ * record goes. Write the records back to back after it with curveBankAppend().
+ *
+ * @return size_t bytes of header written (the offset of the first record), or 0 if out_size is too small
+ */
+size_t curveBankBegin(uint8_t* out, size_t out_size, uint16_t count);
+
+/**
+ * @brief copies a record into the bank at offset and fills in the bank's offsets table entry i
+ * @return size_t the offset of the next record, or 0 if out_size is too small or i is not below the
+ * bank's count
+ */
+size_t curveBankAppend(uint8_t* out, size_t out_size, size_t offset, uint16_t i, CurveRecordView record);
+
+#if !defined(ARDUINO)
+/**
+ * @brief (host only) memory-maps a file read-only so a CurveBankView/CurveRecordView can use it in place
+ * @param path the file
+ * @param size receives the file's size in bytes
+ * @return const uint8_t* the mapping, or nullptr on failure. Release with curveFileUnmap()
+ */
+const uint8_t* curveFileMap(const char* path, size_t* size);
+
+void curveFileUnmap(const uint8_t* data, size_t size);
+#endif
@@ -0,0 +1,45 @@
+#include "DiffAmpADC.h"
+
+double DiffAmpADC::readNormalized(uint8_t extra_bits) {
+	double n = extra_bits ? readNOversampled(extra_bits) : (n_prev = analogRead(_pin));
+	double unbiased = n - _n_zero_diff;
+
+	if      (unbiased > _n_tolerance)  norm_prev = unbiased/(_n_max_diff-_n_zero_diff);
+	else if (unbiased < -_n_tolerance) norm_prev = unbiased/(_n_min_diff-_n_zero_diff);
+	else norm_prev = 0.0;
+	return norm_prev;
+}
+
+unsigned long DiffAmpADC::readOversampled(uint8_t extra_bits) {
+	unsigned long samples = 1UL << (2 * extra_bits); // 4^extra_bits
+	unsigned long sum = 0;
+	for (unsigned long i = 0; i < samples; i++) sum += (n_prev = analogRead(_pin));
+	return sum >> extra_bits; // decimate: 4^k samples summed is 2k bits bigger, keep k of them
+}
+
+double DiffAmpADC::readNOversampled(uint8_t extra_bits) {
+	return (double)readOversampled(extra_bits) / (1UL << extra_bits);
+}
+
+double DiffAmpADC::calibN(float target_std_err, unsigned long min_samples, unsigned long max_samples, uint8_t extra_bits) {
+	_calib_stats.clear();
+	if (min_samples < 2) min_samples = 2; // standardError() is 0 until there are 2 samples
+
+	while (_calib_stats.count() < max_samples) {
+		_calib_stats.update(extra_bits ? readNOversampled(extra_bits) : (n_prev = analogRead(_pin)));
+		if (_calib_stats.count() >= min_samples && _calib_stats.standardError() <= target_std_err) break;
+	}
+	return _calib_stats.mean();
+}
+
+double DiffAmpADC::calibMaxDiffFromADC(float target_std_err, unsigned long min_samples, unsigned long max_samples, uint8_t extra_bits) {
+	return _n_max_diff = calibN(target_std_err, min_samples, max_samples, extra_bits);
+}
+
+double DiffAmpADC::calibZeroDiffFromADC(float target_std_err, unsigned long min_samples, unsigned long max_samples, uint8_t extra_bits) {
+	return _n_zero_diff = calibN(target_std_err, min_samples, max_samples, extra_bits);
+}
+
+double DiffAmpADC::calibMinDiffFromADC(float target_std_err, unsigned long min_samples, unsigned long max_samples, uint8_t extra_bits) {
+	return _n_min_diff = calibN(target_std_err, min_samples, max_samples, extra_bits);
+}
@@ -0,0 +1,150 @@
+#pragma once
+
+/**************************************************************************************************
+* @file  DiffAmpADC.h
+* 
+* @brief DiffAmpADC reads (and calibrates) an ADC fed by a biased differential amplifier.
+***************************************************************************************************/
+
+#include <Arduino.h>
+#include "welford_averages.h"
+
+
+// #if !defined(uint8_t)
+// typedef unsigned char uint8_t; 
+// #endif
+
+/*
+
+---------------------------------------------------------------------------------------------------
+n_adc <-> v_adc:
+"For single ended conversion, the result is
+         v_adc * 1024
+n_adc = ───────────
+         V_REF       "
+
+so the max voltage, indicated by 1023, is actually: 
+               n_adc            1023
+v_adc = V_REF⋅ ──────  = V_REF⋅ ──────
+               1024             1024
+which means we can't detect the V_REF voltage itself accurately but we do have an accurate 
+midpoint (relative to V_REF) as n_adc = 512, even though 512 is not the midpoint bw 0 and 1023. 
+
+See for yourself:
+               512
+v_adc = V_REF⋅ ─────
+               1024
+      = V_REF/2 # exactly! Example:
+      = 4.4/2   # ...we get 2.5 volts:
+      = 2.2     # exactly!
+
+BUT IN PRACTICE.... when the ADC gets v_adc = V_REF, analogRead() returns 1023 or 1022 and when it 
+gets ADC gets v_adc = V_REF/2, analogRead() returns 510 or 511; I haven't seen it spit out 512 but 
+maybe I need to calibrate 
+---------------------------------------------------------------------------------------------------
+v_diff (v_adc):
+	The ADC is fed the voltage called v_diff, which is 
+	V_REF (AREF) is set to 4.4V so that the midpoint is 2.2V, which indicates zero v_diff (now==goal)
+	With exact resistor values (12k and 5k6), perfect op-amps and perfect calib, v_diff ranges from:
+
+	0.289V  ...  2.2V  ...  4.111V
+	when:        when:      when:
+	goal=0V      goal==now  goal=4.095V
+	now=4.095V              now=0V 
+
+	if subtractor op-amp had a gain of 1, the range would be 2.2-4.095=-1.895 ...to...2.2+4.095=6.295,
+	which is a span of 2*4.095=8.19 but instead we have a span of 4.111-0.289=3.822 so the gain is
+	3.822/8.19=0.466666[6 is repeating]
+---------------------------------------------------------------------------------------------------
+n_adc -> v_diff
+	0.289V  ...  2.2V  ...  4.111V
+	is:          is:        is:
+	67.25[81rep] 512        956.741[81rep]
+	lets say:               lets say:
+	67                      957 (or 956?)
+	
+
+*/
+
+/**
+	* Reads an ADC fed the output from an op-amp in differential amplifier configuration with a bias, 
+	* performing the operation gain*(A + B) + zero_diff, where zero_diff is typically the ADC's 
+	* AREF/2 such that when there is zero difference between A and B, the ADC receives the zero_diff 
+	* voltage which is the 10-bit ADC's 512 value. See an example circuit in Falstad's Circuit Simulator: 
+	* https://tinyurl.com/2c7m9oxu
+	* 
+	* The _n_* calibration points are doubles (in ADC steps) so that the oversampled calibration 
+	* routines (calibZeroDiffFromADC() etc) can store the sub-step values they measure.
+	*/
+class DiffAmpADC {
+ public:
+	int _pin;
+	int _n_tolerance;
+	double _n_max_diff;
+	double _n_zero_diff;
+	double _n_min_diff;
+	int n_prev;
+	double norm_prev;
+
+	WelfordOnlineStats _calib_stats; ///< stats from the most recent calib*FromADC() call (count, mean, stddev...)
+
+	DiffAmpADC(int pin=A0, int n_tolerance=3, int n_zero_diff=512, int n_min_diff=67, int n_max_diff=957) 
+		: _pin{pin}, _n_tolerance{n_tolerance}, _n_max_diff{(double)n_max_diff}, _n_zero_diff{(double)n_zero_diff}, _n_min_diff{(double)n_min_diff} {}
+
+	/**
+	 * @brief reads the ADC and normalizes the reading to -1...1 (0 when within _n_tolerance of _n_zero_diff)
+	 * 
+	 * @param extra_bits (default=0) if >0, the reading is oversampled via readNOversampled(extra_bits)
+	 * @return double the normalized reading, also stored in norm_prev
+	 */
+	double readNormalized(uint8_t extra_bits=0);
+
+	int readN() { return n_prev = analogRead(_pin); }
+
+	/**
+	 * @brief oversample-and-decimate: sums 4^extra_bits (i.e. 2^(2*extra_bits)) readings and shifts 
+	 * the sum right by extra_bits. With enough noise (about 1 LSB) to dither the ADC, each extra bit 
+	 * costs 4x the readings. Keep extra_bits <= 10 so the sum fits in an unsigned long.
+	 * 
+	 * @param extra_bits number of bits of resolution to add to the ADC's 10 bits
+	 * @return unsigned long a (10 + extra_bits)-bit reading, i.e. in units of 1/2^extra_bits ADC steps
+	 */
+	unsigned long readOversampled(uint8_t extra_bits);
+
+	/**
+	 * @brief same as readOversampled() but scaled back to (fractional) ADC steps, so that it can be 
+	 * compared directly to readN() and the _n_* calibration points.
+	 * 
+	 * @param extra_bits number of bits of resolution to add to the ADC's 10 bits
+	 * @return double the oversampled reading in ADC steps (0...1023.x)
+	 */
+	double readNOversampled(uint8_t extra_bits);
+
+	int setMaxDiffFromADC()  { return _n_max_diff  = n_prev = analogRead(_pin); }
+
+	int setZeroDiffFromADC() { return _n_zero_diff = n_prev = analogRead(_pin); }
+
+	int setMinDiffFromADC()  { return _n_min_diff  = n_prev = analogRead(_pin); }
+
+	/**
+	 * @brief feeds (oversampled) readings into _calib_stats until the standard error of their mean 
+	 * drops to target_std_err ADC steps, so a quiet input finishes quickly and a noisy one takes as 
+	 * many readings as it needs (up to max_samples).
+	 * 
+	 * @param target_std_err the standard error of the mean (in ADC steps) at which to stop
+	 * @param min_samples (default=16) minimum readings taken before the standard error is trusted
+	 * @param max_samples (default=4096) give up after this many readings (check _calib_stats.standardError())
+	 * @param extra_bits (default=0) each reading is readNOversampled(extra_bits) if >0, else analogRead()
+	 * @return double the mean reading in (fractional) ADC steps
+	 */
+	double calibN(float target_std_err, unsigned long min_samples=16, unsigned long max_samples=4096, uint8_t extra_bits=0);
+
+	/// @brief calibN() the ADC with the max diff applied and store it as _n_max_diff. See calibN() for params.
+	double calibMaxDiffFromADC(float target_std_err=0.05, unsigned long min_samples=16, unsigned long max_samples=4096, uint8_t extra_bits=0);
+
+	/// @brief calibN() the ADC with zero diff applied and store it as _n_zero_diff. See calibN() for params.
+	double calibZeroDiffFromADC(float target_std_err=0.05, unsigned long min_samples=16, unsigned long max_samples=4096, uint8_t extra_bits=0);
+
+	/// @brief calibN() the ADC with the min diff applied and store it as _n_min_diff. See calibN() for params.
+	double calibMinDiffFromADC(float target_std_err=0.05, unsigned long min_samples=16, unsigned long max_samples=4096, uint8_t extra_bits=0);
+};
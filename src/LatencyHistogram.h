@@ -0,0 +1,195 @@
+#pragma once
+
+/**************************************************************************************************
+* @file  LatencyHistogram.h
+*
+* @brief LatencyHistogram is a fixed-size, log-linear (HDR histogram style) histogram of durations
+* with O(1) recording, percentile queries and merging, small enough to live on the device.
+***************************************************************************************************/
+
+/*
+	Values 0...2^MAX_BITS-1 are counted in buckets whose width grows with the value so that every
+	value is known to SIG_DIGITS significant decimal digits: below 2 * 10^SIG_DIGITS (rounded up to a
+	power of two, SUB_COUNT) each value has its own count; above that each doubling of the value
+	range is split into SUB_COUNT / 2 equal buckets. Finding a value's count is a count-leading-zeros,
+	a shift and an add, and the counts are one flat array, so record() costs the same for any value.
+	Larger values are counted as the highest trackable value (see clamped()).
+
+	Each bucket's count saturates at Count's maximum rather than wrapping: with the default uint16_t
+	that is 65535 values in one bucket, reached in about a minute of 1kHz readings that all fall in
+	one bucket. Percentiles and mean() are then taken over the saturated counts (no longer the true
+	distribution) and saturated() is true; use uint32_t counts for histograms that are never
+	cleared. Memory is about (MAX_BITS - SUB_BITS + 2) * SUB_COUNT / 2 * sizeof(Count) bytes, e.g.:
+
+		SIG_DIGITS  MAX_BITS  range at 1us   Count     bytes
+		1           32        71 minutes     uint16_t  928
+		2           20        1 second       uint16_t  3584  (the defaults)
+		2           24        16 seconds     uint32_t  9216
+		3           20        1 second       uint32_t  45056
+
+	A histogram is not thread-safe: give each thread (or device) its own and merge() them, or copy
+	the whole object (it holds no pointers) between devices built with the same parameters.
+	attach() makes every reading of a TimeElapsed a record() (see TimeElapsed::setOnElapsed()).
+*/
+
+#include <stdint.h>
+#include "TimeElapsed.h"
+#include "checked_int.h"
+
+/// @brief log2 of the smallest power of two >= 2 * 10^digits: the bits of exact (unit-wide) counts
+constexpr int latencyHistogramSubBits(int digits, int bits=0) {
+	return ((uint32_t)1 << bits) >= 2 * (digits == 1 ? 10u : digits == 2 ? 100u : 1000u) ? bits : latencyHistogramSubBits(digits, bits + 1);
+}
+
+/// @brief leading zeros of a non-zero 32-bit value
+inline int latencyHistogramClz32(uint32_t v) {
+#if defined(__GNUC__)
+	if (sizeof(unsigned) >= 4) return __builtin_clz(v) - (int)(sizeof(unsigned) * 8 - 32);
+	return __builtin_clzl(v) - (int)(sizeof(unsigned long) * 8 - 32);
+#else
+	int n = 0;
+	for (uint32_t bit = 0x80000000u; !(v & bit); bit >>= 1) n++;
+	return n;
+#endif
+}
+
+/**
+ * @tparam SIG_DIGITS (default=2) 1...3 significant decimal digits kept for every value
+ * @tparam MAX_BITS (default=20) values up to 2^MAX_BITS-1 are tracked (<= 32)
+ * @tparam Count (default=uint16_t) unsigned type of each bucket's count
+ */
+template <int SIG_DIGITS=2, int MAX_BITS=20, typename Count=uint16_t>
+class LatencyHistogram {
+ public:
+	static_assert(SIG_DIGITS >= 1 && SIG_DIGITS <= 3, "SIG_DIGITS must be 1...3");
+	static constexpr int SUB_BITS = latencyHistogramSubBits(SIG_DIGITS);
+	static_assert(MAX_BITS > SUB_BITS && MAX_BITS <= 32, "MAX_BITS must be more than SUB_BITS and at most 32");
+	static constexpr int HALF_BITS = SUB_BITS - 1;
+	static constexpr uint32_t SUB_COUNT = (uint32_t)1 << SUB_BITS;   ///< values below this have their own count
+	static constexpr uint32_t HALF_COUNT = SUB_COUNT / 2;            ///< buckets per doubling above SUB_COUNT
+	static constexpr int COUNTS_LEN = (MAX_BITS - SUB_BITS + 2) * (int)HALF_COUNT;
+	static constexpr uint32_t HIGHEST = (uint32_t)(((uint64_t)1 << MAX_BITS) - 1); ///< largest trackable value
+
+	Count _counts[COUNTS_LEN];
+	uint64_t _total;     // values recorded (including clamped ones)
+	uint32_t _min;
+	uint32_t _max;
+	uint32_t _clamped;   // values above HIGHEST, counted as HIGHEST
+	bool _saturated;     // a count reached Count's maximum and stopped counting
+
+	LatencyHistogram() { clear(); }
+
+	/// @brief zeroes every count
+	void clear() {
+		for (int i = 0; i < COUNTS_LEN; i++) _counts[i] = 0;
+		_total = 0;
+		_min = HIGHEST;
+		_max = 0;
+		_clamped = 0;
+		_saturated = false;
+	}
+
+	/// @brief counts one value (values above HIGHEST are counted as HIGHEST)
+	void record(TimeElapsed64_t value) {
+		uint32_t v = (uint32_t)value;
+		if (value > HIGHEST) {
+			v = HIGHEST;
+			_clamped++;
+		}
+		Count& c = _counts[indexOf(v)];
+		if (is::addOverflow<Count>(c, 1, &c)) {
+			c = is::IntLimits<Count>::max();
+			_saturated = true;
+		}
+		_total++;
+		if (v < _min) _min = v;
+		if (v > _max) _max = v;
+	}
+
+	/// @brief adds other's counts to these (e.g. another thread's or device's)
+	void merge(const LatencyHistogram& other) {
+		for (int i = 0; i < COUNTS_LEN; i++) {
+			if (is::addOverflow<Count>(_counts[i], other._counts[i], &_counts[i])) {
+				_counts[i] = is::IntLimits<Count>::max();
+				_saturated = true;
+			}
+		}
+		_saturated |= other._saturated;
+		_total += other._total;
+		_clamped += other._clamped;
+		if (other._min < _min) _min = other._min;
+		if (other._max > _max) _max = other._max;
+	}
+
+	/**
+	 * @brief the value that percentile percent of the recorded values are at or below, to
+	 * SIG_DIGITS digits (the top of its bucket, but never outside minValue()...maxValue()). Taken
+	 * over the bucket counts, so after saturated() it is the percentile of the saturated counts.
+	 * @param percentile 0...100, e.g. 99.9
+	 * @return uint32_t the value, or 0 if nothing was recorded
+	 */
+	uint32_t valueAtPercentile(double percentile) const {
+		if (!_total) return 0;
+		if (percentile < 0) percentile = 0;
+		if (percentile > 100) percentile = 100;
+		uint64_t counted = 0; // not _total, which keeps counting after a bucket saturates
+		for (int i = 0; i < COUNTS_LEN; i++) counted += _counts[i];
+		uint64_t wanted = (uint64_t)(percentile / 100 * counted + 0.5);
+		if (wanted < 1) wanted = 1;
+		uint64_t seen = 0;
+		int i = 0;
+		for (; i < COUNTS_LEN - 1; i++) {
+			seen += _counts[i];
+			if (seen >= wanted) break;
+		}
+		uint32_t v = highestValueAt(i);
+		return v < _min ? _min : (v > _max ? _max : v);
+	}
+
+	/// @return double the mean of the recorded values (each taken as the middle of its bucket)
+	double mean() const {
+		if (!_total) return 0;
+		double sum = 0;
+		uint64_t n = 0;
+		for (int i = 0; i < COUNTS_LEN; i++) {
+			if (!_counts[i]) continue;
+			sum += (double)_counts[i] * (lowestValueAt(i) + (highestValueAt(i) - lowestValueAt(i)) * 0.5);
+			n += _counts[i];
+		}
+		return sum / n;
+	}
+
+	uint64_t count() const { return _total; }
+	uint32_t minValue() const { return _total ? _min : 0; }  ///< (named to dodge Arduino's min/max macros)
+	uint32_t maxValue() const { return _max; }
+	uint32_t clamped() const { return _clamped; }  ///< values recorded above HIGHEST
+	bool saturated() const { return _saturated; }  ///< a bucket's count stopped at Count's maximum (see above)
+
+	/// @brief makes every reading of te's elapsed() a record() here (see TimeElapsed::setOnElapsed())
+	void attach(TimeElapsed& te) { te.setOnElapsed(recordElapsed, this); }
+
+	/// @brief a TimeElapsed::setOnElapsed() function whose ctx is a LatencyHistogram*
+	static void recordElapsed(TimeElapsed_t elapsed, void* histogram) { ((LatencyHistogram*)histogram)->record(elapsed); }
+
+	//**** bucket layout **************************************************
+
+	/// @brief the index in _counts of value v (<= HIGHEST)
+	static int indexOf(uint32_t v) {
+		int bucket = (31 - HALF_BITS) - latencyHistogramClz32(v | (SUB_COUNT - 1)); // doublings above SUB_COUNT
+		return ((bucket + 1) << HALF_BITS) + (int)(v >> bucket) - (int)HALF_COUNT;
+	}
+
+	/// @brief the lowest value counted at index
+	static uint32_t lowestValueAt(int index) {
+		int bucket = (index >> HALF_BITS) - 1;
+		uint32_t sub = (index & (HALF_COUNT - 1)) + HALF_COUNT;
+		if (bucket < 0) return sub - HALF_COUNT;
+		return sub << bucket;
+	}
+
+	/// @brief the highest value counted at index
+	static uint32_t highestValueAt(int index) {
+		int bucket = (index >> HALF_BITS) - 1;
+		return lowestValueAt(index) + (bucket > 0 ? ((uint32_t)1 << bucket) - 1 : 0);
+	}
+};
@@ -0,0 +1,264 @@
+#pragma once
+
+/**************************************************************************************************
+* @file  ParRateCurveModel.h
+*
+* @brief ParRateCurveModel models a PAR's control voltage -> rate curve as a fitted polynomial and
+* bakes it into a lookup table so that runtime conversion is one table lookup plus interpolation.
+***************************************************************************************************/
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "polynomial.h"
+#include "CurveRecord.h"
+
+/**
+ * rate(v) = multiplier * polyval(coeffs_stored, v), where coeffs_stored are highest power first
+ * (as returned by is::polyfit). Set the coefficients either by passing them to the constructor or
+ * by fit()-ing them to measured data, then call buildLookup() to fill v_rate_lookup, after which
+ * rate() costs one table lookup and a linear interpolation, with lookupMaxError() reporting how far
+ * that is from the exact polynomial (rateExact()). For the inverse (the voltage that gives a rate),
+ * call buildInverse() once, after which voltage() costs a lookup and two Newton steps.
+ *
+ * @tparam T the numeric type of the coefficients and the lookup table (normally float or double)
+ */
+template <typename T>
+class ParRateCurveModel {
+ public:
+	T multiplier;
+	T * coeffs_stored = nullptr;
+	int coeffs_stored_size = 0;
+	T * v_rate_lookup = nullptr;
+	int v_rate_lookup_size = 0;
+	T v_lookup_min = 0;
+	T v_lookup_max = 0;
+	T v_lookup_step_inv = 0; // (v_rate_lookup_size - 1) / (v_lookup_max - v_lookup_min)
+	is::PolyInverse<T> v_inverse; // rate / multiplier -> v
+
+	ParRateCurveModel(T multiplier=1) : multiplier{multiplier} {}
+
+	ParRateCurveModel(T multiplier, T * coeffs_stored, int coeffs_stored_size) : multiplier{multiplier} {
+
+		///NOTE: Eventually we may incorporate the circuit sampling tasks into this. EEPROM data handling is
+		///      done by writeRecord() and loadRecord() (see CurveRecord.h)
+
+		setCoeffs(coeffs_stored, coeffs_stored_size);
+	}
+
+	~ParRateCurveModel() {
+		delete[] coeffs_stored;
+		delete[] v_rate_lookup;
+	}
+
+	ParRateCurveModel(const ParRateCurveModel&) = delete;
+	ParRateCurveModel& operator=(const ParRateCurveModel&) = delete;
+
+	/**
+	 * @brief copies the polynomial coefficients (highest power first). The lookup table is not
+	 * rebuilt: call buildLookup() again.
+	 */
+	void setCoeffs(const T * coeffs, int size) {
+		if (size != coeffs_stored_size) {
+			delete[] coeffs_stored;
+			coeffs_stored = new T[size];
+			coeffs_stored_size = size;
+		}
+		memcpy(coeffs_stored, coeffs, size * sizeof(T));
+	}
+
+	/**
+	 * @brief fits the polynomial to measured (voltage, rate) points with is::polyfit. The lookup
+	 * table is not rebuilt: call buildLookup() again.
+	 *
+	 * @param v the array of control voltages
+	 * @param rate the array of rates measured at v (divided by multiplier before fitting)
+	 * @param size the number of points
+	 * @param deg the degree of the fitting polynomial
+	 * @param status (default=nullptr) if not nullptr, receives is::polyfit's SolveStatus
+	 * @return bool false (and nothing is changed) if there are not more points than coefficients,
+	 * memory ran out, or the fit was rank deficient (e.g. too few distinct voltages for deg)
+	 */
+	bool fit(double * v, double * rate, int size, int deg, is::SolveStatus * status=nullptr) {
+		if (size <= deg) return false;
+		double * y = (double*)malloc(size * sizeof(double));
+		double * coeffs = (double*)malloc((deg + 1) * sizeof(double));
+		if (!y || !coeffs) {
+			free(coeffs);
+			free(y);
+			return false;
+		}
+		for (int i = 0; i < size; i++) y[i] = rate[i] / multiplier;
+
+		is::SolveStatus solved = is::polyfit(v, y, size, deg, coeffs);
+		if (status) *status = solved;
+		if (solved != is::SOLVE_OK && solved != is::SOLVE_ILL_CONDITIONED) {
+			free(coeffs);
+			free(y);
+			return false;
+		}
+
+		T * coeffs_t = new T[deg + 1];
+		for (int i = 0; i <= deg; i++) coeffs_t[i] = (T)coeffs[i];
+		setCoeffs(coeffs_t, deg + 1);
+
+		delete[] coeffs_t;
+		free(coeffs);
+		free(y);
+		return true;
+	}
+
+	/**
+	 * @brief re-expresses the curve for a new control voltage scale without refitting, e.g. after the
+	 * CV path's gain or offset is recalibrated: if v_new = gain * v + offset, rateExact(v_new) afterwards
+	 * equals rateExact(v) before. The lookup table and inverse are not rebuilt: call buildLookup() and
+	 * buildInverse() again.
+	 *
+	 * @return bool false if gain is 0 or there are no coefficients (nothing is changed)
+	 */
+	bool rescaleVoltage(T gain, T offset) {
+		if (gain == 0 || coeffs_stored_size < 1) return false;
+		is::polyAffine(coeffs_stored, coeffs_stored_size - 1, 1 / gain, -offset / gain, coeffs_stored);
+		return true;
+	}
+
+	/**
+	 * @brief serializes the curve (multiplier folded into the coefficients) as a CurveRecord. Once
+	 * buildLookup() has been called the record's x is the lookup range normalised to -1...1
+	 * (x_offset = its centre, x_scale = 2 / its width), so the coefficients have similar magnitudes and
+	 * CURVE_INT16's one shared coeff_scale quantizes them all well; before that x is v itself, which
+	 * only suits CURVE_FLOAT32 (or a v already spanning about -1...1).
+	 * @return size_t bytes written, or 0 if out_size was too small, there are no coefficients or
+	 * memory ran out
+	 */
+	size_t writeRecord(uint8_t * out, size_t out_size, uint16_t channel_id, CurveRecordFormat format=CURVE_FLOAT32) const {
+		if (coeffs_stored_size < 1) return 0;
+		double * coeffs = (double*)malloc(coeffs_stored_size * sizeof(double));
+		if (!coeffs) return 0;
+		for (int i = 0; i < coeffs_stored_size; i++) coeffs[i] = (double)multiplier * coeffs_stored[i];
+		float x_offset = 0, x_scale = 1;
+		if (v_lookup_max > v_lookup_min) {
+			x_offset = (float)(((double)v_lookup_min + v_lookup_max) / 2);
+			x_scale = (float)(2 / ((double)v_lookup_max - v_lookup_min));
+			is::polyAffine(coeffs, coeffs_stored_size - 1, 1 / (double)x_scale, (double)x_offset, coeffs); // p(v) = p(u / x_scale + x_offset)
+		}
+		size_t size = curveRecordWrite(out, out_size, channel_id, coeffs, coeffs_stored_size - 1, x_offset, x_scale, format);
+		free(coeffs);
+		return size;
+	}
+
+	/**
+	 * @brief loads coefficients from a CurveRecord (e.g. from writeRecord()), converted back from the
+	 * record's x to v, and sets multiplier to 1. The lookup table is not rebuilt: call buildLookup()
+	 * again. (To evaluate a record without loading it, use CurveRecordView::eval() directly.)
+	 * @return bool false if the record is invalid, its x_scale is 0 or memory ran out
+	 */
+	bool loadRecord(const CurveRecordView& rec) {
+		if (!rec.valid() || rec.xScale() == 0) return false;
+		int size = rec.degree() + 1;
+		double * coeffs = (double*)malloc(size * sizeof(double));
+		T * coeffs_t = new T[size];
+		if (!coeffs || !coeffs_t) {
+			delete[] coeffs_t;
+			free(coeffs);
+			return false;
+		}
+		for (int i = 0; i < size; i++) coeffs[i] = rec.coeff(i);
+		// u = (v - x_offset) * x_scale = x_scale * v - x_offset * x_scale
+		is::polyAffine(coeffs, size - 1, (double)rec.xScale(), -(double)rec.xOffset() * rec.xScale(), coeffs);
+		for (int i = 0; i < size; i++) coeffs_t[i] = (T)coeffs[i];
+		setCoeffs(coeffs_t, size);
+		multiplier = 1;
+		delete[] coeffs_t;
+		free(coeffs);
+		return true;
+	}
+
+	/// @brief the exact rate at v from the polynomial (Horner's method, deg multiply-adds)
+	T rateExact(T v) const {
+		return multiplier * is::polyval(coeffs_stored, coeffs_stored_size - 1, v);
+	}
+
+	/**
+	 * @brief bakes rateExact() into v_rate_lookup at size evenly spaced voltages from v_min to v_max
+	 * (both inclusive). More entries means less interpolation error (see lookupMaxError()).
+	 *
+	 * @return bool false if size < 2, v_max <= v_min or there are no coefficients (nothing is changed)
+	 */
+	bool buildLookup(T v_min, T v_max, int size) {
+		if (size < 2 || !(v_max > v_min) || coeffs_stored_size < 1) return false;
+		if (size != v_rate_lookup_size) {
+			delete[] v_rate_lookup;
+			v_rate_lookup = new T[size];
+			v_rate_lookup_size = size;
+		}
+		v_lookup_min = v_min;
+		v_lookup_max = v_max;
+		v_lookup_step_inv = (size - 1) / (v_max - v_min);
+		T step = (v_max - v_min) / (size - 1);
+		for (int i = 0; i < size; i++) v_rate_lookup[i] = rateExact(v_min + i * step);
+		return true;
+	}
+
+	/**
+	 * @brief the rate at v by table lookup plus linear interpolation. v outside the table's range
+	 * is clamped to v_lookup_min or v_lookup_max. buildLookup() must have been called.
+	 */
+	T rate(T v) const {
+		T pos = (v - v_lookup_min) * v_lookup_step_inv;
+		if (!(pos > 0)) return v_rate_lookup[0];
+		if (pos >= v_rate_lookup_size - 1) return v_rate_lookup[v_rate_lookup_size - 1]; // before the cast, which could overflow int
+		int i = (int)pos;
+		T frac = pos - i;
+		return v_rate_lookup[i] + frac * (v_rate_lookup[i + 1] - v_rate_lookup[i]);
+	}
+
+	/**
+	 * @brief prepares voltage(): tabulates the inverse of the polynomial over v_min...v_max (see
+	 * is::PolyInverse). Call it again after fit(), setCoeffs() or loadRecord().
+	 *
+	 * @param size (default=64) inverse table entries
+	 * @param newton_steps (default=2) Newton refinement steps per voltage()
+	 * @param at_v (default=nullptr) if not null and the curve isn't monotonic, receives where it turns
+	 * @return is::PolyInverseStatus INVERSE_NOT_MONOTONIC if the curve turns within v_min...v_max, in
+	 * which case voltage() only covers the longest monotonic part (v_inverse.xMin()...xMax())
+	 */
+	is::PolyInverseStatus buildInverse(T v_min, T v_max, int size=64, int newton_steps=2, T * at_v=nullptr) {
+		if (coeffs_stored_size < 2) return is::INVERSE_INVALID;
+		return v_inverse.build(coeffs_stored, coeffs_stored_size - 1, v_min, v_max, size, newton_steps, at_v);
+	}
+
+	/// @brief the control voltage that gives rate (clamped to the inverse's domain). buildInverse() must have succeeded.
+	T voltage(T rate) const {
+		return v_inverse.solve(rate / multiplier);
+	}
+
+	/**
+	 * @brief compares rate() to rateExact() at checks_per_segment points inside every table segment
+	 *
+	 * @param checks_per_segment (default=8) number of points checked between each pair of entries
+	 * @param at_v (default=nullptr) if not null, receives the voltage where the largest error occurred
+	 * @param rms (default=nullptr) if not null, receives the root-mean-square error over all checked points
+	 * @return T the largest absolute error found (0 if there is no table)
+	 */
+	T lookupMaxError(int checks_per_segment=8, T * at_v=nullptr, T * rms=nullptr) const {
+		T max_err = 0, max_v = v_lookup_min;
+		double sum_sq = 0;
+		long n = 0;
+		if (v_rate_lookup_size >= 2 && checks_per_segment > 0) {
+			T step = (v_lookup_max - v_lookup_min) / (v_rate_lookup_size - 1);
+			for (int i = 0; i < v_rate_lookup_size - 1; i++) {
+				for (int j = 1; j <= checks_per_segment; j++) {
+					T v = v_lookup_min + (i + (T)j / (checks_per_segment + 1)) * step;
+					T err = (T)fabs(rate(v) - rateExact(v));
+					sum_sq += (double)err * err;
+					n++;
+					if (err > max_err) { max_err = err; max_v = v; }
+				}
+			}
+		}
+		if (at_v) *at_v = max_v;
+		if (rms) *rms = n ? (T)sqrt(sum_sq / n) : 0;
+		return max_err;
+	}
+};
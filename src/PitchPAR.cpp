@@ -0,0 +1,55 @@
+#include "PitchPAR.h"
+
+#include <math.h>
+
+PitchPAR::PitchPAR(int div_per_semi_32_lte_56) {
+	calibCVScaling(div_per_semi_32_lte_56);
+}
+
+double PitchPAR::calibCVScaling(int div_per_semi_32_lte_56) {
+	int div = div_per_semi_32_lte_56;
+	_div_per_semi = div < 32 ? 32 : (div > 56 ? 56 : div); // clip max and min to what's possible on HW
+
+	_voltage_span = voltageSpanFromDivPerSemi(_div_per_semi);
+	_note_span = noteSpanFromVoltageSpan(_voltage_span);
+
+	setMinNote(); // NOTE: if user already set base midi in note, it will be reset to default here!
+	return _note_span + 1;
+}
+
+void PitchPAR::setMinNote(int min_note) {
+	double missing_notes = 127 - _note_span;
+	if (missing_notes < 0) missing_notes = 0; // because a full MIDI span would make missing_notes be -0.96875
+
+	if (min_note < 0) _note_min = (((int)(missing_notes / 12) + 1) / 2) * 12; // ceil(int(missing/12)/2)*12
+	else _note_min = min_note > 127 ? 127 : min_note;
+
+	_note_max = _note_span + _note_min;
+	buildTable();
+}
+
+double PitchPAR::midiPitchEnforceBounds(double midi_pitch) const {
+	// This will not fail any midi_pitch: instead it will return same note in the nearest octave
+	if (midi_pitch < _note_min) {
+		midi_pitch += 12 * ceil((_note_min - midi_pitch) / 12);
+		if (midi_pitch > _note_max) midi_pitch = _note_max; // span is under an octave
+	}
+	else if (midi_pitch > _note_max) {
+		midi_pitch -= 12 * ceil((midi_pitch - _note_max) / 12);
+		if (midi_pitch < _note_min) midi_pitch = _note_min; // span is under an octave
+	}
+	return midi_pitch;
+}
+
+uint16_t PitchPAR::midiToDACExact(double midi_pitch) const {
+	double code = (midiPitchEnforceBounds(midi_pitch) - _note_min) * _div_per_semi;
+	if (code < 0) return 0;
+	if (code > PITCHPAR_DAC_MAX) return PITCHPAR_DAC_MAX;
+	return (uint16_t)(code + 0.5);
+}
+
+void PitchPAR::buildTable() {
+	for (int i = 0; i < PITCHPAR_TABLE_SIZE; i++) {
+		_dac_table[i] = midiToDACExact((double)i / (1 << PITCHPAR_FRAC_BITS));
+	}
+}
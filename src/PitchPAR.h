@@ -0,0 +1,97 @@
+#pragma once
+
+/**************************************************************************************************
+* @file  PitchPAR.h
+*
+* @brief PitchPAR converts MIDI notes to 12-bit DAC codes for a pitch CV output, with the note
+* range, octave folding and scaling all baked into a table at calibration time.
+***************************************************************************************************/
+
+// Ported from PitchPAR in working/from_mock_code.py. The DAC is 12-bit (0...4095) with a 4.095V
+// reference so one code is 1mV before the output gain, and a semitone is div_per_semi codes.
+
+#include <stdint.h>
+
+#ifndef PITCHPAR_FRAC_BITS
+#define PITCHPAR_FRAC_BITS 0 ///< the table holds 2^PITCHPAR_FRAC_BITS entries per semitone (0: whole notes only)
+#endif
+
+#define PITCHPAR_DAC_MAX 4095
+#define PITCHPAR_TABLE_SIZE (128 << PITCHPAR_FRAC_BITS)
+
+/// @brief voltage span is number of notes available - 1 (4095 * semitone/div_per_semi, not 4096)
+inline double voltageSpanFromDivPerSemi(double div_per_semi) { return 1365 / (4 * div_per_semi); }
+
+/// @brief == voltage_span/semitone == voltage_span/(1/12)
+inline double noteSpanFromVoltageSpan(double voltage_span) { return 12 * voltage_span; }
+
+inline double gainFromVoltageSpan(double voltage_span) { return voltage_span / 4.095; }
+
+/// @brief (x/12)/4.095 simplifies to (x * 50)/2457
+inline double gainFromNoteSpan(double note_span) { return (note_span * 50) / 2457; }
+
+class PitchPAR {
+ public:
+	int _div_per_semi;     // DAC codes per semitone
+	double _voltage_span;  // output voltage span above the minimum note's voltage
+	double _note_span;     // notes available - 1 (may be fractional)
+	int _note_min;         // lowest note, at DAC code 0
+	double _note_max;      // highest note, at DAC code 4095 (_note_min + _note_span)
+
+	/**
+	 * @brief the DAC code for every MIDI pitch (index is note << PITCHPAR_FRAC_BITS | fraction),
+	 * with notes outside _note_min..._note_max already folded by octaves into range
+	 */
+	uint16_t _dac_table[PITCHPAR_TABLE_SIZE];
+
+	PitchPAR(int div_per_semi_32_lte_56=42);
+
+	/**
+	 * @brief sets the resolution in DAC codes per semitone, which sets the voltage and note span,
+	 * resets the minimum note to its default (see setMinNote()) and rebuilds the table.
+	 *
+	 * Preferred settings: [50, 42, 39, 35, 32]
+	 *   semitone/50, 6.825+min V, 82.9  notes: 24 to 105.9, gain=1.666...
+	 *   semitone/42, 8.125+min V, 98.5  notes: 12 to 109.5, gain=1.984126...
+	 *   semitone/39, 8.75+min V,  106.0 notes: 12 to 117,   gain=2.1367521...
+	 *   semitone/35, 9.75+min V,  118.0 notes: 0 to 117,    gain=2.380952...
+	 *   semitone/32, 10.6640625+min V, 128.96875 notes: 0 to 127.96875, gain=2.6041666...
+	 *
+	 * @param div_per_semi_32_lte_56 divisions per semitone, clipped to 32...56 (what's possible on HW)
+	 * @return double the number of notes available (_note_span + 1)
+	 */
+	double calibCVScaling(int div_per_semi_32_lte_56=42);
+
+	/**
+	 * @brief sets the lowest note (at DAC code 0) and rebuilds the table.
+	 * NOTE: we won't prevent minimums so high that they make otherwise reachable high notes
+	 * unreachable. No judgements here, but be careful what you wish for.
+	 *
+	 * @param min_note (default=-1) clipped to 0...127, or if <0, the default: the C that centers the
+	 * available range within MIDI's 0...127 as well as whole octaves allow
+	 */
+	void setMinNote(int min_note=-1);
+
+	/**
+	 * @brief folds a pitch into _note_min..._note_max by whole octaves (same note, nearest octave
+	 * in range). This is what the table is built from; at runtime use dacCode() instead.
+	 */
+	double midiPitchEnforceBounds(double midi_pitch) const;
+
+	/**
+	 * @brief computes (without the table) the DAC code for a pitch after midiPitchEnforceBounds()
+	 */
+	uint16_t midiToDACExact(double midi_pitch) const;
+
+	/// @brief the DAC code for a MIDI note: one table lookup
+	uint16_t dacCode(uint8_t note) const { return _dac_table[(note & 127) << PITCHPAR_FRAC_BITS]; }
+
+	/**
+	 * @brief the DAC code for a fractional pitch: one table lookup
+	 * @param pitch_fixed (note << PITCHPAR_FRAC_BITS) | fraction, i.e. fixed point with PITCHPAR_FRAC_BITS fraction bits
+	 */
+	uint16_t dacCodeFixed(uint16_t pitch_fixed) const { return _dac_table[pitch_fixed & (PITCHPAR_TABLE_SIZE - 1)]; }
+
+	/// @brief rebuilds _dac_table (calibCVScaling() and setMinNote() call this)
+	void buildTable();
+};
@@ -0,0 +1,72 @@
+#include "RCGlide.h"
+
+#include <math.h>
+
+#define RCGLIDE_DENORMAL_FLOOR 1e-20f // _delta below this is flushed to 0 (settled) to avoid slow denormals
+
+RCGlide::RCGlide(int n_voices, float sample_period) : _sample_period{sample_period} {
+	_n_voices = n_voices < 1 ? 1 : (n_voices > RCGLIDE_MAX_VOICES ? RCGLIDE_MAX_VOICES : n_voices);
+	for (int v = 0; v < RCGLIDE_MAX_VOICES; v++) {
+		_v_goal[v] = _delta[v] = _k[v] = _tau[v] = 0;
+	}
+}
+
+void RCGlide::setTau(int voice, float tau) {
+	_tau[voice] = tau;
+	if (tau <= 0) _k[voice] = 0;
+	else _k[voice] = 1 - pcnt01OfnTau(_sample_period / tau); // == exp(-sample_period/tau)
+}
+
+void RCGlide::glideTo(int voice, float v_goal) {
+	_delta[voice] = now(voice) - v_goal;
+	_v_goal[voice] = v_goal;
+}
+
+void RCGlide::start(int voice, float v_start, float v_goal, float tau) {
+	setTau(voice, tau);
+	_v_goal[voice] = v_goal;
+	_delta[voice] = v_start - v_goal;
+}
+
+void RCGlide::jumpTo(int voice, float v) {
+	_v_goal[voice] = v;
+	_delta[voice] = 0;
+}
+
+float RCGlide::next(int voice) {
+	_delta[voice] *= _k[voice];
+	if (fabs(_delta[voice]) < RCGLIDE_DENORMAL_FLOOR) _delta[voice] = 0;
+	return now(voice);
+}
+
+void RCGlide::processBlock(float* out, int n_samples) {
+	int n = _n_voices;
+	for (int s = 0; s < n_samples; s++) {
+		float* frame = out + s * n;
+		for (int v = 0; v < n; v++) {
+			_delta[v] *= _k[v];
+			frame[v] = _v_goal[v] + _delta[v];
+		}
+	}
+	// flush once per block rather than once per sample
+	for (int v = 0; v < n; v++) if (fabs(_delta[v]) < RCGLIDE_DENORMAL_FLOOR) _delta[v] = 0;
+}
+
+float RCGlide::secondsToTolerance(int voice, float tolerance) const {
+	float remaining = fabs(_delta[voice]);
+	if (remaining <= tolerance) return 0;
+	if (_tau[voice] <= 0) return 0; // jumps on the next sample
+	// the glide started here is pcnt01 done once only tolerance is left:
+	return nTauOfPcnt01(1 - tolerance / remaining) * _tau[voice];
+}
+
+unsigned long RCGlide::samplesToTolerance(int voice, float tolerance) const {
+	float remaining = fabs(_delta[voice]);
+	if (remaining <= tolerance) return 0;
+	if (_tau[voice] <= 0) return 1;
+	return (unsigned long)ceil(secondsToTolerance(voice, tolerance) / _sample_period);
+}
+
+bool RCGlide::settled(int voice, float tolerance) const {
+	return fabs(_delta[voice]) <= tolerance;
+}
@@ -0,0 +1,72 @@
+#pragma once
+
+/**************************************************************************************************
+* @file  RCGlide.h
+*
+* @brief RCGlide generates glide/portamento trajectories for many voices that follow an RC slew
+* (see rc.h), one multiply-add per voice per sample.
+***************************************************************************************************/
+
+// An RC circuit's distance from its goal shrinks by the same factor every sample:
+//   v[n+1] - v_goal = (v[n] - v_goal) * k,  where k = exp(-sample_period/tau) = 1 - pcnt01OfnTau(sample_period/tau)
+// so k is computed once per setTau() and no exp() is needed per sample.
+
+#include "rc.h"
+
+#ifndef RCGLIDE_MAX_VOICES
+#define RCGLIDE_MAX_VOICES 8 ///< number of voices an RCGlide can drive
+#endif
+
+class RCGlide {
+ public:
+	int _n_voices;
+	float _sample_period; // seconds between samples
+
+	// per voice (structure of arrays so processBlock() runs across voices in one pass):
+	float _v_goal[RCGLIDE_MAX_VOICES];
+	float _delta[RCGLIDE_MAX_VOICES]; // v_now - v_goal
+	float _k[RCGLIDE_MAX_VOICES];     // per-sample decay factor of _delta
+	float _tau[RCGLIDE_MAX_VOICES];   // seconds (= R * C)
+
+	/**
+	 * @param n_voices number of voices (clipped to 1...RCGLIDE_MAX_VOICES), all starting settled at 0 with tau=0
+	 * @param sample_period seconds between output samples (e.g. 1.0/sample_rate)
+	 */
+	RCGlide(int n_voices, float sample_period);
+
+	/// @brief sets a voice's time constant in seconds (0 means no glide: jump straight to the goal)
+	void setTau(int voice, float tau);
+
+	/// @brief starts gliding a voice from wherever it is now to v_goal
+	void glideTo(int voice, float v_goal);
+
+	/// @brief starts gliding a voice from v_start to v_goal with time constant tau
+	void start(int voice, float v_start, float v_goal, float tau);
+
+	/// @brief moves a voice to v immediately, settled there
+	void jumpTo(int voice, float v);
+
+	/// @return float a voice's current output
+	float now(int voice) const { return _v_goal[voice] + _delta[voice]; }
+
+	/// @return float a voice's next output sample (advances just that voice)
+	float next(int voice);
+
+	/**
+	 * @brief advances every voice n_samples and writes their outputs frame by frame:
+	 * out[sample * _n_voices + voice], which is the order a DAC write loop consumes them in.
+	 */
+	void processBlock(float* out, int n_samples);
+
+	/**
+	 * @brief predicts how long until a voice is within tolerance of its goal, via nTauOfPcnt01()
+	 * @return float seconds from now (0 if it is already within tolerance)
+	 */
+	float secondsToTolerance(int voice, float tolerance) const;
+
+	/// @return unsigned long samples until a voice is within tolerance of its goal (rounded up)
+	unsigned long samplesToTolerance(int voice, float tolerance) const;
+
+	/// @return bool whether a voice is within tolerance of its goal
+	bool settled(int voice, float tolerance) const;
+};
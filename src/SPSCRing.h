@@ -0,0 +1,117 @@
+#pragma once
+
+/**************************************************************************************************
+* @file  SPSCRing.h
+*
+* @brief SPSCRing is a fixed-size, lock-free, single-producer/single-consumer ring buffer.
+***************************************************************************************************/
+
+// One side (e.g. an ISR or a sampling thread) only ever pushes and the other side only ever pops,
+// so each index has exactly one writer and no lock is needed. On the host the indices are
+// std::atomic (acquire/release). AVR has no <atomic> but 8-bit loads/stores are atomic there, so
+// the indices are volatile uint8_t, which limits N to 256 on AVR.
+
+#include <stdint.h>
+
+#if defined(__AVR__)
+typedef uint8_t SPSCRing_index_t;
+// volatile only orders the index accesses among themselves: the compiler barriers keep _buf's
+// element copies from being moved after the store that publishes them, or before the load that
+// says they are there (AVR doesn't reorder memory accesses itself, so no fence instruction is needed)
+#define SPSCRING_BARRIER()        asm volatile("" ::: "memory")
+#define SPSCRING_LOAD(idx)        __extension__({ SPSCRing_index_t idx_ = (idx); SPSCRING_BARRIER(); idx_; })
+#define SPSCRING_STORE(idx, val)  do { SPSCRING_BARRIER(); (idx) = (val); } while (0)
+#else
+#include <atomic>
+typedef unsigned SPSCRing_index_t;
+#define SPSCRING_LOAD(idx)        (idx).load(std::memory_order_acquire)
+#define SPSCRING_STORE(idx, val)  (idx).store((val), std::memory_order_release)
+#endif
+
+/**
+ * @brief lock-free single-producer/single-consumer ring buffer of N elements of type T
+ *
+ * @tparam T the element type (should be trivially copyable)
+ * @tparam N capacity, must be a power of 2 (and <= 256 on AVR). One slot is never used so that
+ * full and empty can be told apart, so at most N-1 elements are held at once.
+ */
+template <typename T, unsigned N>
+class SPSCRing {
+	static_assert(N >= 2 && (N & (N - 1)) == 0, "SPSCRing size must be a power of 2");
+#if defined(__AVR__)
+	static_assert(N <= 256, "SPSCRing size must be <= 256 on AVR");
+#endif
+ public:
+	T _buf[N];
+#if defined(__AVR__)
+	volatile SPSCRing_index_t _head = 0; // next slot to write (written by producer only)
+	volatile SPSCRing_index_t _tail = 0; // next slot to read (written by consumer only)
+#else
+	std::atomic<SPSCRing_index_t> _head{0}; // next slot to write (written by producer only)
+	std::atomic<SPSCRing_index_t> _tail{0}; // next slot to read (written by consumer only)
+#endif
+
+	static constexpr unsigned capacity() { return N - 1; }
+
+	//**** producer side **************************************************
+
+	/**
+	 * @brief (producer only) append one element
+	 * @return true if pushed, false if the ring was full (the element is dropped)
+	 */
+	bool push(const T& value) {
+		SPSCRing_index_t head = SPSCRING_LOAD(_head);
+		SPSCRing_index_t next = (head + 1) & (N - 1);
+		if (next == SPSCRING_LOAD(_tail)) return false;
+		_buf[head] = value;
+		SPSCRING_STORE(_head, next);
+		return true;
+	}
+
+	/**
+	 * @brief (producer only) append up to count elements, publishing them all at once
+	 * @return the number of elements pushed (less than count if the ring filled up)
+	 */
+	unsigned pushBlock(const T* values, unsigned count) {
+		SPSCRing_index_t head = SPSCRING_LOAD(_head);
+		unsigned space = (SPSCRING_LOAD(_tail) - head - 1) & (N - 1);
+		if (count > space) count = space;
+		for (unsigned i = 0; i < count; i++) _buf[(head + i) & (N - 1)] = values[i];
+		SPSCRING_STORE(_head, (head + count) & (N - 1));
+		return count;
+	}
+
+	//**** consumer side **************************************************
+
+	/**
+	 * @brief (consumer only) remove the oldest element
+	 * @return true if an element was written to value, false if the ring was empty
+	 */
+	bool pop(T& value) {
+		SPSCRing_index_t tail = SPSCRING_LOAD(_tail);
+		if (tail == SPSCRING_LOAD(_head)) return false;
+		value = _buf[tail];
+		SPSCRING_STORE(_tail, (tail + 1) & (N - 1));
+		return true;
+	}
+
+	/**
+	 * @brief (consumer only) remove up to max_count of the oldest elements into out
+	 * @return the number of elements written to out
+	 */
+	unsigned popBlock(T* out, unsigned max_count) {
+		SPSCRing_index_t tail = SPSCRING_LOAD(_tail);
+		unsigned count = (SPSCRING_LOAD(_head) - tail) & (N - 1);
+		if (count > max_count) count = max_count;
+		for (unsigned i = 0; i < count; i++) out[i] = _buf[(tail + i) & (N - 1)];
+		SPSCRING_STORE(_tail, (tail + count) & (N - 1));
+		return count;
+	}
+
+	//**** either side ****************************************************
+
+	/// @brief number of elements waiting to be popped (a snapshot: the other side may change it)
+	unsigned size() const { return (SPSCRING_LOAD(_head) - SPSCRING_LOAD(_tail)) & (N - 1); }
+
+	bool empty() const { return size() == 0; }
+};
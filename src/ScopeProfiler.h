@@ -0,0 +1,193 @@
+#pragma once
+
+/**************************************************************************************************
+* @file  ScopeProfiler.h
+*
+* @brief zero-allocation hierarchical scope profiler built on TimeElapsed and WelfordOnlineStats.
+***************************************************************************************************/
+
+/*
+	Mark a scope with IS_PROFILE_SCOPE("name"); when it exits, an event (scope id, parent id, depth,
+	start, duration) is recorded into the calling thread's fixed-size ring (the oldest events are
+	overwritten). profilerAggregate() folds the events recorded since the last call into per-scope
+	stats (count, mean, stddev via WelfordOnlineStats, and max), also per thread.
+
+	Everything here is compiled only when IS_PROFILER_ENABLED is defined non-zero (e.g. with
+	-DIS_PROFILER_ENABLED=1). Otherwise the macros expand to nothing and none of the profiler's code or
+	data exists, so release firmware pays nothing. It is header-only so that the switch seen by the
+	code being profiled is the only one that matters.
+*/
+
+#ifndef IS_PROFILER_ENABLED
+#define IS_PROFILER_ENABLED 0
+#endif
+
+#if IS_PROFILER_ENABLED
+
+#include "TimeElapsed.h"
+#include "welford_averages.h"
+
+#ifndef PROFILER_MAX_SCOPES
+#define PROFILER_MAX_SCOPES 16 ///< max distinct IS_PROFILE_SCOPE()s (ids are uint8_t)
+#endif
+#if PROFILER_MAX_SCOPES < 1 || PROFILER_MAX_SCOPES > 255
+#error "PROFILER_MAX_SCOPES must be 1...255 (ids are uint8_t and 0xFF is PROFILER_NO_PARENT)"
+#endif
+
+#ifndef PROFILER_RING_SIZE
+#define PROFILER_RING_SIZE 64 ///< events kept per thread
+#endif
+
+#ifndef PROFILER_MAX_DEPTH
+#define PROFILER_MAX_DEPTH 8 ///< max nesting of profiled scopes (deeper ones are recorded with the deepest parent)
+#endif
+
+#define PROFILER_NO_PARENT 0xFF
+
+#if defined(ARDUINO)
+#define PROFILER_THREAD_LOCAL        // one thread
+#else
+#define PROFILER_THREAD_LOCAL thread_local
+#include <atomic>
+#endif
+
+struct ProfilerEvent {
+	uint8_t id;              ///< the scope
+	uint8_t parent;          ///< the enclosing scope or PROFILER_NO_PARENT
+	uint8_t depth;           ///< 0 for outermost scopes
+	TimeElapsed_t start;     ///< time function value when the scope was entered
+	TimeElapsed_t duration;  ///< time spent in the scope (0 on overflow, see TimeElapsed::elapsed())
+};
+
+struct ProfilerScopeStats {
+	WelfordOnlineStats stats; ///< count, mean and stddev of the scope's durations
+	TimeElapsed_t max = 0;    ///< longest duration
+};
+
+/**
+ * @brief per-thread profiler state: the event ring, the stack of open scopes and the aggregated stats
+ */
+struct ProfilerThreadState {
+	ProfilerEvent events[PROFILER_RING_SIZE];
+	unsigned long n_recorded = 0;   ///< events ever recorded (ring index is n_recorded % PROFILER_RING_SIZE)
+	unsigned long n_aggregated = 0; ///< events folded into stats so far
+	unsigned long n_lost = 0;       ///< events overwritten before they were aggregated
+	uint8_t stack[PROFILER_MAX_DEPTH];
+	uint8_t depth = 0;
+	ProfilerScopeStats stats[PROFILER_MAX_SCOPES];
+
+	void record(uint8_t id, TimeElapsed_t start, TimeElapsed_t duration) {
+		ProfilerEvent& e = events[n_recorded % PROFILER_RING_SIZE];
+		e.id = id;
+		e.depth = depth;
+		e.parent = depth ? stack[(depth > PROFILER_MAX_DEPTH ? PROFILER_MAX_DEPTH : depth) - 1] : PROFILER_NO_PARENT;
+		e.start = start;
+		e.duration = duration;
+		++n_recorded;
+	}
+};
+
+/// @return ProfilerThreadState& the calling thread's profiler state
+inline ProfilerThreadState& profilerThreadState() {
+	static PROFILER_THREAD_LOCAL ProfilerThreadState state;
+	return state;
+}
+
+inline const char** profilerScopeNames() {
+	static const char* names[PROFILER_MAX_SCOPES];
+	return names;
+}
+
+#if defined(ARDUINO)
+inline uint8_t& profilerScopeCounter() { static uint8_t n = 0; return n; }
+#else
+inline std::atomic<uint8_t>& profilerScopeCounter() { static std::atomic<uint8_t> n{0}; return n; }
+#endif
+
+/**
+ * @brief assigns the next scope id to name (IS_PROFILE_SCOPE() does this once per scope). The counter
+ * stops at PROFILER_MAX_SCOPES, so however many scopes register it never wraps back to hand out ids
+ * that are already taken.
+ * @return uint8_t the id, or PROFILER_MAX_SCOPES - 1 (shared) when all ids are taken
+ */
+inline uint8_t profilerRegisterScope(const char* name) {
+#if defined(ARDUINO)
+	uint8_t& counter = profilerScopeCounter();
+	uint8_t id = counter;
+	if (id >= PROFILER_MAX_SCOPES) return PROFILER_MAX_SCOPES - 1;
+	counter = id + 1;
+#else
+	std::atomic<uint8_t>& counter = profilerScopeCounter();
+	uint8_t id = counter.load(std::memory_order_relaxed);
+	do {
+		if (id >= PROFILER_MAX_SCOPES) return PROFILER_MAX_SCOPES - 1;
+	} while (!counter.compare_exchange_weak(id, (uint8_t)(id + 1))); // on failure id is reloaded
+#endif
+	profilerScopeNames()[id] = name;
+	return id;
+}
+
+/// @return uint8_t the number of registered scopes
+inline uint8_t profilerScopeCount() { return profilerScopeCounter(); }
+
+inline const char* profilerScopeName(uint8_t id) { return id < PROFILER_MAX_SCOPES ? profilerScopeNames()[id] : nullptr; }
+
+/**
+ * @brief folds the calling thread's events recorded since the last call into its per-scope stats
+ * @return unsigned long number of events folded in (events overwritten before this call are counted in n_lost)
+ */
+inline unsigned long profilerAggregate() {
+	ProfilerThreadState& st = profilerThreadState();
+	if (st.n_recorded - st.n_aggregated > PROFILER_RING_SIZE) {
+		st.n_lost += st.n_recorded - st.n_aggregated - PROFILER_RING_SIZE;
+		st.n_aggregated = st.n_recorded - PROFILER_RING_SIZE;
+	}
+	unsigned long n = st.n_recorded - st.n_aggregated;
+	for (; st.n_aggregated < st.n_recorded; ++st.n_aggregated) {
+		const ProfilerEvent& e = st.events[st.n_aggregated % PROFILER_RING_SIZE];
+		ProfilerScopeStats& s = st.stats[e.id];
+		s.stats.update(e.duration);
+		if (e.duration > s.max) s.max = e.duration;
+	}
+	return n;
+}
+
+/// @return const ProfilerScopeStats& the calling thread's stats for a scope (call profilerAggregate() first)
+inline const ProfilerScopeStats& profilerStats(uint8_t id) { return profilerThreadState().stats[id]; }
+
+/**
+ * RAII scope marker: starts a TimeElapsed on construction and records an event on destruction.
+ * Use it through IS_PROFILE_SCOPE() so it disappears when the profiler is compiled out.
+ */
+class ProfileScope {
+ public:
+	TimeElapsed _te;
+	uint8_t _id;
+
+	ProfileScope(uint8_t id) : _te(true), _id{id} {
+		ProfilerThreadState& st = profilerThreadState();
+		if (st.depth < PROFILER_MAX_DEPTH) st.stack[st.depth] = id;
+		++st.depth;
+	}
+
+	~ProfileScope() {
+		TimeElapsed_t duration = _te.elapsed();
+		ProfilerThreadState& st = profilerThreadState();
+		--st.depth;
+		st.record(_id, _te._t0, duration);
+	}
+};
+
+#define IS_PROFILE_CAT_(a, b) a##b
+#define IS_PROFILE_CAT(a, b) IS_PROFILE_CAT_(a, b)
+
+/// @brief profiles the rest of the enclosing scope under name (a string literal)
+#define IS_PROFILE_SCOPE(name) \
+	static const uint8_t IS_PROFILE_CAT(_is_profile_id_, __LINE__) = profilerRegisterScope(name); \
+	ProfileScope IS_PROFILE_CAT(_is_profile_scope_, __LINE__)(IS_PROFILE_CAT(_is_profile_id_, __LINE__))
+
+#else // !IS_PROFILER_ENABLED
+
+#define IS_PROFILE_SCOPE(name)
+
+#endif
@@ -0,0 +1,119 @@
+#include "ShardedWelford.h"
+
+#if IS_HAS_SHARDED_WELFORD
+
+#include <math.h>
+#include <thread>
+#include "cpu_dispatch.h"
+#include "cpu_kernels.h"
+
+double WelfordMoments::stddev() const {
+	return sqrt(variance());
+}
+
+double WelfordMoments::standardError() const {
+	return count > 1 ? sqrt(variance() / count) : 0;
+}
+
+static std::atomic<unsigned> g_next_thread{0};
+static thread_local unsigned t_thread_index = g_next_thread.fetch_add(1, std::memory_order_relaxed);
+
+ShardedWelford::ShardedWelford(int n_shards) {
+	if (n_shards <= 0) n_shards = (int)std::thread::hardware_concurrency();
+	if (n_shards <= 0) n_shards = 1;
+	_shards = new Shard[n_shards];
+	_n_shards = n_shards;
+}
+
+ShardedWelford::~ShardedWelford() {
+	delete[] _shards;
+}
+
+ShardedWelford::Shard& ShardedWelford::_myShard() {
+	return _shards[t_thread_index % _n_shards];
+}
+
+uint32_t ShardedWelford::_lock(Shard& s) {
+	uint32_t seq = s.seq.load(std::memory_order_relaxed);
+	for (;;) { // only spins if another thread shares this shard
+		if (!(seq & 1) && s.seq.compare_exchange_weak(seq, seq + 1, std::memory_order_acquire, std::memory_order_relaxed)) break;
+		seq = s.seq.load(std::memory_order_relaxed);
+	}
+	std::atomic_thread_fence(std::memory_order_release); // the odd seq is visible before any data store
+	return seq + 1;
+}
+
+void ShardedWelford::_unlock(Shard& s, uint32_t seq) {
+	s.seq.store(seq + 1, std::memory_order_release);
+}
+
+WelfordMoments ShardedWelford::_read(const Shard& s) {
+	WelfordMoments m;
+	for (;;) {
+		uint32_t seq = s.seq.load(std::memory_order_acquire);
+		if (seq & 1) continue; // a write is in progress
+		m.count = s.count.load(std::memory_order_relaxed);
+		m.mean = s.mean.load(std::memory_order_relaxed);
+		m.m2 = s.m2.load(std::memory_order_relaxed);
+		std::atomic_thread_fence(std::memory_order_acquire); // the data loads happen before the re-check
+		if (s.seq.load(std::memory_order_relaxed) == seq) return m;
+	}
+}
+
+void ShardedWelford::update(double new_value) {
+	Shard& s = _myShard();
+	uint32_t seq = _lock(s);
+	uint64_t count = s.count.load(std::memory_order_relaxed) + 1;
+	double mean = s.mean.load(std::memory_order_relaxed);
+	double delta = new_value - mean;
+	mean += delta / count;
+	s.count.store(count, std::memory_order_relaxed);
+	s.mean.store(mean, std::memory_order_relaxed);
+	s.m2.store(s.m2.load(std::memory_order_relaxed) + delta * (new_value - mean), std::memory_order_relaxed);
+	_unlock(s, seq);
+}
+
+void ShardedWelford::updateBlock(const float* values, int n) {
+	if (n <= 0) return;
+	WelfordMoments block;
+	float block_mean, block_m2;
+#if IS_HAS_CPU_DISPATCH
+	cpuKernels().blockMoments(values, n, &block_mean, &block_m2);
+#else
+	is::blockMomentsKernel<2 * IS_KERNEL_LANES>(values, n, &block_mean, &block_m2);
+#endif
+	block.count = n;
+	block.mean = block_mean;
+	block.m2 = block_m2;
+
+	Shard& s = _myShard();
+	uint32_t seq = _lock(s);
+	WelfordMoments m;
+	m.count = s.count.load(std::memory_order_relaxed);
+	m.mean = s.mean.load(std::memory_order_relaxed);
+	m.m2 = s.m2.load(std::memory_order_relaxed);
+	m.merge(block);
+	s.count.store(m.count, std::memory_order_relaxed);
+	s.mean.store(m.mean, std::memory_order_relaxed);
+	s.m2.store(m.m2, std::memory_order_relaxed);
+	_unlock(s, seq);
+}
+
+WelfordMoments ShardedWelford::snapshot() const {
+	WelfordMoments total;
+	for (int i = 0; i < _n_shards; i++) total.merge(_read(_shards[i]));
+	return total;
+}
+
+void ShardedWelford::clear() {
+	for (int i = 0; i < _n_shards; i++) {
+		Shard& s = _shards[i];
+		uint32_t seq = _lock(s);
+		s.count.store(0, std::memory_order_relaxed);
+		s.mean.store(0, std::memory_order_relaxed);
+		s.m2.store(0, std::memory_order_relaxed);
+		_unlock(s, seq);
+	}
+}
+
+#endif
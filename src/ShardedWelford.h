@@ -0,0 +1,112 @@
+#pragma once
+
+/**************************************************************************************************
+* @file  ShardedWelford.h
+*
+* @brief (host only) ShardedWelford is a WelfordOnlineStats that many threads can update at once
+* without a shared lock: each thread updates its own cache-line-sized shard, and readers merge the
+* shards when they ask for the statistics.
+***************************************************************************************************/
+
+/*
+	Every thread is given a shard index once (round robin, on its first update to any
+	ShardedWelford), so with no more threads than shards each thread's updates only ever touch its
+	own cache line: an update costs the same no matter how many threads are updating. Threads
+	beyond that share shards, which is still correct, just no longer contention-free.
+
+	Each shard is guarded by a sequence counter (a seqlock): a writer makes it odd, updates count,
+	mean and m2, then makes it even again; a reader copies the shard and retries if the counter was
+	odd or changed meanwhile. So readers never block writers, and every shard read is a consistent
+	(count, mean, m2) triple. snapshot() merges the shards with the parallel combination formula
+	(Chan et al.), giving statistics equal to a single accumulator that saw every update that had
+	finished when each shard was read.
+*/
+
+#if !defined(ARDUINO)
+
+#define IS_HAS_SHARDED_WELFORD 1
+
+#include <stdint.h>
+#include <atomic>
+
+#ifndef SHARDEDWELFORD_CACHE_LINE
+#define SHARDEDWELFORD_CACHE_LINE 64 ///< shard alignment and size, so no two shards share a cache line
+#endif
+
+/// @brief count/mean/m2 of a data set, mergeable with another set's (the parallel combination formula)
+struct WelfordMoments {
+	uint64_t count = 0;
+	double mean = 0;
+	double m2 = 0;  ///< sum of squared deviations from the mean
+
+	/// @brief adds another set's moments to these, as if its data points had been update()d here
+	void merge(const WelfordMoments& other) {
+		if (!other.count) return;
+		uint64_t total = count + other.count;
+		double delta = other.mean - mean;
+		mean += delta * ((double)other.count / total);
+		m2 += other.m2 + delta * delta * ((double)count * other.count / total);
+		count = total;
+	}
+
+	/// @return double the sample variance (0 if less than 2 data points)
+	double variance() const { return count > 1 ? m2 / (count - 1) : 0; }
+
+	double stddev() const;
+
+	/// @return double stddev()/sqrt(count) (0 if less than 2 data points)
+	double standardError() const;
+};
+
+class ShardedWelford {
+ public:
+	struct alignas(SHARDEDWELFORD_CACHE_LINE) Shard {
+		std::atomic<uint32_t> seq{0};  // odd while a writer is updating
+		// atomics (accessed relaxed) only so reads racing a writer aren't undefined behavior
+		std::atomic<uint64_t> count{0};
+		std::atomic<double> mean{0};
+		std::atomic<double> m2{0};
+	};
+
+	Shard* _shards = nullptr;
+	int _n_shards = 0;
+
+	/// @param n_shards (default=0) number of shards; 0 for one per hardware thread
+	explicit ShardedWelford(int n_shards=0);
+	~ShardedWelford();
+	ShardedWelford(const ShardedWelford&) = delete;
+	ShardedWelford& operator=(const ShardedWelford&) = delete;
+
+	/// @brief incorporates a data point into the calling thread's shard
+	void update(double new_value);
+
+	/**
+	 * @brief incorporates n data points into the calling thread's shard at once (their moments
+	 * come from the same kernel as WelfordOnlineStats::updateBlock())
+	 */
+	void updateBlock(const float* values, int n);
+
+	/// @return WelfordMoments the merged statistics of every shard (see above)
+	WelfordMoments snapshot() const;
+
+	double mean() const { return snapshot().mean; }
+	double variance() const { return snapshot().variance(); }
+	double stddev() const { return snapshot().stddev(); }
+	uint64_t count() const { return snapshot().count; }
+
+	/// @brief zeroes every shard (updates running concurrently land before or after, never half)
+	void clear();
+
+	int shards() const { return _n_shards; }
+
+	//**** internals *******************************************************
+
+	Shard& _myShard();
+	static uint32_t _lock(Shard& s);
+	static void _unlock(Shard& s, uint32_t seq);
+	static WelfordMoments _read(const Shard& s);
+};
+
+#else
+#define IS_HAS_SHARDED_WELFORD 0
+#endif
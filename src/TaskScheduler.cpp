@@ -0,0 +1,134 @@
+#include "TaskScheduler.h"
+
+TaskScheduler::TaskScheduler(TimeElapsed_t(*time_func)()): _time_func{time_func} {}
+
+int TaskScheduler::addTask(ScheduledTaskFunc func, TimeElapsed_t period, TimeElapsed_t first_delay, void* ctx) {
+	int id = -1;
+	for (int i = 0; i < TASKSCHEDULER_MAX_TASKS; i++) {
+		if (!_tasks[i].active) { id = i; break; }
+	}
+	if (id < 0 || !func) return -1;
+
+	ScheduledTask& t = _tasks[id];
+	uint8_t generation = t.generation + 1;
+	t = ScheduledTask();
+	t.generation = generation;
+	t.func = func;
+	t.ctx = ctx;
+	t.period = period;
+	t.deadline = (*_time_func)() + first_delay;
+	t.active = true;
+
+	_heap[_heap_size] = id;
+	_heap_pos[id] = _heap_size;
+	_siftUp(_heap_size++);
+	return id;
+}
+
+bool TaskScheduler::cancel(int id) {
+	if (id < 0 || id >= TASKSCHEDULER_MAX_TASKS || !_tasks[id].active) return false;
+	_heapRemove(_heap_pos[id]);
+	_tasks[id].active = false;
+	return true;
+}
+
+bool TaskScheduler::reschedule(int id, TimeElapsed_t delay) {
+	if (id < 0 || id >= TASKSCHEDULER_MAX_TASKS || !_tasks[id].active) return false;
+	TimeElapsed_t old_deadline = _tasks[id].deadline;
+	_tasks[id].deadline = (*_time_func)() + delay;
+	_tasks[id].rescheduled = true;
+	if ((long)(_tasks[id].deadline - old_deadline) < 0) _siftUp(_heap_pos[id]);
+	else _siftDown(_heap_pos[id]);
+	return true;
+}
+
+TimeElapsed_t TaskScheduler::timeUntilNext() {
+	if (!_heap_size) return 0;
+	long until = (long)(_tasks[_heap[0]].deadline - (*_time_func)());
+	return until > 0 ? until : 0;
+}
+
+int TaskScheduler::runDue(int max_runs) {
+	int runs = 0;
+	while (_heap_size && (!max_runs || runs < max_runs)) {
+		uint8_t id = _heap[0];
+		ScheduledTask& t = _tasks[id];
+		TimeElapsed_t start = (*_time_func)();
+		if ((long)(start - t.deadline) < 0) break; // earliest isn't due, so none are
+
+		TimeElapsed_t deadline = t.deadline; // func may reschedule
+		uint8_t generation = t.generation;
+		t.rescheduled = false;
+		t.func(t.ctx);
+		TimeElapsed_t end = (*_time_func)();
+		++runs;
+		// func cancelled this task and addTask() reused its id: the slot (and heap entry) is the new task's
+		if (t.generation != generation) continue;
+
+		TimeElapsed_t jitter = start - deadline, run_time = end - start;
+		t.jitter.update(jitter);
+		t.run_time.update(run_time);
+		if (jitter > t.max_jitter) t.max_jitter = jitter;
+		if (run_time > t.max_run_time) t.max_run_time = run_time;
+		++t.runs;
+
+		// func may have added, cancelled or rescheduled tasks, so the heap may have moved: use _heap_pos
+		if (!t.active || t.rescheduled) continue; // the task cancelled (out of the heap) or rescheduled itself
+		if (t.period == 0) { // one-shot: done
+			_heapRemove(_heap_pos[id]);
+			t.active = false;
+			continue;
+		}
+		t.deadline += t.period;
+		if ((long)(end - t.deadline) > 0) {
+			++t.overruns;
+			while ((long)(end - t.deadline) > 0) { t.deadline += t.period; ++t.missed; } // skip missed periods
+		}
+		_siftDown(_heap_pos[id]);
+	}
+	return runs;
+}
+
+void TaskScheduler::clearStats(int id) {
+	ScheduledTask& t = _tasks[id];
+	t.jitter.clear();
+	t.run_time.clear();
+	t.max_jitter = t.max_run_time = 0;
+	t.runs = t.overruns = t.missed = 0;
+}
+
+void TaskScheduler::_swap(uint8_t i, uint8_t j) {
+	uint8_t tmp = _heap[i];
+	_heap[i] = _heap[j];
+	_heap[j] = tmp;
+	_heap_pos[_heap[i]] = i;
+	_heap_pos[_heap[j]] = j;
+}
+
+void TaskScheduler::_siftUp(uint8_t i) {
+	while (i > 0) {
+		uint8_t parent = (i - 1) / 2;
+		if (!_before(_heap[i], _heap[parent])) break;
+		_swap(i, parent);
+		i = parent;
+	}
+}
+
+void TaskScheduler::_siftDown(uint8_t i) {
+	for (;;) {
+		uint8_t left = 2 * i + 1, right = left + 1, smallest = i;
+		if (left < _heap_size && _before(_heap[left], _heap[smallest])) smallest = left;
+		if (right < _heap_size && _before(_heap[right], _heap[smallest])) smallest = right;
+		if (smallest == i) break;
+		_swap(i, smallest);
+		i = smallest;
+	}
+}
+
+void TaskScheduler::_heapRemove(uint8_t i) {
+	--_heap_size;
+	if (i == _heap_size) return;
+	_swap(i, _heap_size);
+	_siftDown(i);
+	_siftUp(i);
+}
@@ -0,0 +1,108 @@
+#pragma once
+
+/**************************************************************************************************
+* @file  TaskScheduler.h
+*
+* @brief TaskScheduler is a cooperative deadline scheduler for periodic and one-shot tasks, with
+* per-task jitter, run time and overrun statistics.
+***************************************************************************************************/
+
+/*
+	Call runDue() from loop(); it runs every task whose deadline has passed, earliest first. Tasks
+	are kept in a binary min-heap keyed on their next deadline, so the next due task is found in O(1)
+	(nextDue()) and adding, cancelling or rescheduling a task is O(log n).
+
+	Deadlines are compared by signed difference, so they are correct across wraps of the time
+	function as long as no deadline is more than half its range (~35 minutes for micros()) away.
+	Periodic deadlines advance by exactly one period each run (no drift). If a run ends after the
+	task's next deadline, that counts as an overrun and deadlines that were missed are skipped.
+*/
+
+#include "TimeElapsed.h"
+#include "welford_averages.h"
+
+#ifndef TASKSCHEDULER_MAX_TASKS
+#define TASKSCHEDULER_MAX_TASKS 8 ///< number of tasks a TaskScheduler can hold
+#endif
+
+typedef void (*ScheduledTaskFunc)(void* ctx);
+
+struct ScheduledTask {
+	ScheduledTaskFunc func = nullptr;
+	void* ctx = nullptr;
+	TimeElapsed_t period = 0;      ///< 0 for a one-shot task
+	TimeElapsed_t deadline = 0;    ///< when the task is next due
+	bool active = false;           ///< false once a one-shot has run or the task was cancelled
+	bool rescheduled = false;      // set by reschedule(), so runDue() leaves a deadline set from inside func alone
+	uint8_t generation = 0;        // bumped each time addTask() (re)uses this slot
+
+	WelfordOnlineStats jitter;     ///< how late each run started (start time - deadline)
+	WelfordOnlineStats run_time;   ///< how long each run took
+	TimeElapsed_t max_jitter = 0;
+	TimeElapsed_t max_run_time = 0;
+	unsigned long runs = 0;
+	unsigned long overruns = 0;    ///< runs that ended after the task's next deadline
+	unsigned long missed = 0;      ///< periods skipped because of overruns
+};
+
+class TaskScheduler {
+ public:
+	TimeElapsed_t (*_time_func)(); // time function is normally micros() or millis()
+	ScheduledTask _tasks[TASKSCHEDULER_MAX_TASKS];
+	uint8_t _heap[TASKSCHEDULER_MAX_TASKS];     // task ids, min-heap on deadline
+	uint8_t _heap_pos[TASKSCHEDULER_MAX_TASKS]; // each active task's index in _heap
+	uint8_t _heap_size = 0;
+
+	/// @param time_func (default=micros) is normally micros() or millis()
+	TaskScheduler(TimeElapsed_t(*time_func)()=micros);
+
+	/**
+	 * @brief adds a periodic task
+	 * @param func called with ctx each time the task is due
+	 * @param period time between deadlines (in time function units), or 0 for a one-shot task
+	 * @param first_delay (default=0) time from now until the first deadline
+	 * @param ctx (default=nullptr) passed to func
+	 * @return int the task's id, or -1 if TASKSCHEDULER_MAX_TASKS tasks are already active
+	 */
+	int addTask(ScheduledTaskFunc func, TimeElapsed_t period, TimeElapsed_t first_delay=0, void* ctx=nullptr);
+
+	/// @brief adds a task that runs once, delay from now. See addTask().
+	int addOneShot(ScheduledTaskFunc func, TimeElapsed_t delay, void* ctx=nullptr) { return addTask(func, 0, delay, ctx); }
+
+	/// @brief removes a task (its stats are kept until its id is reused)
+	bool cancel(int id);
+
+	/// @brief moves a task's next deadline to delay from now
+	bool reschedule(int id, TimeElapsed_t delay);
+
+	/// @return int the id of the task with the earliest deadline, or -1 if there are none (O(1))
+	int nextDue() const { return _heap_size ? _heap[0] : -1; }
+
+	/**
+	 * @return TimeElapsed_t time from now until the earliest deadline (0 if it has passed or there
+	 * are no tasks), e.g. how long loop() may sleep
+	 */
+	TimeElapsed_t timeUntilNext();
+
+	/**
+	 * @brief runs every task that is due, earliest deadline first. A task's func may call addTask(),
+	 * cancel() or reschedule() (on itself or others): a task that cancels or reschedules itself is
+	 * left as it says, instead of being advanced by its period or retired as a one-shot.
+	 * @param max_runs (default=0) if >0, stop after this many runs so a slow task can't starve loop()
+	 * @return int number of tasks run
+	 */
+	int runDue(int max_runs=0);
+
+	const ScheduledTask& task(int id) const { return _tasks[id]; }
+
+	/// @brief clears a task's jitter/run time/overrun stats
+	void clearStats(int id);
+
+	//**** heap maintenance (private in spirit) ***************************
+
+	bool _before(uint8_t a, uint8_t b) const { return (long)(_tasks[a].deadline - _tasks[b].deadline) < 0; }
+	void _swap(uint8_t i, uint8_t j);
+	void _siftUp(uint8_t i);
+	void _siftDown(uint8_t i);
+	void _heapRemove(uint8_t i);
+};
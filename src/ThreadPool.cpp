@@ -0,0 +1,139 @@
+#include "ThreadPool.h"
+
+#if IS_HAS_THREADPOOL
+
+static thread_local bool t_in_pool_loop = false; // set while this thread runs a parallelFor() func
+
+ThreadPool::ThreadPool(int n_threads) {
+	if (n_threads <= 0) n_threads = (int)std::thread::hardware_concurrency();
+	if (n_threads <= 0) n_threads = 1;
+	for (int i = 0; i < n_threads - 1; i++) _workers.emplace_back(&ThreadPool::_workerLoop, this);
+}
+
+ThreadPool::~ThreadPool() {
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_stop = true;
+	}
+	_wake.notify_all();
+	for (std::thread& t : _workers) t.join();
+}
+
+ThreadPool& ThreadPool::shared() {
+	static ThreadPool pool;
+	return pool;
+}
+
+static inline uint64_t packRange(uint32_t begin, uint32_t end) { return (uint64_t)begin << 32 | end; }
+
+void ThreadPool::_runIndices(Job& job, int slot) {
+	bool was_in_loop = t_in_pool_loop;
+	t_in_pool_loop = true;
+	if (!job.ranges) {
+		for (int i; (i = job.next.fetch_add(1, std::memory_order_relaxed)) < job.n;) job.func(i, job.ctx);
+		t_in_pool_loop = was_in_loop;
+		return;
+	}
+
+	std::atomic<uint64_t>& own = job.ranges[slot];
+	int n_ranges = job.max_workers + 1;
+	for (;;) {
+		// take the next index of our own range (thieves may shrink its end meanwhile)
+		uint64_t r = own.load(std::memory_order_acquire);
+		uint32_t begin = (uint32_t)(r >> 32), end = (uint32_t)r;
+		if (begin < end) {
+			if (own.compare_exchange_weak(r, packRange(begin + 1, end), std::memory_order_acq_rel)) job.func((int)begin, job.ctx);
+			continue;
+		}
+
+		// ours is empty: steal the upper half of the largest range left
+		int victim = -1;
+		uint32_t most = 0;
+		for (int v = 0; v < n_ranges; v++) {
+			uint64_t rv = job.ranges[v].load(std::memory_order_relaxed);
+			uint32_t left = (uint32_t)rv - (uint32_t)(rv >> 32);
+			if ((uint32_t)rv > (uint32_t)(rv >> 32) && left > most) { most = left; victim = v; }
+		}
+		if (victim < 0) break; // everything has been handed out
+		uint64_t rv = job.ranges[victim].load(std::memory_order_acquire);
+		uint32_t vb = (uint32_t)(rv >> 32), ve = (uint32_t)rv;
+		if (vb >= ve) continue;
+		uint32_t mid = vb + (ve - vb) / 2;
+		if (job.ranges[victim].compare_exchange_strong(rv, packRange(vb, mid), std::memory_order_acq_rel)) {
+			own.store(packRange(mid, ve), std::memory_order_release);
+		}
+	}
+	t_in_pool_loop = was_in_loop;
+}
+
+void ThreadPool::parallelFor(int n, ParallelForFunc func, void* ctx, int max_threads) {
+	_run(n, func, ctx, max_threads, false);
+}
+
+void ThreadPool::parallelForStealing(int n, ParallelForFunc func, void* ctx, int max_threads) {
+	_run(n, func, ctx, max_threads, true);
+}
+
+void ThreadPool::_run(int n, ParallelForFunc func, void* ctx, int max_threads, bool stealing) {
+	if (n <= 0) return;
+	int workers = (int)_workers.size();
+	if (max_threads > 0 && max_threads - 1 < workers) workers = max_threads - 1;
+	if (workers > n - 1) workers = n - 1;
+	if (workers <= 0 || t_in_pool_loop) { // serial: one thread, one index, or nested inside a loop
+		for (int i = 0; i < n; i++) func(i, ctx);
+		return;
+	}
+
+	std::lock_guard<std::mutex> run_lock(_run_mutex);
+	Job job;
+	job.func = func;
+	job.ctx = ctx;
+	job.n = n;
+	job.max_workers = workers;
+	std::vector<std::atomic<uint64_t>> ranges(stealing ? workers + 1 : 0);
+	if (stealing) {
+		for (int t = 0; t <= workers; t++) {
+			ranges[t].store(packRange((uint32_t)((int64_t)n * t / (workers + 1)), (uint32_t)((int64_t)n * (t + 1) / (workers + 1))));
+		}
+		job.ranges = ranges.data();
+	}
+	{
+		std::lock_guard<std::mutex> lock(_mutex);
+		_job = &job;
+		++_generation;
+	}
+	_wake.notify_all();
+
+	_runIndices(job, 0);
+
+	// the job lives on this stack: wait until no worker can still touch it
+	std::unique_lock<std::mutex> lock(_mutex);
+	_job = nullptr;
+	_done.wait(lock, [&] { return job.active.load() == 0; });
+}
+
+void ThreadPool::_workerLoop() {
+	unsigned long seen = 0;
+	for (;;) {
+		Job* job;
+		int slot;
+		{
+			std::unique_lock<std::mutex> lock(_mutex);
+			_wake.wait(lock, [&] { return _stop || (_job && _generation != seen); });
+			if (_stop) return;
+			seen = _generation;
+			job = _job;
+			slot = job->joined.fetch_add(1) + 1; // the caller is slot 0
+			if (slot > job->max_workers) continue; // enough workers already
+			job->active.fetch_add(1);
+		}
+		_runIndices(*job, slot);
+		{
+			std::lock_guard<std::mutex> lock(_mutex);
+			job->active.fetch_sub(1);
+		}
+		_done.notify_all();
+	}
+}
+
+#endif
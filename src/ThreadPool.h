@@ -0,0 +1,92 @@
+#pragma once
+
+/**************************************************************************************************
+* @file  ThreadPool.h
+*
+* @brief (host only) a small fixed-size thread pool for data-parallel loops (parallelFor()).
+***************************************************************************************************/
+
+/*
+	parallelFor(n, func, ctx) calls func(i, ctx) for i = 0...n-1 across the pool's workers and the
+	calling thread, and returns once every call has finished. Indices are handed out one at a time
+	from a shared counter, so uneven work balances itself. A parallelFor() called from inside a
+	func runs serially on that thread rather than deadlocking.
+
+	parallelForStealing() is for many small, similar tasks where neighbouring indices share data
+	(e.g. tiles of a matrix): each thread starts on its own contiguous share of the indices, runs
+	them in order, and when it runs out steals the upper half of the largest share left, so threads
+	touch the shared counter's cache line only when balancing rather than once per index.
+
+	On Arduino (or wherever IS_HAS_THREADPOOL is 0) nothing here exists; callers fall back to a
+	plain loop.
+*/
+
+#if !defined(ARDUINO)
+
+#define IS_HAS_THREADPOOL 1
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <stdint.h>
+#include <thread>
+#include <vector>
+
+typedef void (*ParallelForFunc)(int i, void* ctx);
+
+class ThreadPool {
+ public:
+	/// @param n_threads (default=0) threads to run loops on, including the caller; 0 for one per hardware thread
+	explicit ThreadPool(int n_threads=0);
+	~ThreadPool();
+	ThreadPool(const ThreadPool&) = delete;
+	ThreadPool& operator=(const ThreadPool&) = delete;
+
+	/// @return int threads loops run on, including the calling thread
+	int threads() const { return (int)_workers.size() + 1; }
+
+	/**
+	 * @brief calls func(i, ctx) for i = 0...n-1 in parallel and waits for them all
+	 * @param max_threads (default=0) if >0, use at most this many threads (including the caller)
+	 */
+	void parallelFor(int n, ParallelForFunc func, void* ctx, int max_threads=0);
+
+	/**
+	 * @brief parallelFor() with work stealing: threads run contiguous runs of indices (see above)
+	 * @param max_threads (default=0) if >0, use at most this many threads (including the caller)
+	 */
+	void parallelForStealing(int n, ParallelForFunc func, void* ctx, int max_threads=0);
+
+	/// @return ThreadPool& a process-wide pool with one thread per hardware thread, created on first use
+	static ThreadPool& shared();
+
+	//**** internals *******************************************************
+
+	struct Job {
+		ParallelForFunc func = nullptr;
+		void* ctx = nullptr;
+		int n = 0;
+		int max_workers = 0;                // workers (not counting the caller) that may join
+		std::atomic<int> next{0};           // next index to hand out
+		std::atomic<int> joined{0};         // workers that have joined
+		std::atomic<int> active{0};         // workers still running indices
+		std::atomic<uint64_t>* ranges = nullptr; // parallelForStealing(): per thread (begin << 32 | end), caller's first
+	};
+
+	std::vector<std::thread> _workers;
+	std::mutex _mutex;                      // guards _job/_generation/_stop
+	std::condition_variable _wake;          // workers wait here for a job
+	std::condition_variable _done;          // the caller waits here for workers to finish
+	std::mutex _run_mutex;                  // one parallelFor() at a time
+	Job* _job = nullptr;
+	unsigned long _generation = 0;
+	bool _stop = false;
+
+	void _run(int n, ParallelForFunc func, void* ctx, int max_threads, bool stealing);
+	void _workerLoop();
+	static void _runIndices(Job& job, int slot);
+};
+
+#else
+#define IS_HAS_THREADPOOL 0
+#endif
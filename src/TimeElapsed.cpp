@@ -1,5 +1,21 @@
 #include "TimeElapsed.h"
 
+// the amount of time represented by n wraps of TimeElapsed_t (none if it is already 64 bits)
+static inline TimeElapsed64_t wrapsToTime(unsigned long n) {
+	return sizeof(TimeElapsed_t) < sizeof(TimeElapsed64_t) ? (TimeElapsed64_t)n << (4 * sizeof(TimeElapsed_t)) << (4 * sizeof(TimeElapsed_t)) : 0;
+}
+
+// tn, a read of the time function after prev: counts a wrap if it is more than half the clock's range
+// behind prev, and holds at prev if it is less (a passed-in "now" read a little before the last one,
+// e.g. by a caller sharing one reading between objects), so elapsed time never runs backwards
+static inline TimeElapsed_t advanceTo(TimeElapsed_t prev, TimeElapsed_t tn, unsigned long* wraps) {
+	if (tn >= prev) return tn;
+	if ((TimeElapsed_t)(prev - tn) > (TimeElapsed_t)~(TimeElapsed_t)0 / 2) {
+		++*wraps; // the time function wrapped
+		return tn;
+	}
+	return prev;
+}
 
 TimeElapsed::TimeElapsed(TimeElapsed_t start_now, TimeElapsed_t(*time_func)()): _time_func{time_func} {
 	if (start_now) clearAndStart(start_now);
@@ -10,6 +26,8 @@ void TimeElapsed::clearAndStart(TimeElapsed_t time_now) {
 	else _tn = (*_time_func)();
 	_t0 = _t1 = _tn;
 	_prev_elapsed = _tn_minus_t1 = _elapsed = _elapsed_overflows = 0;
+	_tn_wraps = _t1_wraps = 0;
+	_prev_elapsed64 = 0;
 	_state = STARTED;
 }
 
@@ -24,15 +42,18 @@ TimeElapsed_t TimeElapsed::elapsed(TimeElapsed_t update) {
 	TimeElapsed_t tn;
 	if (update > 1) tn = update;
 	else tn = (*_time_func)();
+	tn = advanceTo(_tn, tn, &_tn_wraps);
 
 	TimeElapsed_t tn_minus_t1 = tn - _t1;
 	TimeElapsed_t elapsed = tn_minus_t1 + _prev_elapsed;
 
-	if (elapsed < _elapsed) ++_elapsed_overflows; // this causes error
+	if (elapsed < _elapsed && !_extended) ++_elapsed_overflows; // this causes error
 	_tn = tn;
 	_tn_minus_t1 = tn_minus_t1;
 	_elapsed = elapsed;
-	return _elapsed_overflows ? 0 : _elapsed;
+	if (_elapsed_overflows) return 0;
+	if (_on_elapsed) _on_elapsed(_elapsed, _on_elapsed_ctx);
+	return _elapsed;
 }
 
 TimeElapsed_t TimeElapsed::pause(bool update) {
@@ -51,14 +72,20 @@ TimeElapsed_t TimeElapsed::resume(TimeElapsed_t time_now) {
 	if (_state != PAUSED) return 0;
 
 	// resume means we move all _tn_minus_t1 to _prev_elapsed
+	_prev_elapsed64 = elapsed64();
 	_prev_elapsed = _prev_elapsed + _tn_minus_t1;
 	_tn_minus_t1 = 0;
 	// NOTE: there is no way we just overflowed prev_elapsed because it is equal to
 	// _elapsed and we already check if _elapsed overflows every time it changes.
 
 	// and start a new span of time starting now:
-	if (time_now > 1) _t1 = _tn = time_now;
-	else _t1 = _tn = (*_time_func)();
+	TimeElapsed_t tn;
+	if (time_now > 1) tn = time_now;
+	else tn = (*_time_func)();
+	tn = advanceTo(_tn, tn, &_tn_wraps);
+	_t1 = _tn = tn;
+	_t1_wraps = _tn_wraps;
+	_state = RESUMED;
 
 	return _elapsed_overflows ? 0 : _elapsed;
 }
@@ -75,3 +102,23 @@ TimeElapsedState TimeElapsed::state() {
 unsigned short TimeElapsed::_elapsedOverflows() {
 	return _elapsed_overflows;
 }
+
+void TimeElapsed::setExtended(bool extended) {
+	_extended = extended;
+}
+
+TimeElapsed64_t TimeElapsed::elapsed64() {
+	if (_state == STOPPED) return 0;
+	// _tn - _t1 as 64 bits: whole wraps between them plus the (possibly negative) remainder
+	return _prev_elapsed64 + wrapsToTime(_tn_wraps - _t1_wraps) + _tn - _t1;
+}
+
+TimeElapsed64_t TimeElapsed::elapsedSinceStart64() {
+	if (_state == STOPPED) return 0;
+	return wrapsToTime(_tn_wraps) + _tn - _t0;
+}
+
+void TimeElapsed::setOnElapsed(void (*func)(TimeElapsed_t elapsed, void* ctx), void* ctx) {
+	_on_elapsed = func;
+	_on_elapsed_ctx = ctx;
+}
@@ -12,6 +12,8 @@
 typedef unsigned long TimeElapsed_t; ///< should match return of time function used by TimeElapsed (unsigned long for micros and millis)
 #endif
 
+typedef unsigned long long TimeElapsed64_t; ///< extended (epoch-counted) time, see TimeElapsed::setExtended()
+
 #include <Arduino.h>
 
 // do not change the order of these!:
@@ -46,6 +48,15 @@ class TimeElapsed {
 
 	unsigned short _elapsed_overflows = 0;
 
+	// extended (64-bit) timekeeping. See setExtended()
+	bool _extended = false;      // if true, elapsed() exceeding TimeElapsed_t is not an overflow error (use elapsed64())
+	unsigned long _tn_wraps = 0; // times the time function wrapped since start (_tn read more than half its range below before)
+	unsigned long _t1_wraps = 0; // _tn_wraps when _t1 was set
+	TimeElapsed64_t _prev_elapsed64 = 0; // 64-bit equivalent of _prev_elapsed
+
+	void (*_on_elapsed)(TimeElapsed_t elapsed, void* ctx) = nullptr; // see setOnElapsed()
+	void* _on_elapsed_ctx = nullptr;
+
 	/**
 	 * @brief constructs object to measure time intervals, with start/restart functionality, both via 
 	 * .clearAndStart(), as well as pause() and resume() methods.
@@ -130,5 +141,42 @@ class TimeElapsed {
 	TimeElapsedState state();
 
 	unsigned short _elapsedOverflows();
+
+	//**** extended (64-bit) timekeeping **********************************
+
+	/**
+	 * @brief in extended mode, wrapping of the time function (every ~71 minutes for micros()) is 
+	 * counted so that elapsed64() and elapsedSinceStart64() keep counting past what TimeElapsed_t 
+	 * holds, and elapsed() passing the size of TimeElapsed_t is no longer an overflow error (it just 
+	 * returns the low bits). Wraps are detected each time the time function is read (by elapsed(),
+	 * pause() or resume()) as a step back of more than half its range, so it must be read at least
+	 * once per half wrap period. A smaller step back (a passed-in "now" slightly older than the last
+	 * one) is not a wrap: it is taken as no time passing.
+	 * Wraps are counted whether or not extended mode is on, so it can be enabled at any time.
+	 * 
+	 * @param extended (default=true) true to enable extended mode, false for the default behavior */
+	void setExtended(bool extended=true);
+
+	/**
+	 * @return TimeElapsed64_t non-paused time elapsed until last checked (call elapsed() or 
+	 * pause() first to update it), or 0 if STOPPED. Valid whether or not extended mode is on, but 
+	 * only extended mode clears the overflow error when it passes the size of TimeElapsed_t. */
+	TimeElapsed64_t elapsed64();
+
+	/**
+	 * @return TimeElapsed64_t time elapsed since start until last checked, including time spent 
+	 * paused, or 0 if STOPPED. */
+	TimeElapsed64_t elapsedSinceStart64();
+
+	//**** hook ***********************************************************
+
+	/**
+	 * @brief has every new reading taken by elapsed() (one that calls the time function or is passed
+	 * "now", including via pause()) passed to func(elapsed, ctx) as well as returned, unless there was
+	 * an overflow error. E.g. LatencyHistogram::attach() uses this to record each reading.
+	 * 
+	 * @param func (default=nullptr) the function, or nullptr to stop calling one
+	 * @param ctx (default=nullptr) passed to func as is */
+	void setOnElapsed(void (*func)(TimeElapsed_t elapsed, void* ctx)=nullptr, void* ctx=nullptr);
 };
 
@@ -0,0 +1,173 @@
+#pragma once
+
+/**************************************************************************************************
+* @file  TimeElapsedClocks.h
+*
+* @brief (host only) high-resolution 64-bit nanosecond clock backends and ClockTimeElapsed, a
+* TimeElapsed that takes its clock as a template parameter so that reading it inlines.
+***************************************************************************************************/
+
+/*
+	A clock backend is any type with:
+		static uint64_t now(); // nanoseconds from an arbitrary, monotonic origin
+	Provided backends:
+		SteadyClock        std::chrono::steady_clock (portable)
+		MonotonicRawClock  clock_gettime(CLOCK_MONOTONIC_RAW) (Linux: not slewed by NTP)
+		TscClock           the x86 time stamp counter (rdtsc), scaled to ns (x86 with an invariant TSC)
+	clockCalibrate<Clock>() measures a backend's read overhead and resolution.
+
+	64-bit nanoseconds take 584 years to wrap, so unlike TimeElapsed there is no overflow tracking.
+*/
+
+#if !defined(ARDUINO)
+
+#include <stdint.h>
+#include <chrono>
+#include <time.h>
+#include "TimeElapsed.h" // for TimeElapsedState
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define TIMEELAPSED_HAS_TSC 1
+#endif
+
+struct SteadyClock {
+	static uint64_t now() {
+		return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+};
+
+#if defined(CLOCK_MONOTONIC_RAW)
+struct MonotonicRawClock {
+	static uint64_t now() {
+		struct timespec ts;
+		clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+		return (uint64_t)ts.tv_sec * 1000000000ull + ts.tv_nsec;
+	}
+};
+#endif
+
+#if defined(TIMEELAPSED_HAS_TSC)
+/**
+ * rdtsc counts cycles of a constant-rate reference clock (on CPUs with an invariant TSC). now()
+ * converts to ns with a 32.32 fixed-point multiplier measured once against SteadyClock (about 10ms,
+ * on the first call to now() or ticksToNs()), so each read costs rdtsc plus one multiply.
+ */
+struct TscClock {
+	static uint64_t ticks() { return __rdtsc(); }
+
+	/// @brief ns per tick in 32.32 fixed point
+	static uint64_t nsPerTickQ32() {
+		static const uint64_t q32 = measureNsPerTickQ32();
+		return q32;
+	}
+
+	static uint64_t ticksToNs(uint64_t ticks) {
+		return (uint64_t)(((unsigned __int128)ticks * nsPerTickQ32()) >> 32);
+	}
+
+	static uint64_t now() { return ticksToNs(ticks()); }
+
+	static uint64_t measureNsPerTickQ32() {
+		uint64_t ns0 = SteadyClock::now(), t0 = ticks();
+		while (SteadyClock::now() - ns0 < 10000000ull) {} // 10ms
+		uint64_t ns1 = SteadyClock::now(), t1 = ticks();
+		return (uint64_t)(((double)(ns1 - ns0) / (double)(t1 - t0)) * 4294967296.0);
+	}
+};
+#endif
+
+struct ClockCalibration {
+	double read_overhead_ns; ///< average cost of one now() call
+	uint64_t resolution_ns;  ///< smallest non-zero difference seen between consecutive now() calls
+	uint64_t zero_diffs;     ///< consecutive calls that returned the same value (a coarse clock has many)
+};
+
+/**
+ * @brief measures a clock backend's read overhead and resolution
+ * @param reads (default=100000) number of back to back now() calls to time
+ */
+template <typename Clock>
+ClockCalibration clockCalibrate(unsigned long reads=100000) {
+	ClockCalibration cal = {0, UINT64_MAX, 0};
+	Clock::now(); // warm-up: a first call may do one-time setup (TscClock calibrates itself)
+	uint64_t start = Clock::now(), prev = start;
+	for (unsigned long i = 0; i < reads; i++) {
+		uint64_t t = Clock::now();
+		uint64_t diff = t - prev;
+		if (diff == 0) ++cal.zero_diffs;
+		else if (diff < cal.resolution_ns) cal.resolution_ns = diff;
+		prev = t;
+	}
+	cal.read_overhead_ns = (double)(prev - start) / reads;
+	if (cal.resolution_ns == UINT64_MAX) cal.resolution_ns = 0;
+	return cal;
+}
+
+/**
+ * Same start/pause/resume/elapsed behavior as TimeElapsed, but in 64-bit nanoseconds from a clock
+ * chosen at compile time. "now" can still be passed in so several objects can share one clock
+ * read; since 0 and 1 are valid nanosecond times here, that is a separate overload rather than
+ * TimeElapsed's update > 1 convention.
+ *
+ * EXAMPLE: ClockTimeElapsed<TscClock> te(true); ... uint64_t ns = te.elapsed();
+ */
+template <typename Clock>
+class ClockTimeElapsed {
+ public:
+	TimeElapsedState _state = STOPPED;
+	uint64_t _t0 = 0;           // the start time
+	uint64_t _t1 = 0;           // the start or resume time, whichever is most recent
+	uint64_t _tn = 0;           // the most recently checked time
+	uint64_t _prev_elapsed = 0; // running time accumulated before the most recent resume
+	uint64_t _elapsed = 0;      // running time (excludes time spent paused)
+
+	ClockTimeElapsed(bool start_now=false) { if (start_now) clearAndStart(); }
+
+	void clearAndStart() { clearAndStartAt(Clock::now()); }
+
+	void clearAndStartAt(uint64_t time_now) {
+		_t0 = _t1 = _tn = time_now;
+		_prev_elapsed = _elapsed = 0;
+		_state = STARTED;
+	}
+
+	/// @return uint64_t non-paused ns elapsed until now (0 if STOPPED)
+	uint64_t elapsed() { return (_state >= STARTED) ? elapsedAt(Clock::now()) : elapsedPrev(); }
+
+	/// @return uint64_t non-paused ns elapsed until time_now (0 if STOPPED)
+	uint64_t elapsedAt(uint64_t time_now) {
+		if (_state < STARTED) return elapsedPrev();
+		_tn = time_now;
+		return _elapsed = _prev_elapsed + (_tn - _t1);
+	}
+
+	/// @return uint64_t non-paused ns elapsed until it was last checked (0 if STOPPED)
+	uint64_t elapsedPrev() const { return _state == STOPPED ? 0 : _elapsed; }
+
+	uint64_t pause() { return pauseAt(Clock::now()); }
+
+	uint64_t pauseAt(uint64_t time_now) {
+		if (_state < STARTED) return 0;
+		elapsedAt(time_now);
+		_state = PAUSED;
+		return _elapsed;
+	}
+
+	uint64_t resume() { return resumeAt(Clock::now()); }
+
+	uint64_t resumeAt(uint64_t time_now) {
+		if (_state != PAUSED) return 0;
+		_prev_elapsed = _elapsed;
+		_t1 = _tn = time_now;
+		_state = RESUMED;
+		return _elapsed;
+	}
+
+	/// @return uint64_t ns since start until last checked, including time spent paused
+	uint64_t elapsedSinceStart() const { return _state == STOPPED ? 0 : _tn - _t0; }
+
+	TimeElapsedState state() const { return _state; }
+};
+
+#endif // !defined(ARDUINO)
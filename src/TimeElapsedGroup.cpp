@@ -0,0 +1,54 @@
+#include "TimeElapsedGroup.h"
+
+TimeElapsedGroup::TimeElapsedGroup(TimeElapsed_t(*time_func)()): _time_func{time_func} {
+	_tn = (*_time_func)();
+}
+
+int TimeElapsedGroup::add(bool start_now) {
+	if (_n_timers >= TIMEELAPSEDGROUP_MAX) return -1;
+	int i = _n_timers++;
+	stop(i);
+	if (start_now) clearAndStart(i);
+	return i;
+}
+
+TimeElapsed_t TimeElapsedGroup::tick() {
+	tickAt((*_time_func)());
+	return _tn;
+}
+
+void TimeElapsedGroup::tickAt(TimeElapsed_t time_now) {
+	_tn = time_now;
+	int n = _n_timers;
+	for (int i = 0; i < n; i++) {
+		_elapsed[i] = _prev_elapsed[i] + ((time_now - _t1[i]) & _run_mask[i]);
+	}
+}
+
+void TimeElapsedGroup::clearAndStart(int i) {
+	_t0[i] = _t1[i] = _tn;
+	_prev_elapsed[i] = _elapsed[i] = 0;
+	_run_mask[i] = ~(TimeElapsed_t)0;
+	_state[i] = STARTED;
+}
+
+void TimeElapsedGroup::pause(int i) {
+	if (_state[i] < STARTED) return;
+	_elapsed[i] = _prev_elapsed[i] + (_tn - _t1[i]);
+	_prev_elapsed[i] = _elapsed[i]; // so tick() keeps returning it while paused
+	_run_mask[i] = 0;
+	_state[i] = PAUSED;
+}
+
+void TimeElapsedGroup::resume(int i) {
+	if (_state[i] != PAUSED) return;
+	_t1[i] = _tn;
+	_run_mask[i] = ~(TimeElapsed_t)0;
+	_state[i] = RESUMED;
+}
+
+void TimeElapsedGroup::stop(int i) {
+	_t0[i] = _t1[i] = _tn;
+	_prev_elapsed[i] = _elapsed[i] = _run_mask[i] = 0;
+	_state[i] = STOPPED;
+}
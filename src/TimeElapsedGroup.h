@@ -0,0 +1,88 @@
+#pragma once
+
+/**************************************************************************************************
+* @file  TimeElapsedGroup.h
+*
+* @brief TimeElapsedGroup holds many TimeElapsed-like timers that share one time function read per
+* tick() and are all updated in a single branch-free pass.
+***************************************************************************************************/
+
+#include "TimeElapsed.h"
+
+#ifndef TIMEELAPSEDGROUP_MAX
+#define TIMEELAPSEDGROUP_MAX 32 ///< number of timers a TimeElapsedGroup can hold
+#endif
+
+/**
+ * Each timer's state is kept in parallel arrays (structure of arrays) so tick() is one loop of
+ * elapsed[i] = prev_elapsed[i] + ((now - t1[i]) & run_mask[i]) that the compiler can vectorize,
+ * where run_mask is all ones for running timers and 0 for paused or stopped ones.
+ *
+ * State changes (clearAndStart(), pause(), resume()) use the group's time as of the last tick()
+ * (.now()) rather than reading the time function again, so every timer in the group agrees on
+ * "now" and the time function is called once per tick() no matter how many timers there are.
+ * Like TimeElapsed, a timer's elapsed time wraps once it passes the size of TimeElapsed_t
+ * (~71 minutes for micros()); unlike TimeElapsed that is not tracked.
+ */
+class TimeElapsedGroup {
+ public:
+	TimeElapsed_t (*_time_func)(); // time function is normally micros() or millis()
+	TimeElapsed_t _tn = 0;         // the group's "now": the time function's return at the last tick()
+	int _n_timers = 0;
+
+	// per timer:
+	TimeElapsed_t _t0[TIMEELAPSEDGROUP_MAX];           // start time
+	TimeElapsed_t _t1[TIMEELAPSEDGROUP_MAX];           // start or resume time, whichever is most recent
+	TimeElapsed_t _prev_elapsed[TIMEELAPSEDGROUP_MAX]; // running time accumulated before _t1
+	TimeElapsed_t _elapsed[TIMEELAPSEDGROUP_MAX];      // running time as of the last tick()
+	TimeElapsed_t _run_mask[TIMEELAPSEDGROUP_MAX];     // ~0 if running (STARTED or RESUMED), else 0
+	TimeElapsedState _state[TIMEELAPSEDGROUP_MAX];
+
+	/**
+	 * @param time_func (default=micros) is normally micros() or millis(). It is called once here
+	 * so that .now() is valid before the first tick().
+	 */
+	TimeElapsedGroup(TimeElapsed_t(*time_func)()=micros);
+
+	/**
+	 * @brief adds a timer to the group
+	 * @param start_now (default=false) if true, the timer is started at .now()
+	 * @return int the timer's index, or -1 if TIMEELAPSEDGROUP_MAX timers are already in the group
+	 */
+	int add(bool start_now=false);
+
+	/**
+	 * @brief reads the time function once and updates every running timer's elapsed time
+	 * @return TimeElapsed_t the time read (the new .now())
+	 */
+	TimeElapsed_t tick();
+
+	/**
+	 * @brief same as tick() but with "now" supplied by the caller (e.g. from a shared clock read
+	 * or a simulation). Any value is valid, unlike TimeElapsed's update > 1 convention.
+	 */
+	void tickAt(TimeElapsed_t time_now);
+
+	/// @return TimeElapsed_t the group's time as of the last tick()
+	TimeElapsed_t now() const { return _tn; }
+
+	/// @brief clears and starts a timer at .now()
+	void clearAndStart(int i);
+
+	/// @brief pauses a timer at .now(): its elapsed time stops growing until resume()
+	void pause(int i);
+
+	/// @brief resumes a paused timer at .now()
+	void resume(int i);
+
+	/// @brief stops a timer and zeroes its elapsed time
+	void stop(int i);
+
+	/// @return TimeElapsed_t a timer's running (non-paused) time as of the last tick() (or state change)
+	TimeElapsed_t elapsed(int i) const { return _elapsed[i]; }
+
+	/// @return TimeElapsed_t a timer's time since it was started, including time paused, as of .now()
+	TimeElapsed_t elapsedSinceStart(int i) const { return _state[i] == STOPPED ? 0 : _tn - _t0[i]; }
+
+	TimeElapsedState state(int i) const { return _state[i]; }
+};
@@ -0,0 +1,188 @@
+#include "approx.h"
+
+namespace is {
+
+static void setInterval(PolyApprox* out, double x_min, double x_max, int deg, ApproxErrorType error_type) {
+	out->deg = deg;
+	out->x_min = x_min;
+	out->x_max = x_max;
+	out->t_scale = 2 / (x_max - x_min);
+	out->t_offset = -(x_max + x_min) / (x_max - x_min);
+	out->error_type = error_type;
+}
+
+static double xOfT(const PolyApprox& a, double t) {
+	return (t - a.t_offset) / a.t_scale;
+}
+
+// signed error at x (relative errors are divided by |f(x)|)
+static double errorAt(ApproxFunc f, const PolyApprox& a, double x) {
+	double fx = f(x);
+	double e = a.eval(x) - fx;
+	return a.error_type == APPROX_RELATIVE ? e / fabs(fx) : e;
+}
+
+bool approxChebyshev(ApproxFunc f, double x_min, double x_max, int deg, PolyApprox* out, ApproxErrorType error_type) {
+	if (deg < 0 || deg > APPROX_MAX_DEG || !(x_max > x_min)) return false;
+	setInterval(out, x_min, x_max, deg, error_type);
+	int n = deg + 1;
+
+	// Chebyshev series coefficients from f at the n Chebyshev nodes
+	double fx[APPROX_MAX_DEG + 1], c[APPROX_MAX_DEG + 1];
+	for (int j = 0; j < n; j++) fx[j] = f(xOfT(*out, cos(M_PI * (j + 0.5) / n)));
+	for (int k = 0; k < n; k++) {
+		double s = 0;
+		for (int j = 0; j < n; j++) s += fx[j] * cos(M_PI * k * (j + 0.5) / n);
+		c[k] = (k == 0 ? 1.0 : 2.0) * s / n;
+	}
+
+	// to monomials in t: T_k+1 = 2t*T_k - T_k-1 (lowest power first)
+	double T_prev[APPROX_MAX_DEG + 1] = {0}, T_cur[APPROX_MAX_DEG + 1] = {0}, mono[APPROX_MAX_DEG + 1] = {0};
+	T_prev[0] = 1;
+	mono[0] = c[0];
+	if (deg >= 1) {
+		T_cur[1] = 1;
+		mono[1] += c[1];
+	}
+	for (int k = 2; k <= deg; k++) {
+		double T_next[APPROX_MAX_DEG + 1];
+		for (int i = 0; i <= deg; i++) T_next[i] = -T_prev[i] + (i > 0 ? 2 * T_cur[i - 1] : 0);
+		for (int i = 0; i <= deg; i++) {
+			T_prev[i] = T_cur[i];
+			T_cur[i] = T_next[i];
+			mono[i] += c[k] * T_next[i];
+		}
+	}
+	for (int i = 0; i <= deg; i++) out->coeffs[i] = mono[deg - i];
+	out->max_error = approxMaxError(f, *out);
+	return true;
+}
+
+// golden-section search for the largest |error| in t_lo...t_hi
+static double refineExtremum(ApproxFunc f, const PolyApprox& a, double t_lo, double t_hi, double* err) {
+	const double g = 0.6180339887498949;
+	double t1 = t_hi - g * (t_hi - t_lo), t2 = t_lo + g * (t_hi - t_lo);
+	double e1 = fabs(errorAt(f, a, xOfT(a, t1))), e2 = fabs(errorAt(f, a, xOfT(a, t2)));
+	for (int i = 0; i < 40; i++) {
+		if (e1 > e2) {
+			t_hi = t2; t2 = t1; e2 = e1;
+			t1 = t_hi - g * (t_hi - t_lo);
+			e1 = fabs(errorAt(f, a, xOfT(a, t1)));
+		} else {
+			t_lo = t1; t1 = t2; e1 = e2;
+			t2 = t_lo + g * (t_hi - t_lo);
+			e2 = fabs(errorAt(f, a, xOfT(a, t2)));
+		}
+	}
+	double t = (t_lo + t_hi) / 2;
+	*err = errorAt(f, a, xOfT(a, t));
+	return t;
+}
+
+double approxMaxError(ApproxFunc f, const PolyApprox& a, int checks, double* at_x) {
+	if (checks < 2) checks = 2;
+	int worst = 0;
+	double worst_err = -1;
+	for (int i = 0; i <= checks; i++) {
+		double e = fabs(errorAt(f, a, xOfT(a, -1 + 2.0 * i / checks)));
+		if (e > worst_err) { worst_err = e; worst = i; }
+	}
+	double t_lo = -1 + 2.0 * (worst > 0 ? worst - 1 : 0) / checks;
+	double t_hi = -1 + 2.0 * (worst < checks ? worst + 1 : checks) / checks;
+	double e;
+	double t = refineExtremum(f, a, t_lo, t_hi, &e);
+	if (fabs(e) < worst_err) { // the grid point itself was the worst (e.g. an end of the interval)
+		t = -1 + 2.0 * worst / checks;
+		e = worst_err;
+	}
+	if (at_x) *at_x = xOfT(a, t);
+	return fabs(e);
+}
+
+bool approxRemez(ApproxFunc f, double x_min, double x_max, int deg, PolyApprox* out, ApproxErrorType error_type, int max_iter) {
+	if (deg < 0 || deg > APPROX_MAX_DEG || !(x_max > x_min)) return false;
+	if (!approxChebyshev(f, x_min, x_max, deg, out, error_type)) return false;
+	const int m = deg + 2; // reference points: deg + 1 coefficients plus the levelled error E
+	double nodes[APPROX_MAX_DEG + 2];
+	for (int i = 0; i < m; i++) nodes[i] = -cos(M_PI * i / (m - 1)); // Chebyshev extrema, ascending
+
+	PolyApprox trial = *out;
+	double A_data[(APPROX_MAX_DEG + 2) * (APPROX_MAX_DEG + 2)], b[APPROX_MAX_DEG + 2], sol[APPROX_MAX_DEG + 2];
+	double* A[APPROX_MAX_DEG + 2];
+	const int grid = 64 * m;
+	for (int iter = 0; iter < max_iter; iter++) {
+		// solve p(t_i) + (-1)^i * E * w_i = f(x_i), w_i = 1 or |f(x_i)|
+		for (int i = 0; i < m; i++) {
+			A[i] = A_data + i * m;
+			double x = xOfT(trial, nodes[i]), fx = f(x), p = 1;
+			for (int j = 0; j <= deg; j++, p *= nodes[i]) A[i][j] = p;
+			A[i][m - 1] = (i % 2 ? -1 : 1) * (error_type == APPROX_RELATIVE ? fabs(fx) : 1);
+			b[i] = fx;
+		}
+		if (gaussianElimination(A, b, sol, m) != SOLVE_OK) return false;
+		for (int i = 0; i <= deg; i++) trial.coeffs[i] = sol[deg - i];
+
+		// new reference: the largest |error| in each run of one sign
+		double ref[APPROX_MAX_DEG + 2 + 64], ref_err[APPROX_MAX_DEG + 2 + 64];
+		int n_ref = 0, run_sign = 0, run_best = 0;
+		double run_best_err = 0;
+		for (int i = 0; i <= grid; i++) {
+			double t = -1 + 2.0 * i / grid;
+			double e = errorAt(f, trial, xOfT(trial, t));
+			int sign = e > 0 ? 1 : (e < 0 ? -1 : run_sign);
+			if (sign != run_sign && run_sign != 0) {
+				if (n_ref >= (int)(sizeof(ref) / sizeof(ref[0]))) break;
+				ref[n_ref] = -1 + 2.0 * run_best / grid;
+				ref_err[n_ref++] = run_best_err;
+				run_best_err = 0;
+			}
+			run_sign = sign;
+			if (fabs(e) >= fabs(run_best_err)) { run_best_err = e; run_best = i; }
+		}
+		if (n_ref < (int)(sizeof(ref) / sizeof(ref[0]))) {
+			ref[n_ref] = -1 + 2.0 * run_best / grid;
+			ref_err[n_ref++] = run_best_err;
+		}
+		if (n_ref < m) break; // the error no longer alternates enough: keep the best so far
+
+		// refine each extremum between its grid neighbours (the ends of -1...1 stay put)
+		for (int i = 0; i < n_ref; i++) {
+			double lo = ref[i] - 2.0 / grid, hi = ref[i] + 2.0 / grid;
+			if (lo < -1 || hi > 1) continue;
+			double e;
+			double t = refineExtremum(f, trial, lo, hi, &e);
+			if (fabs(e) > fabs(ref_err[i])) { ref[i] = t; ref_err[i] = e; }
+		}
+		// too many alternations: drop the smaller end until m remain
+		int first = 0;
+		while (n_ref - first > m) {
+			if (fabs(ref_err[first]) < fabs(ref_err[n_ref - 1])) first++;
+			else n_ref--;
+		}
+
+		double e_min = HUGE_VAL, e_max = 0;
+		for (int i = 0; i < m; i++) {
+			nodes[i] = ref[first + i];
+			double e = fabs(ref_err[first + i]);
+			if (e < e_min) e_min = e;
+			if (e > e_max) e_max = e;
+		}
+		trial.max_error = approxMaxError(f, trial);
+		if (trial.max_error <= out->max_error) *out = trial;
+		if (e_max - e_min <= 1e-3 * e_max) break; // equioscillating: minimax
+	}
+	return true;
+}
+
+int approxToError(ApproxFunc f, double x_min, double x_max, double max_error, PolyApprox* out,
+	ApproxMethod method, ApproxErrorType error_type, int max_deg) {
+	if (max_deg > APPROX_MAX_DEG) max_deg = APPROX_MAX_DEG;
+	for (int deg = 0; deg <= max_deg; deg++) {
+		bool ok = method == APPROX_REMEZ ? approxRemez(f, x_min, x_max, deg, out, error_type)
+			: approxChebyshev(f, x_min, x_max, deg, out, error_type);
+		if (ok && out->max_error <= max_error) return deg;
+	}
+	return -1;
+}
+
+} // end namespace
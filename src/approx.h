@@ -0,0 +1,241 @@
+#pragma once
+
+/**
+ * @file approx.h
+ * @brief polynomial approximation (Chebyshev and Remez minimax) of functions on an interval, and
+ * fast float exp/log built from generated minimax coefficients
+ */
+
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+#include "polynomial.h"
+
+/*
+	An approximation is a polynomial in t = x * t_scale + t_offset, where t runs over -1...1 as x
+	runs over the interval (which keeps the coefficients well conditioned). Coefficients are highest
+	power first and are evaluated with is::polyval(), so generated tables can be pasted anywhere
+	polyval is available.
+
+	approxChebyshev() interpolates at the Chebyshev nodes: cheap, and within a small factor of the
+	best possible error. approxRemez() iterates to the minimax (equiripple) polynomial. Both report the
+	maximum error measured on a dense grid that is then refined around the worst point; for smooth
+	functions that is the true maximum to a few digits. approxToError() raises the degree until a
+	target error is met. tools/approxgen.cpp prints the results as C arrays.
+
+	chebyshevApprox<DEG>() does the Chebyshev fit at compile time (C++14 constexpr, and C++17 for
+	lambdas), for functions that can themselves be evaluated in a constant expression.
+*/
+
+#ifndef APPROX_MAX_DEG
+#define APPROX_MAX_DEG 16
+#endif
+
+namespace is {
+
+typedef double (*ApproxFunc)(double x);
+
+enum ApproxErrorType {
+	APPROX_ABSOLUTE,  ///< |p(x) - f(x)|
+	APPROX_RELATIVE   ///< |p(x) - f(x)| / |f(x)| (f must not be 0 in the interval)
+};
+
+enum ApproxMethod {
+	APPROX_CHEBYSHEV,
+	APPROX_REMEZ
+};
+
+struct PolyApprox {
+	int deg = 0;
+	double coeffs[APPROX_MAX_DEG + 1] = {0}; ///< highest power first, in t
+	double t_scale = 1;                      ///< t = x * t_scale + t_offset
+	double t_offset = 0;
+	double x_min = -1;
+	double x_max = 1;
+	ApproxErrorType error_type = APPROX_ABSOLUTE;
+	double max_error = 0;                    ///< measured over x_min...x_max, of error_type
+
+	double eval(double x) const { return polyval(coeffs, deg, x * t_scale + t_offset); }
+};
+
+/**
+ * @brief Chebyshev interpolation of f on x_min...x_max
+ * @return bool false if deg is outside 0...APPROX_MAX_DEG or x_max <= x_min
+ */
+bool approxChebyshev(ApproxFunc f, double x_min, double x_max, int deg, PolyApprox* out, ApproxErrorType error_type=APPROX_ABSOLUTE);
+
+/**
+ * @brief minimax polynomial of f on x_min...x_max by the Remez exchange algorithm, starting from
+ * the Chebyshev extrema
+ * @param max_iter (default=40) exchange iterations; it stops early once the error equioscillates
+ * to 0.1%
+ * @return bool false for invalid arguments or if the exchange broke down (out then holds the last
+ * good iterate)
+ */
+bool approxRemez(ApproxFunc f, double x_min, double x_max, int deg, PolyApprox* out, ApproxErrorType error_type=APPROX_ABSOLUTE, int max_iter=40);
+
+/**
+ * @brief the lowest-degree approximation whose measured error is <= max_error
+ * @return int its degree, or -1 if even APPROX_MAX_DEG (or max_deg) isn't enough (out then holds max_deg)
+ */
+int approxToError(ApproxFunc f, double x_min, double x_max, double max_error, PolyApprox* out,
+	ApproxMethod method=APPROX_REMEZ, ApproxErrorType error_type=APPROX_ABSOLUTE, int max_deg=APPROX_MAX_DEG);
+
+/**
+ * @brief the largest error of approx against f over its interval: the worst of checks evenly
+ * spaced points, refined by golden-section search between its neighbours
+ * @param at_x (default=nullptr) if not null, receives where it occurs
+ */
+double approxMaxError(ApproxFunc f, const PolyApprox& approx, int checks=8192, double* at_x=nullptr);
+
+//**** compile-time Chebyshev **********************************************
+
+#if __cplusplus >= 201402L
+
+/// @brief cos(x) in a constant expression (Taylor series after reduction to -pi...pi; ~1e-16)
+constexpr double constexprCos(double x) {
+	const double pi = 3.14159265358979323846;
+	while (x > pi) x -= 2 * pi;
+	while (x < -pi) x += 2 * pi;
+	double term = 1, sum = 1;
+	for (int k = 1; k < 30; k++) {
+		term *= -x * x / ((2 * k - 1) * (2 * k));
+		sum += term;
+	}
+	return sum;
+}
+
+template <int DEG>
+struct ChebyshevApprox {
+	double coeffs[DEG + 1] = {0}; ///< highest power first, in t = x * t_scale + t_offset
+	double t_scale = 1;
+	double t_offset = 0;
+
+	constexpr double eval(double x) const { return polyval(coeffs, DEG, x * t_scale + t_offset); }
+};
+
+/**
+ * @brief Chebyshev interpolation of f on x_min...x_max at compile time, e.g.
+ *     constexpr auto curve = is::chebyshevApprox<5>([](double v) { return 1 + v * (0.5 + v); }, 0.0, 5.0);
+ * f must be usable in a constant expression. Check the error at run time with approxMaxError()-style
+ * sampling (or generate with tools/approxgen, which reports it).
+ */
+template <int DEG, typename F>
+constexpr ChebyshevApprox<DEG> chebyshevApprox(F f, double x_min, double x_max) {
+	const double pi = 3.14159265358979323846;
+	const int n = DEG + 1;
+	ChebyshevApprox<DEG> out;
+	out.t_scale = 2 / (x_max - x_min);
+	out.t_offset = -(x_max + x_min) / (x_max - x_min);
+
+	// Chebyshev series coefficients c[k] from f at the n Chebyshev nodes
+	double fx[DEG + 1] = {0}, c[DEG + 1] = {0};
+	for (int j = 0; j < n; j++) {
+		double t = constexprCos(pi * (j + 0.5) / n);
+		fx[j] = f((t - out.t_offset) / out.t_scale);
+	}
+	for (int k = 0; k < n; k++) {
+		double s = 0;
+		for (int j = 0; j < n; j++) s += fx[j] * constexprCos(pi * k * (j + 0.5) / n);
+		c[k] = (k == 0 ? 1.0 : 2.0) * s / n;
+	}
+
+	// sum c[k] * T_k(t) as monomials in t, with T_k+1 = 2t*T_k - T_k-1 (lowest power first)
+	double T_prev[DEG + 1] = {0}, T_cur[DEG + 1] = {0}, mono[DEG + 1] = {0};
+	T_prev[0] = 1;
+	mono[0] = c[0];
+	if (DEG >= 1) {
+		T_cur[1] = 1;
+		mono[1] += c[1];
+	}
+	for (int k = 2; k <= DEG; k++) {
+		double T_next[DEG + 1] = {0};
+		for (int i = 0; i <= DEG; i++) {
+			T_next[i] = -T_prev[i] + (i > 0 ? 2 * T_cur[i - 1] : 0);
+		}
+		for (int i = 0; i <= DEG; i++) {
+			T_prev[i] = T_cur[i];
+			T_cur[i] = T_next[i];
+			mono[i] += c[k] * T_next[i];
+		}
+	}
+	for (int i = 0; i <= DEG; i++) out.coeffs[i] = mono[DEG - i];
+	return out;
+}
+
+#endif
+
+} // end namespace
+
+//**** fast float exp/log ***************************************************
+
+#include "approx_coeffs.h"
+
+/*
+	The ...With() functions take the polynomial as arguments so that tools/approxgen.cpp can measure
+	the errors of new coefficients exactly as the library evaluates them; everything else calls
+	expApprox(), expApproxCore() and logApprox(), which pass the approx_coeffs.h ones.
+*/
+
+/// @brief expApproxCore() with the polynomial for e^r given (see approx_coeffs.h)
+inline float expApproxCoreWith(float x, const float* coeffs, int deg, float t_scale, float t_offset) {
+	float kf = x * 1.44269504f;
+	int k = (int)(kf + (kf < 0 ? -0.5f : 0.5f)); // round to nearest
+	float r = (x - k * 0.693145752f) - k * 1.42860677e-6f; // ln(2) in two parts so r stays exact
+	float p = is::polyval(coeffs, deg, r * t_scale + t_offset);
+	uint32_t bits = (uint32_t)(k + 127) << 23; // 2^k built directly (k is -126...127 here): cheaper than ldexpf
+	float scale;
+	memcpy(&scale, &bits, sizeof(scale));
+	return p * scale;
+}
+
+/// @brief expApprox() with the polynomial for e^r given (see approx_coeffs.h)
+inline float expApproxWith(float x, const float* coeffs, int deg, float t_scale, float t_offset) {
+	if (x > 88.7f) return INFINITY;
+	if (x < -87.3f) return 0;
+	if (x > 88.0f) { // 2^k would overflow: e^x = e^(x - ln(2)'s high part, exact) * 2e^-(its low part)
+		return expApproxCoreWith(x - 0.693145752f, coeffs, deg, t_scale, t_offset) * 1.99999714f;
+	}
+	return expApproxCoreWith(x, coeffs, deg, t_scale, t_offset);
+}
+
+/// @brief logApprox() with the polynomial for ln(m) given (see approx_coeffs.h)
+inline float logApproxWith(float x, const float* coeffs, int deg, float t_scale, float t_offset) {
+	if (!(x > 0)) return x == 0 ? -INFINITY : NAN;
+	if (x == INFINITY) return x;
+	int e;
+	float m = frexpf(x, &e);
+	if (m < 0.707106781f) {
+		m *= 2;
+		e--;
+	}
+	return e * 0.693147181f + is::polyval(coeffs, deg, m * t_scale + t_offset);
+}
+
+/**
+ * @brief expApprox() without its range checks, for -87.3 <= x <= 88: no branches, so loops over
+ * arrays of it vectorize (see sigmoidBlock())
+ */
+inline float expApproxCore(float x) {
+	return expApproxCoreWith(x, approx_exp_coeffs, APPROX_EXP_DEG, APPROX_EXP_T_SCALE, APPROX_EXP_T_OFFSET);
+}
+
+/**
+ * @brief exp(x) for float: exp(x) = 2^k * exp(r) with r = x - k*ln(2) in -ln(2)/2...ln(2)/2, and
+ * exp(r) from a generated minimax polynomial. Relative error under APPROX_EXP_MAX_ERROR (measured
+ * in float by approxgen) wherever the result is a normal float. Much smaller and faster than
+ * libm's exp on an AVR.
+ */
+inline float expApprox(float x) {
+	return expApproxWith(x, approx_exp_coeffs, APPROX_EXP_DEG, APPROX_EXP_T_SCALE, APPROX_EXP_T_OFFSET);
+}
+
+/**
+ * @brief natural log for float: ln(m * 2^e) = e*ln(2) + ln(m) with m in sqrt(1/2)...sqrt(2), and
+ * ln(m) from a generated minimax polynomial. Error under APPROX_LOG_MAX_ERROR (measured in float by
+ * approxgen): absolute for x in 1/e...e, relative to ln(x) outside it, where the float rounding of
+ * e*ln(2) dominates. Returns -INFINITY for 0 and NAN for negative x.
+ */
+inline float logApprox(float x) {
+	return logApproxWith(x, approx_log_coeffs, APPROX_LOG_DEG, APPROX_LOG_T_SCALE, APPROX_LOG_T_OFFSET);
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+// Generated by tools/approxgen.cpp (approxgen --library): minimax coefficients for expApprox() and
+// logApprox() in approx.h. Regenerate rather than edit. The MAX_ERRORs are measured in float, through
+// approx.h's own code, over each function's whole range (see approxgen.cpp).
+
+// expApprox(): max relative error APPROX_EXP_MAX_ERROR where e^x is a normal float
+// e^r on [-0.34657359, 0.34657359]: degree 6 minimax, max relative error 1.86e-09 in double
+#define APPROX_EXP_DEG 6
+#define APPROX_EXP_T_SCALE 2.88539004f
+#define APPROX_EXP_T_OFFSET 0.0f
+#define APPROX_EXP_MAX_ERROR 1.4e-07
+static const float approx_exp_coeffs[APPROX_EXP_DEG + 1] = {2.39778296e-06f, 4.18747841e-05f, 0.000601155567f, 0.0069379108f, 0.0600566156f, 0.346573591f, 1.0f};
+
+// logApprox(): max error APPROX_LOG_MAX_ERROR, absolute for x in 1/e...e, relative to ln(x) outside it
+// ln(m) on [0.707106781, 1.41421356]: degree 8 minimax, max absolute error 2.93e-08 in double
+#define APPROX_LOG_DEG 8
+#define APPROX_LOG_T_SCALE 2.82842708f
+#define APPROX_LOG_T_OFFSET -3.0f
+#define APPROX_LOG_MAX_ERROR 2e-07
+static const float approx_log_coeffs[APPROX_LOG_DEG + 1] = {-2.4609235e-05f, 8.00303824e-05f, -0.000222876479f, 0.000811478239f, -0.00308882631f, 0.0123489695f, -0.0555551983f, 0.333333075f, 0.0588915087f};
+
+// max absolute errors of pcnt01OfnTauFast() for ntau >= 0 and nTauOfPcnt01Fast() for pcnt01 in 0...0.999 (rc.h)
+#define APPROX_PCNT01OFNTAU_MAX_ERROR 8.1e-08
+#define APPROX_NTAUOFPCNT01_MAX_ERROR 3.8e-07
+// max absolute errors of sigmoidFast() and sigmoid_n1_p1Fast() (sigmoid.h)
+#define APPROX_SIGMOID_MAX_ERROR 9e-08
+#define APPROX_SIGMOID_N1_P1_MAX_ERROR 1.8e-07
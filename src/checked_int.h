@@ -0,0 +1,226 @@
+#pragma once
+
+/**
+ * @file checked_int.h
+ * @brief overflow-checked and saturating integer arithmetic (add, sub, mul, left shift) for every
+ * integer width, and saturating block operations for ADC/DAC code math
+ */
+
+#include <stdint.h>
+
+/*
+	addOverflow(a, b, &r) and friends return true if the true result doesn't fit in T, and store the
+	result wrapped to T either way (like GCC/clang's __builtin_*_overflow, which they use where
+	available; the portable fallback compares against the limits first). satAdd(a, b) and friends
+	return the true result clamped to T's range instead. safeToAdd(a, b) etc only answer whether the
+	operation would fit.
+
+	All operands are one type T, so there are no surprises from mixed signed/unsigned promotion:
+	satAdd<uint8_t>(200, 100) is 255 and satSub<uint16_t>(3, 5) is 0.
+
+	The block functions (satAddBlock(), satSubBlock(), satScaleBlock()) are for 8- and 16-bit data
+	such as ADC samples and DAC codes. They compute in 32 bits, where nothing can overflow, clamp
+	with selects rather than branches (so the loops vectorize on hosts) and return how many elements
+	were clamped: callers can clamp and carry on, or treat a non-zero count as an error.
+*/
+
+#ifndef IS_HAS_OVERFLOW_BUILTINS
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_add_overflow) && __has_builtin(__builtin_sub_overflow) && __has_builtin(__builtin_mul_overflow)
+#define IS_HAS_OVERFLOW_BUILTINS 1
+#endif
+#endif
+#if !defined(IS_HAS_OVERFLOW_BUILTINS) && defined(__GNUC__) && __GNUC__ >= 5
+#define IS_HAS_OVERFLOW_BUILTINS 1 ///< 1 to use __builtin_*_overflow, 0 for the portable comparisons
+#endif
+#ifndef IS_HAS_OVERFLOW_BUILTINS
+#define IS_HAS_OVERFLOW_BUILTINS 0
+#endif
+#endif
+
+namespace is {
+
+/// @brief the range of integer type T (avr-gcc has no <limits>)
+template <typename T>
+struct IntLimits {
+	static constexpr bool isSigned() { return (T)(-1) < (T)0; }
+	static constexpr T max() { return isSigned() ? (T)((((T)1 << (sizeof(T) * 8 - 2)) - 1) * 2 + 1) : (T)~(T)0; }
+	static constexpr T min() { return isSigned() ? (T)(-max() - 1) : (T)0; }
+	static constexpr int bits() { return sizeof(T) * 8; }
+};
+
+//**** checked operations **************************************************************************
+
+/// @return bool true if a + b overflows T; *result is a + b wrapped to T either way
+template <typename T>
+inline bool addOverflow(T a, T b, T* result) {
+#if IS_HAS_OVERFLOW_BUILTINS
+	return __builtin_add_overflow(a, b, result);
+#else
+	*result = (T)((unsigned long long)a + (unsigned long long)b);
+	if (IntLimits<T>::isSigned()) return b > 0 ? a > IntLimits<T>::max() - b : a < IntLimits<T>::min() - b;
+	return a > IntLimits<T>::max() - b;
+#endif
+}
+
+/// @return bool true if a - b overflows T; *result is a - b wrapped to T either way
+template <typename T>
+inline bool subOverflow(T a, T b, T* result) {
+#if IS_HAS_OVERFLOW_BUILTINS
+	return __builtin_sub_overflow(a, b, result);
+#else
+	*result = (T)((unsigned long long)a - (unsigned long long)b);
+	if (IntLimits<T>::isSigned()) return b < 0 ? a > IntLimits<T>::max() + b : a < IntLimits<T>::min() + b;
+	return a < b;
+#endif
+}
+
+/// @return bool true if a * b overflows T; *result is a * b wrapped to T either way
+template <typename T>
+inline bool mulOverflow(T a, T b, T* result) {
+#if IS_HAS_OVERFLOW_BUILTINS
+	return __builtin_mul_overflow(a, b, result);
+#else
+	*result = (T)((unsigned long long)a * (unsigned long long)b);
+	if (a == 0 || b == 0) return false;
+	if (!IntLimits<T>::isSigned()) return a > IntLimits<T>::max() / b;
+	if (a > 0) return b > 0 ? a > IntLimits<T>::max() / b : b < IntLimits<T>::min() / a;
+	return b > 0 ? a < IntLimits<T>::min() / b : a < IntLimits<T>::max() / b;
+#endif
+}
+
+/**
+ * @return bool true if a << shift overflows T (bits other than copies of the sign bit are shifted
+ * out, or shift >= the width of T with a != 0); *result is a << shift wrapped to T either way
+ * (0 if shift >= the width). shift must not be negative.
+ */
+template <typename T>
+inline bool shlOverflow(T a, int shift, T* result) {
+	if (shift >= IntLimits<T>::bits()) {
+		*result = 0;
+		return a != 0;
+	}
+	T r = (T)((unsigned long long)a << shift);
+	*result = r;
+	return (T)(r >> shift) != a;
+}
+
+/// @return bool true if a + b fits in T (replaces safeToAddUInt()/safeToAddInt())
+template <typename T>
+inline bool safeToAdd(T a, T b) { T r; return !addOverflow(a, b, &r); }
+
+/// @return bool true if a - b fits in T
+template <typename T>
+inline bool safeToSub(T a, T b) { T r; return !subOverflow(a, b, &r); }
+
+/// @return bool true if a * b fits in T
+template <typename T>
+inline bool safeToMul(T a, T b) { T r; return !mulOverflow(a, b, &r); }
+
+/// @return bool true if a << shift fits in T
+template <typename T>
+inline bool safeToShl(T a, int shift) { T r; return !shlOverflow(a, shift, &r); }
+
+//**** saturating operations ***********************************************************************
+
+/// @return T a + b, clamped to T's range
+template <typename T>
+inline T satAdd(T a, T b) {
+	T r;
+	bool overflow = addOverflow(a, b, &r);
+	T limit = IntLimits<T>::isSigned() && a < 0 ? IntLimits<T>::min() : IntLimits<T>::max();
+	return overflow ? limit : r;
+}
+
+/// @return T a - b, clamped to T's range
+template <typename T>
+inline T satSub(T a, T b) {
+	T r;
+	bool overflow = subOverflow(a, b, &r);
+	T limit = !IntLimits<T>::isSigned() || a < 0 ? IntLimits<T>::min() : IntLimits<T>::max();
+	return overflow ? limit : r;
+}
+
+/// @return T a * b, clamped to T's range
+template <typename T>
+inline T satMul(T a, T b) {
+	T r;
+	bool overflow = mulOverflow(a, b, &r);
+	T limit = IntLimits<T>::isSigned() && (a < 0) != (b < 0) ? IntLimits<T>::min() : IntLimits<T>::max();
+	return overflow ? limit : r;
+}
+
+/// @return T a << shift, clamped to T's range
+template <typename T>
+inline T satShl(T a, int shift) {
+	T r;
+	bool overflow = shlOverflow(a, shift, &r);
+	T limit = IntLimits<T>::isSigned() && a < 0 ? IntLimits<T>::min() : IntLimits<T>::max();
+	return overflow ? limit : r;
+}
+
+//**** saturating blocks (8- and 16-bit) ***********************************************************
+
+/**
+ * @brief out[i] = a[i] + b[i], clamped to T's range. out may be a or b.
+ * @return int the number of elements that were clamped
+ */
+template <typename T>
+inline int satAddBlock(const T* a, const T* b, T* out, int n) {
+	static_assert(sizeof(T) <= 2, "satAddBlock() is for 8- and 16-bit types");
+	const int32_t lo = IntLimits<T>::min(), hi = IntLimits<T>::max();
+	int clamped = 0;
+	for (int i = 0; i < n; i++) {
+		int32_t v = (int32_t)a[i] + b[i];
+		int32_t c = v < lo ? lo : (v > hi ? hi : v);
+		clamped += c != v;
+		out[i] = (T)c;
+	}
+	return clamped;
+}
+
+/**
+ * @brief out[i] = a[i] - b[i], clamped to T's range. out may be a or b.
+ * @return int the number of elements that were clamped
+ */
+template <typename T>
+inline int satSubBlock(const T* a, const T* b, T* out, int n) {
+	static_assert(sizeof(T) <= 2, "satSubBlock() is for 8- and 16-bit types");
+	const int32_t lo = IntLimits<T>::min(), hi = IntLimits<T>::max();
+	int clamped = 0;
+	for (int i = 0; i < n; i++) {
+		int32_t v = (int32_t)a[i] - b[i];
+		int32_t c = v < lo ? lo : (v > hi ? hi : v);
+		clamped += c != v;
+		out[i] = (T)c;
+	}
+	return clamped;
+}
+
+/**
+ * @brief fixed-point gain and offset: out[i] = round(x[i] * gain / 2^shift) + offset, clamped to
+ * lo...hi (e.g. a calibrated ADC reading to a 0...4095 DAC code). out may be x.
+ *
+ * @param gain the gain in Q(shift) fixed point, e.g. 0.75 is 24576 with shift 15
+ * @param shift 0...15
+ * @param lo (default=T's minimum) lowest allowed result
+ * @param hi (default=T's maximum) highest allowed result
+ * @return int the number of elements that were clamped
+ */
+template <typename T>
+inline int satScaleBlock(const T* x, T* out, int n, int16_t gain, int shift, int16_t offset,
+	T lo=IntLimits<T>::min(), T hi=IntLimits<T>::max()) {
+	static_assert(sizeof(T) <= 2, "satScaleBlock() is for 8- and 16-bit types");
+	// |x * gain| <= 65535 * 32768 and offset is 16-bit, so no step below leaves int32_t
+	const int32_t round = shift > 0 ? (int32_t)1 << (shift - 1) : 0, lo32 = lo, hi32 = hi;
+	int clamped = 0;
+	for (int i = 0; i < n; i++) {
+		int32_t v = (((int32_t)x[i] * gain + round) >> shift) + offset;
+		int32_t c = v < lo32 ? lo32 : (v > hi32 ? hi32 : v);
+		clamped += c != v;
+		out[i] = (T)c;
+	}
+	return clamped;
+}
+
+} // end namespace
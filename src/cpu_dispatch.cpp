@@ -0,0 +1,93 @@
+#include "cpu_dispatch.h"
+
+#if IS_HAS_CPU_DISPATCH
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <atomic>
+#include "cpu_kernels.h"
+
+// each level's kernels: the cpu_kernels.h templates compiled for its instruction set and vector width
+#define IS_TARGET(isa) __attribute__((target(isa)))
+#define IS_CPU_VARIANT(name, level, target_attr, doubles, floats) \
+	target_attr static void multiplyMatrices_##name(double** A, double** B, double** C, int n, int m, int p) { \
+		is::multiplyMatricesKernel(A, B, C, n, m, p); \
+	} \
+	target_attr static void powerSums_##name(const double* x, const double* w, const double* robust_w, int size, int n_sums, double* S) { \
+		is::powerSumsKernel<doubles>(x, w, robust_w, size, n_sums, S); \
+	} \
+	target_attr static void sigmoidBlock_##name(const float* x, float* y, int n, float x0, float steepness) { \
+		is::sigmoidBlockKernel(x, y, n, x0, steepness); \
+	} \
+	target_attr static void blockMoments_##name(const float* values, int n, float* mean, float* m2) { \
+		is::blockMomentsKernel<floats>(values, n, mean, m2); \
+	} \
+	static const CpuKernels kernels_##name = {level, multiplyMatrices_##name, powerSums_##name, sigmoidBlock_##name, blockMoments_##name};
+
+IS_CPU_VARIANT(generic, CPU_DISPATCH_GENERIC, , IS_KERNEL_LANES, 2 * IS_KERNEL_LANES)
+
+// SSE4.2 has the baseline's 128-bit registers and nothing new for the double kernels or
+// blockMoments (they compile to the same code, and two vector pairs per step instead spill
+// accumulators and run slower), so this level shares generic's. Its one gain is sigmoidBlock,
+// where blendvps replaces the and/andnot/or selects of the vectorized expApproxCore().
+IS_TARGET("sse4.2") static void sigmoidBlock_sse42(const float* x, float* y, int n, float x0, float steepness) {
+	is::sigmoidBlockKernel(x, y, n, x0, steepness);
+}
+static const CpuKernels kernels_sse42 = {CPU_DISPATCH_SSE42, multiplyMatrices_generic, powerSums_generic, sigmoidBlock_sse42, blockMoments_generic};
+
+IS_CPU_VARIANT(avx2, CPU_DISPATCH_AVX2, IS_TARGET("avx2,fma"), 4, 8)
+IS_CPU_VARIANT(avx512, CPU_DISPATCH_AVX512, IS_TARGET("avx512f,avx512vl,avx512dq,avx512bw,avx2,fma,prefer-vector-width=512"), 8, 16)
+
+static const CpuKernels* const g_tables[CPU_DISPATCH_LEVELS] = {&kernels_generic, &kernels_sse42, &kernels_avx2, &kernels_avx512};
+static const char* const g_names[CPU_DISPATCH_LEVELS] = {"generic", "sse4.2", "avx2", "avx512"};
+
+static std::atomic<const CpuKernels*> g_kernels{nullptr};
+
+const char* cpuDispatchName(CpuDispatchLevel level) {
+	return level >= 0 && level < CPU_DISPATCH_LEVELS ? g_names[level] : "?";
+}
+
+CpuDispatchLevel cpuDispatchDetected() {
+	__builtin_cpu_init();
+	if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512vl") && __builtin_cpu_supports("avx512dq")
+		&& __builtin_cpu_supports("avx512bw")) return CPU_DISPATCH_AVX512;
+	if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) return CPU_DISPATCH_AVX2;
+	if (__builtin_cpu_supports("sse4.2")) return CPU_DISPATCH_SSE42;
+	return CPU_DISPATCH_GENERIC;
+}
+
+// the detected level, capped by $IS_EEMATH_CPU; logged once
+static const CpuKernels* initialKernels() {
+	CpuDispatchLevel detected = cpuDispatchDetected(), level = detected;
+	const char* env = getenv("IS_EEMATH_CPU");
+	if (env && *env) {
+		int wanted = -1;
+		for (int l = 0; l < CPU_DISPATCH_LEVELS; l++) if (!strcmp(env, g_names[l])) wanted = l;
+		if (wanted < 0) fprintf(stderr, "is_eeMath: IS_EEMATH_CPU=%s not recognized (generic, sse4.2, avx2 or avx512)\n", env);
+		else if (wanted > detected) fprintf(stderr, "is_eeMath: IS_EEMATH_CPU=%s not supported by this CPU\n", env);
+		else level = (CpuDispatchLevel)wanted;
+	}
+	fprintf(stderr, "is_eeMath: cpu kernels %s (detected %s)\n", g_names[level], g_names[detected]);
+	return g_tables[level];
+}
+
+const CpuKernels& cpuKernels() {
+	const CpuKernels* k = g_kernels.load(std::memory_order_acquire);
+	if (!k) {
+		static const CpuKernels* initial = initialKernels(); // once, even if threads race here
+		const CpuKernels* expected = nullptr;
+		g_kernels.compare_exchange_strong(expected, initial, std::memory_order_acq_rel);
+		k = g_kernels.load(std::memory_order_acquire);
+	}
+	return *k;
+}
+
+bool cpuDispatchSet(CpuDispatchLevel level) {
+	if (level < 0 || level >= CPU_DISPATCH_LEVELS || level > cpuDispatchDetected()) return false;
+	cpuKernels(); // so the first-use selection can't overwrite this later
+	g_kernels.store(g_tables[level], std::memory_order_release);
+	return true;
+}
+
+#endif
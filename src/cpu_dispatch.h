@@ -0,0 +1,61 @@
+#pragma once
+
+/**************************************************************************************************
+* @file  cpu_dispatch.h
+*
+* @brief (x86 hosts only) picks SSE4.2, AVX2 or AVX-512 builds of the cpu_kernels.h kernels at run
+* time, so one binary runs the best variant on every machine of a mixed fleet.
+***************************************************************************************************/
+
+/*
+	The first call to cpuKernels() (made by the first multiplyMatrices(), polyfit, sigmoidBlock() or
+	WelfordOnlineStats::updateBlock()) detects the CPU's features and binds the table of kernel
+	function pointers for the best level it supports, then logs the choice once to stderr, e.g.
+	"is_eeMath: cpu kernels avx2 (detected avx512)". Setting the environment variable
+	IS_EEMATH_CPU to generic, sse4.2, avx2 or avx512 caps the level (for benchmarking or to rule a
+	variant out); cpuDispatchSet() does the same from code. Calls after that go straight through the
+	table: one indirect call per kernel invocation, not per element.
+
+	Elsewhere (Arduino, other architectures, compilers without GCC's target attribute)
+	IS_HAS_CPU_DISPATCH is 0 and the library calls the generic kernels directly.
+*/
+
+#if !defined(ARDUINO) && (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+
+#define IS_HAS_CPU_DISPATCH 1
+
+enum CpuDispatchLevel {
+	CPU_DISPATCH_GENERIC = 0,  ///< the compiler's baseline (SSE2 on x86-64)
+	CPU_DISPATCH_SSE42,        ///< generic's kernels but an SSE4.1 sigmoidBlock
+	CPU_DISPATCH_AVX2,         ///< AVX2 + FMA
+	CPU_DISPATCH_AVX512,       ///< AVX-512 F/VL/DQ/BW
+	CPU_DISPATCH_LEVELS
+};
+
+struct CpuKernels {
+	CpuDispatchLevel level;
+	void (*multiplyMatrices)(double** A, double** B, double** C, int n, int m, int p);
+	void (*powerSums)(const double* x, const double* w, const double* robust_w, int size, int n_sums, double* S);
+	void (*sigmoidBlock)(const float* x, float* y, int n, float x0, float steepness);
+	void (*blockMoments)(const float* values, int n, float* mean, float* m2);
+};
+
+/// @return const CpuKernels& the kernels in use (selected, and logged, on the first call)
+const CpuKernels& cpuKernels();
+
+/// @return CpuDispatchLevel the highest level this CPU supports
+CpuDispatchLevel cpuDispatchDetected();
+
+/**
+ * @brief switches to level's kernels (e.g. to benchmark each variant). Not while another thread is
+ * inside a kernel.
+ * @return bool false (and nothing changes) if the CPU doesn't support level
+ */
+bool cpuDispatchSet(CpuDispatchLevel level);
+
+/// @return const char* "generic", "sse4.2", "avx2" or "avx512"
+const char* cpuDispatchName(CpuDispatchLevel level);
+
+#else
+#define IS_HAS_CPU_DISPATCH 0
+#endif
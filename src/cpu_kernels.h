@@ -0,0 +1,179 @@
+#pragma once
+
+/**
+ * @file cpu_kernels.h
+ * @brief the hot loops behind multiplyMatrices(), the polyfit power sums, sigmoidBlock() and
+ * WelfordOnlineStats::updateBlock(), written once as inline templates
+ */
+
+/*
+	Each kernel is shaped so the compiler vectorizes it: independent lanes (GCC/clang vector
+	extensions, two vectors at a time, where the loop carries a sum), no branches in the inner
+	loops. The library calls them with IS_KERNEL_LANES-wide vectors; on x86 hosts cpu_dispatch.cpp
+	also compiles them for AVX2 and AVX-512 (with wider vectors), and sigmoidBlockKernel() for
+	SSE4.2, and picks one at run time.
+	Vector widths change the order of additions, so results can differ between variants in the
+	last bits.
+*/
+
+#include <stdint.h>
+#include <string.h>
+#include "approx.h"
+
+#ifndef IS_KERNEL_LANES
+#if defined(ARDUINO)
+#define IS_KERNEL_LANES 1 ///< doubles per vector register for the generic kernels (1: plain scalar loops)
+#else
+#define IS_KERNEL_LANES 2
+#endif
+#endif
+
+#ifndef IS_KERNEL_MAX_SUMS
+#define IS_KERNEL_MAX_SUMS 64 ///< power sums the lane-parallel kernel holds (degree <= 31); more fall back to scalar
+#endif
+
+#if defined(__GNUC__)
+#define IS_KERNEL_INLINE inline __attribute__((always_inline))
+#else
+#define IS_KERNEL_INLINE inline
+#endif
+
+namespace is {
+
+/// @brief C = A * B (n x m times m x p), row by row so the inner loop runs along rows of B and C
+IS_KERNEL_INLINE void multiplyMatricesKernel(double** A, double** B, double** C, int n, int m, int p) {
+	for (int i = 0; i < n; i++) {
+		double* c = C[i];
+		const double* a = A[i];
+		for (int j = 0; j < p; j++) c[j] = 0;
+		int k = 0;
+		for (; k + 4 <= m; k += 4) { // same order of additions as one k at a time, a quarter of the loads/stores of c
+			double a0 = a[k], a1 = a[k + 1], a2 = a[k + 2], a3 = a[k + 3];
+			const double *b0 = B[k], *b1 = B[k + 1], *b2 = B[k + 2], *b3 = B[k + 3];
+			for (int j = 0; j < p; j++) c[j] = (((c[j] + a0 * b0[j]) + a1 * b1[j]) + a2 * b2[j]) + a3 * b3[j];
+		}
+		for (; k < m; k++) {
+			double a_k = a[k];
+			const double* b = B[k];
+			for (int j = 0; j < p; j++) c[j] += a_k * b[j];
+		}
+	}
+}
+
+/**
+ * @brief S[m] = sum(v[i] * x[i]^m) for m = 0...n_sums-1, with v[i] = w[i]^2 * robust_w[i] (either
+ * may be nullptr for 1): the normal matrix of a polynomial fit
+ * 
+ * @tparam V doubles per vector register (1 for scalar code)
+ */
+template <int V>
+IS_KERNEL_INLINE void powerSumsKernel(const double* x, const double* w, const double* robust_w, int size, int n_sums, double* S) {
+	for (int m = 0; m < n_sums; m++) S[m] = 0;
+	int i = 0;
+#if defined(__GNUC__)
+	if (V > 1 && n_sums <= IS_KERNEL_MAX_SUMS) {
+		// 2*V points per step in two vectors, so the two p *= x chains overlap (GCC/clang vector extensions)
+		typedef double Vec __attribute__((vector_size(V * sizeof(double))));
+		Vec acc0[IS_KERNEL_MAX_SUMS], acc1[IS_KERNEL_MAX_SUMS], zero = {};
+		for (int m = 0; m < n_sums; m++) acc0[m] = acc1[m] = zero;
+		for (; i + 2 * V <= size; i += 2 * V) {
+			Vec p0 = zero + 1, p1 = zero + 1, x0, x1, v0, v1;
+			memcpy(&x0, x + i, sizeof(x0));
+			memcpy(&x1, x + i + V, sizeof(x1));
+			if (w) {
+				memcpy(&v0, w + i, sizeof(v0));
+				memcpy(&v1, w + i + V, sizeof(v1));
+				p0 = v0 * v0;
+				p1 = v1 * v1;
+			}
+			if (robust_w) {
+				memcpy(&v0, robust_w + i, sizeof(v0));
+				memcpy(&v1, robust_w + i + V, sizeof(v1));
+				p0 *= v0;
+				p1 *= v1;
+			}
+			for (int m = 0; m < n_sums; m++) {
+				acc0[m] += p0;
+				acc1[m] += p1;
+				p0 *= x0;
+				p1 *= x1;
+			}
+		}
+		for (int m = 0; m < n_sums; m++) {
+			double lanes[V];
+			Vec sum = acc0[m] + acc1[m];
+			memcpy(lanes, &sum, sizeof(lanes));
+			for (int l = 0; l < V; l++) S[m] += lanes[l];
+		}
+	}
+#endif
+	for (; i < size; i++) {
+		double p = w ? w[i] * w[i] : 1;
+		if (robust_w) p *= robust_w[i];
+		for (int m = 0; m < n_sums; m++, p *= x[i]) S[m] += p;
+	}
+}
+
+/// @brief y[i] = sigmoidFast(x[i], x0, steepness), branch-free (saturating to ~0/1 for |steepness * (x - x0)| >= 87)
+IS_KERNEL_INLINE void sigmoidBlockKernel(const float* x, float* y, int n, float x0, float steepness) {
+	float s = steepness < 0 ? -steepness : steepness;
+	// two passes: GCC won't if-convert the clamp and the rounding in expApproxCore() in one loop
+	for (int i = 0; i < n; i++) {
+		float z = -s * (x[i] - x0);
+		y[i] = z < -87.3f ? -87.3f : (z > 88.0f ? 88.0f : z);
+	}
+	for (int i = 0; i < n; i++) y[i] = 1.0f / (1.0f + expApproxCore(y[i]));
+}
+
+/**
+ * @brief the mean of n values and their sum of squared deviations from it (two passes, each
+ * summed in 2*V lanes), for merging into a Welford accumulator
+ * 
+ * @tparam V floats per vector register (1 for scalar code)
+ */
+template <int V>
+IS_KERNEL_INLINE void blockMomentsKernel(const float* values, int n, float* mean, float* m2) {
+	float sum = 0, sq = 0;
+	int i = 0;
+#if defined(__GNUC__)
+	typedef float Vec __attribute__((vector_size(V * sizeof(float))));
+	Vec acc0 = {}, acc1 = {}, v0, v1;
+	float lanes[V];
+	if (V > 1) {
+		for (; i + 2 * V <= n; i += 2 * V) {
+			memcpy(&v0, values + i, sizeof(v0));
+			memcpy(&v1, values + i + V, sizeof(v1));
+			acc0 += v0;
+			acc1 += v1;
+		}
+		acc0 += acc1;
+		memcpy(lanes, &acc0, sizeof(lanes));
+		for (int l = 0; l < V; l++) sum += lanes[l];
+	}
+#endif
+	for (int j = i; j < n; j++) sum += values[j];
+	float mu = sum / n;
+
+	i = 0;
+#if defined(__GNUC__)
+	if (V > 1) {
+		acc0 = acc1 = Vec{};
+		for (; i + 2 * V <= n; i += 2 * V) {
+			memcpy(&v0, values + i, sizeof(v0));
+			memcpy(&v1, values + i + V, sizeof(v1));
+			v0 -= mu;
+			v1 -= mu;
+			acc0 += v0 * v0;
+			acc1 += v1 * v1;
+		}
+		acc0 += acc1;
+		memcpy(lanes, &acc0, sizeof(lanes));
+		for (int l = 0; l < V; l++) sq += lanes[l];
+	}
+#endif
+	for (int j = i; j < n; j++) sq += (values[j] - mu) * (values[j] - mu);
+	*mean = mu;
+	*m2 = sq;
+}
+
+} // end namespace
@@ -3,9 +3,27 @@
 // Include all the necessary headers from the library
 #include "matrices.h"
 #include "polynomial.h"
+#include "spline.h"
+#include "approx.h"
+#include "checked_int.h"
 #include "rc.h"
 #include "sigmoid.h"
 #include "TimeElapsed.h"
+#include "TimeElapsedClocks.h"
+#include "TimeElapsedGroup.h"
+#include "LatencyHistogram.h"
+#include "TaskScheduler.h"
+#include "ThreadPool.h"
+#include "cpu_dispatch.h"
+#include "welford_averages.h"
+#include "ShardedWelford.h"
+#include "DiffAmpADC.h"
+#include "ADCScheduler.h"
+#include "ParRateCurveModel.h"
+#include "CurveRecord.h"
+#include "PitchPAR.h"
+#include "RCGlide.h"
+#include "ScopeProfiler.h"
 // #include ""
 // #include ""
 // #include ""
@@ -1,4 +1,7 @@
 #include "matrices.h"
+#include "ThreadPool.h"
+#include "cpu_dispatch.h"
+#include "cpu_kernels.h"
 
 #include <math.h>
 
@@ -13,14 +16,11 @@ void transposeMatrices(double** src, double** dest, int n, int m) {
 }
 
 void multiplyMatrices(double** A, double** B, double** C, int n, int m, int p) {
-	for (int i = 0; i < n; i++) {
-		for (int j = 0; j < p; j++) {
-			C[i][j] = 0; // Initialize result matrix element to 0
-			for (int k = 0; k < m; k++) {
-				C[i][j] += A[i][k] * B[k][j]; // Sum of products
-			}
-		}
-	}
+#if IS_HAS_CPU_DISPATCH
+	cpuKernels().multiplyMatrices(A, B, C, n, m, p);
+#else
+	multiplyMatricesKernel(A, B, C, n, m, p);
+#endif
 }
 
 void multiplyMatrixWithVector(double** A, double* x, double* y, int n, int m) {
@@ -32,7 +32,8 @@ void multiplyMatrixWithVector(double** A, double* x, double* y, int n, int m) {
 	}
 }
 
-void gaussianElimination(double** A, double* b, double* coeffs, int n) {
+SolveStatus gaussianElimination(double** A, double* b, double* coeffs, int n) {
+	SolveStatus status = SOLVE_OK;
 	for (int i = 0; i < n; i++) {
 		int max_row = i; // Index of the row with the largest pivot element
 		for (int k = i + 1; k < n; k++) {
@@ -50,6 +51,11 @@ void gaussianElimination(double** A, double* b, double* coeffs, int n) {
 		b[i] = b[max_row];
 		b[max_row] = temp_b;
 
+		if (A[i][i] == 0) { // the rest of the column is zero too: nothing to eliminate
+			status = SOLVE_RANK_DEFICIENT;
+			continue;
+		}
+
 		// Eliminate entries below the pivot
 		for (int k = i + 1; k < n; k++) {
 			double factor = A[k][i] / A[i][i];
@@ -62,11 +68,290 @@ void gaussianElimination(double** A, double* b, double* coeffs, int n) {
 
 	// Back substitution to solve for coefficients
 	for (int i = n - 1; i >= 0; i--) {
-		coeffs[i] = b[i] / A[i][i];
+		coeffs[i] = A[i][i] != 0 ? b[i] / A[i][i] : 0;
 		for (int k = i - 1; k >= 0; k--) {
 			b[k] -= A[k][i] * coeffs[i];
 		}
 	}
+	return status;
+}
+
+SolveStatus tridiagonalSolve(const double* sub, double* diag, const double* sup, double* rhs, int n) {
+	SolveStatus status = SOLVE_OK;
+	// forward elimination: diag[i] and rhs[i] become the upper bidiagonal system's
+	for (int i = 1; i < n; i++) {
+		if (diag[i - 1] == 0) { status = SOLVE_RANK_DEFICIENT; continue; }
+		double factor = sub[i] / diag[i - 1];
+		diag[i] -= factor * sup[i - 1];
+		rhs[i] -= factor * rhs[i - 1];
+	}
+	// back substitution
+	for (int i = n - 1; i >= 0; i--) {
+		if (diag[i] == 0) { status = SOLVE_RANK_DEFICIENT; rhs[i] = 0; continue; }
+		rhs[i] = (rhs[i] - (i < n - 1 ? sup[i] * rhs[i + 1] : 0)) / diag[i];
+	}
+	return status;
+}
+
+static SolveStatus factorStatus(double pivot_min, double pivot_max, int deficient, int n, double* rcond, int* rank) {
+	double rc = deficient || pivot_max <= 0 ? 0 : pivot_min / pivot_max;
+	if (rcond) *rcond = rc;
+	if (rank) *rank = n - deficient;
+	if (deficient) return SOLVE_RANK_DEFICIENT;
+	return rc < MATRICES_RCOND_WARN ? SOLVE_ILL_CONDITIONED : SOLVE_OK;
+}
+
+// the early return of choleskyFactor()/ldltFactor() at column j: rcond 0, rank of the columns before j
+static SolveStatus notPositiveDefinite(int j, int deficient, double* rcond, int* rank) {
+	if (rcond) *rcond = 0;
+	if (rank) *rank = j - deficient;
+	return SOLVE_NOT_POSITIVE_DEFINITE;
+}
+
+//**** blocked LU ************************************************************
+
+struct LuJob {
+	double** A;
+	int n;
+	int k0, kb;     // the current panel: columns (and pivot rows) k0...k0+kb-1
+	int nb;         // tile size
+	int n_row_tiles, n_col_tiles; // of the trailing matrix, rows/columns k0+kb...n-1
+};
+
+// U12: the panel's block row right of the panel, column tile t, solved with the panel's unit L11
+static void luBlockRow(int t, void* ctx) {
+	LuJob& job = *(LuJob*)ctx;
+	double** A = job.A;
+	int c0 = job.k0 + job.kb + t * job.nb, c1 = c0 + job.nb < job.n ? c0 + job.nb : job.n;
+	for (int p = job.k0; p < job.k0 + job.kb; p++) {
+		const double* a_p = A[p];
+		for (int i = p + 1; i < job.k0 + job.kb; i++) {
+			double l = A[i][p];
+			if (l == 0) continue;
+			double* a_i = A[i];
+			for (int j = c0; j < c1; j++) a_i[j] -= l * a_p[j];
+		}
+	}
+}
+
+// A22 -= L21 * U12 for one tile of the trailing matrix (tiles along a row of tiles are consecutive)
+static void luTrailingTile(int t, void* ctx) {
+	LuJob& job = *(LuJob*)ctx;
+	double** A = job.A;
+	int start = job.k0 + job.kb;
+	int r0 = start + (t / job.n_col_tiles) * job.nb, r1 = r0 + job.nb < job.n ? r0 + job.nb : job.n;
+	int c0 = start + (t % job.n_col_tiles) * job.nb, c1 = c0 + job.nb < job.n ? c0 + job.nb : job.n;
+	for (int i = r0; i < r1; i++) {
+		double* a_i = A[i];
+		int p = job.k0;
+		for (; p + 4 <= start; p += 4) { // four rank-1 updates per pass: a quarter of the loads/stores of a_i
+			double l0 = a_i[p], l1 = a_i[p + 1], l2 = a_i[p + 2], l3 = a_i[p + 3];
+			const double *a_p0 = A[p], *a_p1 = A[p + 1], *a_p2 = A[p + 2], *a_p3 = A[p + 3];
+			for (int j = c0; j < c1; j++) a_i[j] -= l0 * a_p0[j] + l1 * a_p1[j] + l2 * a_p2[j] + l3 * a_p3[j];
+		}
+		for (; p < start; p++) {
+			double l = a_i[p];
+			const double* a_p = A[p];
+			for (int j = c0; j < c1; j++) a_i[j] -= l * a_p[j];
+		}
+	}
+}
+
+static void luParallel(int n_tasks, void (*func)(int, void*), LuJob& job, int max_threads) {
+#if IS_HAS_THREADPOOL
+	ThreadPool::shared().parallelForStealing(n_tasks, func, &job, max_threads);
+#else
+	(void)max_threads;
+	for (int t = 0; t < n_tasks; t++) func(t, &job);
+#endif
+}
+
+SolveStatus luFactor(double** A, int* perm, int n, double* rcond, int max_threads, double tol) {
+	double a_max = 0;
+	for (int i = 0; i < n; i++) {
+		perm[i] = i;
+		for (int j = 0; j < n; j++) if (fabs(A[i][j]) > a_max) a_max = fabs(A[i][j]);
+	}
+	double zero_tol = tol * a_max;
+	double pivot_min = HUGE_VAL, pivot_max = 0;
+	int deficient = 0;
+
+	LuJob job = {A, n, 0, 0, MATRICES_LU_BLOCK, 0, 0};
+	for (int k0 = 0; k0 < n; k0 += job.nb) {
+		int kb = n - k0 < job.nb ? n - k0 : job.nb, k1 = k0 + kb;
+
+		// factor the panel (columns k0...k1-1, all rows below k0) unblocked, swapping whole rows
+		for (int j = k0; j < k1; j++) {
+			int max_row = j;
+			for (int i = j + 1; i < n; i++) if (fabs(A[i][j]) > fabs(A[max_row][j])) max_row = i;
+			double* tmp_row = A[j]; A[j] = A[max_row]; A[max_row] = tmp_row;
+			int tmp_perm = perm[j]; perm[j] = perm[max_row]; perm[max_row] = tmp_perm;
+
+			double pivot = fabs(A[j][j]);
+			if (pivot <= zero_tol) { // nothing usable left in this column
+				A[j][j] = 0;
+				for (int i = j + 1; i < n; i++) A[i][j] = 0;
+				++deficient;
+				continue;
+			}
+			if (pivot < pivot_min) pivot_min = pivot;
+			if (pivot > pivot_max) pivot_max = pivot;
+			double inv = 1 / A[j][j];
+			const double* a_j = A[j];
+			for (int i = j + 1; i < n; i++) {
+				double* a_i = A[i];
+				double l = a_i[j] *= inv;
+				if (l == 0) continue;
+				for (int c = j + 1; c < k1; c++) a_i[c] -= l * a_j[c];
+			}
+		}
+
+		// then everything right of and below it, in tiles
+		if (k1 < n) {
+			job.k0 = k0;
+			job.kb = kb;
+			job.n_row_tiles = job.n_col_tiles = (n - k1 + job.nb - 1) / job.nb;
+			luParallel(job.n_col_tiles, luBlockRow, job, max_threads);
+			luParallel(job.n_row_tiles * job.n_col_tiles, luTrailingTile, job, max_threads);
+		}
+	}
+	return factorStatus(pivot_min, pivot_max, deficient, n, rcond, nullptr);
+}
+
+void luSolve(double** LU, const int* perm, const double* b, double* x, int n) {
+	// L*y = P*b (unit diagonal), then U*x = y
+	for (int i = 0; i < n; i++) {
+		const double* lu_i = LU[i];
+		double sum = b[perm[i]];
+		for (int j = 0; j < i; j++) sum -= lu_i[j] * x[j];
+		x[i] = sum;
+	}
+	for (int i = n - 1; i >= 0; i--) {
+		const double* lu_i = LU[i];
+		if (lu_i[i] == 0) { x[i] = 0; continue; }
+		double sum = x[i];
+		for (int j = i + 1; j < n; j++) sum -= lu_i[j] * x[j];
+		x[i] = sum / lu_i[i];
+	}
+}
+
+struct LuSolveManyJob {
+	double** LU;
+	const int* perm;
+	double** B;
+	double** X;
+	int n;
+};
+
+static void luSolveOne(int r, void* ctx) {
+	LuSolveManyJob& job = *(LuSolveManyJob*)ctx;
+	luSolve(job.LU, job.perm, job.B[r], job.X[r], job.n);
+}
+
+void luSolveMany(double** LU, const int* perm, double** B, double** X, int n, int n_rhs, int max_threads) {
+	LuSolveManyJob job = {LU, perm, B, X, n};
+#if IS_HAS_THREADPOOL
+	ThreadPool::shared().parallelFor(n_rhs, luSolveOne, &job, max_threads);
+#else
+	(void)max_threads;
+	for (int r = 0; r < n_rhs; r++) luSolveOne(r, &job);
+#endif
+}
+
+SolveStatus choleskyFactor(double** A, int n, double* rcond, int* rank, double tol) {
+	double pivot_min = HUGE_VAL, pivot_max = 0;
+	int deficient = 0;
+	for (int j = 0; j < n; j++) {
+		double d = A[j][j];
+		for (int k = 0; k < j; k++) d -= A[j][k] * A[j][k];
+
+		double tol_abs = tol * A[j][j]; // d/A[j][j]: the part of column j independent of the ones before it
+		if (d <= tol_abs) {
+			if (d < -tol_abs) return notPositiveDefinite(j, deficient, rcond, rank);
+			++deficient; // dependent column: zero it so the solves skip this unknown
+			for (int i = j; i < n; i++) A[i][j] = 0;
+			continue;
+		}
+		if (d < pivot_min) pivot_min = d;
+		if (d > pivot_max) pivot_max = d;
+
+		double ljj = sqrt(d);
+		A[j][j] = ljj;
+		for (int i = j + 1; i < n; i++) {
+			double s = A[i][j];
+			for (int k = 0; k < j; k++) s -= A[i][k] * A[j][k];
+			A[i][j] = s / ljj;
+		}
+	}
+	return factorStatus(pivot_min, pivot_max, deficient, n, rcond, rank);
+}
+
+void choleskySolve(double** L, const double* b, double* x, int n) {
+	// forward substitution: L*y = b (y in x)
+	for (int i = 0; i < n; i++) {
+		double s = b[i];
+		for (int k = 0; k < i; k++) s -= L[i][k] * x[k];
+		x[i] = L[i][i] != 0 ? s / L[i][i] : 0;
+	}
+	// back substitution: L^T*x = y
+	for (int i = n - 1; i >= 0; i--) {
+		double s = x[i];
+		for (int k = i + 1; k < n; k++) s -= L[k][i] * x[k];
+		x[i] = L[i][i] != 0 ? s / L[i][i] : 0;
+	}
+}
+
+void choleskySolveMany(double** L, double** B, double** X, int n, int n_rhs) {
+	for (int r = 0; r < n_rhs; r++) choleskySolve(L, B[r], X[r], n);
+}
+
+SolveStatus ldltFactor(double** A, int n, double* rcond, int* rank, double tol) {
+	double pivot_min = HUGE_VAL, pivot_max = 0;
+	int deficient = 0;
+	for (int j = 0; j < n; j++) {
+		double d = A[j][j];
+		for (int k = 0; k < j; k++) d -= A[j][k] * A[j][k] * A[k][k];
+
+		double tol_abs = tol * A[j][j];
+		if (d <= tol_abs) {
+			if (d < -tol_abs) return notPositiveDefinite(j, deficient, rcond, rank);
+			++deficient;
+			for (int i = j; i < n; i++) A[i][j] = 0;
+			continue;
+		}
+		if (d < pivot_min) pivot_min = d;
+		if (d > pivot_max) pivot_max = d;
+
+		A[j][j] = d;
+		for (int i = j + 1; i < n; i++) {
+			double s = A[i][j];
+			for (int k = 0; k < j; k++) s -= A[i][k] * A[j][k] * A[k][k];
+			A[i][j] = s / d;
+		}
+	}
+	return factorStatus(pivot_min, pivot_max, deficient, n, rcond, rank);
+}
+
+void ldltSolve(double** LD, const double* b, double* x, int n) {
+	// L*z = b (unit diagonal)
+	for (int i = 0; i < n; i++) {
+		double s = b[i];
+		for (int k = 0; k < i; k++) s -= LD[i][k] * x[k];
+		x[i] = s;
+	}
+	// D*y = z
+	for (int i = 0; i < n; i++) x[i] = LD[i][i] != 0 ? x[i] / LD[i][i] : 0;
+	// L^T*x = y
+	for (int i = n - 1; i >= 0; i--) {
+		if (LD[i][i] == 0) { x[i] = 0; continue; }
+		double s = x[i];
+		for (int k = i + 1; k < n; k++) s -= LD[k][i] * x[k];
+		x[i] = s;
+	}
+}
+
+void ldltSolveMany(double** LD, double** B, double** X, int n, int n_rhs) {
+	for (int r = 0; r < n_rhs; r++) ldltSolve(LD, B[r], X[r], n);
 }
 
 } // end namespace
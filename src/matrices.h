@@ -5,8 +5,31 @@
  * @brief mathematical operations involving matrices (implemented as C arrays/pointers)
  */
 
+#ifndef MATRICES_PIVOT_TOL
+#define MATRICES_PIVOT_TOL 1e-13 ///< pivots below this (relative to the column's diagonal element) count as zero
+#endif
+
+#ifndef MATRICES_RCOND_WARN
+#define MATRICES_RCOND_WARN 1e-10 ///< reciprocal condition estimates below this are reported as ill-conditioned
+#endif
+
+#ifndef MATRICES_LU_BLOCK
+#define MATRICES_LU_BLOCK 64 ///< luFactor()'s panel width and tile size (rows/columns)
+#endif
+
 namespace is {
 
+/**
+ * @brief result of a factorization or solve. Anything but SOLVE_NOT_POSITIVE_DEFINITE still
+ * produces a finite solution.
+ */
+enum SolveStatus {
+	SOLVE_OK = 0,
+	SOLVE_ILL_CONDITIONED,       ///< solved, but expect to lose digits (see rcond)
+	SOLVE_RANK_DEFICIENT,        ///< some pivots were ~0: those unknowns are set to 0 rather than inf/NaN
+	SOLVE_NOT_POSITIVE_DEFINITE  ///< a clearly negative pivot: the matrix isn't SPD (the factor is unusable)
+};
+
 /**
  * @brief Transposes a matrix
  * 
@@ -47,7 +70,114 @@ void multiplyMatrixWithVector(double** A, double* x, double* y, int n, int m);
  * @param b The vector of constants (n)
  * @param coeffs The vector to store the resulting coefficients (n)
  * @param n The number of equations (and unknowns)
+ * @return SolveStatus SOLVE_RANK_DEFICIENT if a pivot column was all zero (that coefficient is set to 0)
  */
-void gaussianElimination(double** A, double* b, double* coeffs, int n);
+SolveStatus gaussianElimination(double** A, double* b, double* coeffs, int n);
+
+/**
+ * @brief Solves a tridiagonal system in O(n) (Thomas algorithm, no pivoting: meant for diagonally
+ * dominant systems such as spline equations). Row i is sub[i]*x[i-1] + diag[i]*x[i] + sup[i]*x[i+1] = rhs[i].
+ * 
+ * @param sub The subdiagonal (n, sub[0] is unused)
+ * @param diag The diagonal (n), overwritten
+ * @param sup The superdiagonal (n, sup[n-1] is unused)
+ * @param rhs The right-hand side (n), overwritten with the solution
+ * @param n The number of equations
+ * @return SolveStatus SOLVE_RANK_DEFICIENT if a pivot was 0 (that unknown is set to 0)
+ */
+SolveStatus tridiagonalSolve(const double* sub, double* diag, const double* sup, double* rhs, int n);
+
+/*
+	LU factorization with partial pivoting (P*A = L*U, L unit lower triangular) for large dense
+	systems, e.g. joint calibrations with hundreds to thousands of unknowns. It is right-looking and
+	blocked: each panel of MATRICES_LU_BLOCK columns is factored, then the block row to its right is
+	solved and the trailing matrix updated tile by tile (MATRICES_LU_BLOCK square tiles), so nearly
+	all the flops are in cache-sized tile updates, which on the host run in parallel on
+	ThreadPool::shared() (parallelForStealing(), so each thread works along a row of tiles).
+
+	Rows are swapped by swapping A's row pointers (as gaussianElimination() does), so A's pointer
+	array is permuted and perm[] records which original row each factored row is. A pivot column
+	whose largest element is below tol * (A's largest element) is rank deficient: its multipliers
+	are zeroed, its pivot is set to 0 and the solves set the matching unknown to 0.
+*/
+
+/**
+ * @brief Factors A in place as P*A = L*U (L's unit diagonal isn't stored)
+ *
+ * @param A The matrix (n x n); its row pointers are permuted
+ * @param perm receives n entries: factored row i is original row perm[i]
+ * @param n The size of A
+ * @param rcond (optional) receives min/max of |U's diagonal|, a cheap reciprocal condition estimate
+ * @param max_threads (default=0) if >0, use at most this many threads (host only)
+ * @param tol (default=MATRICES_PIVOT_TOL) relative pivot tolerance
+ * @return SolveStatus
+ */
+SolveStatus luFactor(double** A, int* perm, int n, double* rcond=nullptr, int max_threads=0, double tol=MATRICES_PIVOT_TOL);
+
+/**
+ * @brief Solves A*x = b with a factor from luFactor()
+ *
+ * @param LU The factor (n x n, the row pointers as luFactor() left them)
+ * @param b The right-hand side (n, in A's original row order), not modified
+ * @param x The solution (n), must not be b
+ */
+void luSolve(double** LU, const int* perm, const double* b, double* x, int n);
+
+/// @brief luSolve() for n_rhs right-hand sides B[0]...B[n_rhs-1] into X[0]...X[n_rhs-1], in parallel on the host
+void luSolveMany(double** LU, const int* perm, double** B, double** X, int n, int n_rhs, int max_threads=0);
+
+/*
+	Cholesky (A = L*L^T) and LDL^T (A = L*D*L^T, L unit lower triangular) factorizations for
+	symmetric positive (semi)definite matrices such as the normal equations A^T*A. They take half
+	the flops of gaussianElimination, need no pivoting, and work in place in A's lower triangle
+	(the strict upper triangle is neither read nor written), so they allocate nothing. Factor once,
+	then solve as many right-hand sides as needed.
+
+	A pivot below tol * A[j][j] means column j is (numerically) a combination of the columns before
+	it, so A is rank deficient: that column of the factor is zeroed and the solves set the matching
+	unknown to 0, so the result is a finite basic solution rather than inf/NaN. rcond is a cheap
+	estimate of the reciprocal condition number from the pivots (min/max of D, or of L's diagonal
+	squared); it is 0 when rank deficient or not positive definite.
+	LDL^T avoids square roots, which is cheaper on an AVR. Because the test is per column, the factor
+	of a leading k x k submatrix of A is the leading k x k block of A's factor.
+*/
+
+/**
+ * @brief Factors symmetric positive definite A in place as L*L^T (L in A's lower triangle)
+ *
+ * @param A The matrix (n x n); only the lower triangle is used
+ * @param n The size of A
+ * @param rcond (optional) receives the reciprocal condition estimate
+ * @param rank (optional) receives the numerical rank (of the columns before the failing one if not
+ * positive definite)
+ * @param tol (default=MATRICES_PIVOT_TOL) relative pivot tolerance
+ * @return SolveStatus
+ */
+SolveStatus choleskyFactor(double** A, int n, double* rcond=nullptr, int* rank=nullptr, double tol=MATRICES_PIVOT_TOL);
+
+/**
+ * @brief Solves L*L^T*x = b with a factor from choleskyFactor()
+ *
+ * @param L The factor (n x n)
+ * @param b The right-hand side (n), not modified
+ * @param x The solution (n), may be the same array as b
+ * @param n The size of L
+ */
+void choleskySolve(double** L, const double* b, double* x, int n);
+
+/// @brief choleskySolve() for n_rhs right-hand sides B[0]...B[n_rhs-1] into X[0]...X[n_rhs-1]
+void choleskySolveMany(double** L, double** B, double** X, int n, int n_rhs);
+
+/**
+ * @brief Factors symmetric positive definite A in place as L*D*L^T (D on A's diagonal, L's
+ * strict lower part below it). Parameters as choleskyFactor().
+ */
+SolveStatus ldltFactor(double** A, int n, double* rcond=nullptr, int* rank=nullptr, double tol=MATRICES_PIVOT_TOL);
+
+/// @brief Solves L*D*L^T*x = b with a factor from ldltFactor(). x may be the same array as b.
+void ldltSolve(double** LD, const double* b, double* x, int n);
+
+/// @brief ldltSolve() for n_rhs right-hand sides B[0]...B[n_rhs-1] into X[0]...X[n_rhs-1]
+void ldltSolveMany(double** LD, double** B, double** X, int n, int n_rhs);
 
 } // end namespace
@@ -1,71 +1,356 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <math.h>
-#include "matrices.h"
+#include <float.h>
+#include "polynomial.h"
+#include "ThreadPool.h"
+#include "cpu_dispatch.h"
+#include "cpu_kernels.h"
 
 namespace is {
 
 /*
-	Explanation of the Main Variables:
-	A: The Vandermonde matrix based on the x-coordinates of the data points. Each element of A[i][j] is x[i] raised to the power j.
-	AT: The transpose of the Vandermonde matrix A.
-	ATA: The product of AT and A, which is a square matrix used in the normal equation for least squares fitting.
-	ATy: The product of AT and the vector y, used in the normal equation for least squares fitting.
-	coeffs: The resulting polynomial coefficients after solving the normal equations.
-	These comments and explanations should help you understand the purpose of each part of the code and the role of the variables.
+	The normal equations are built straight from power sums rather than from the Vandermonde matrix:
+	with weights v[i] (1, or w[i]^2 for weighted fits),
+	ATA[j][k] = sum(v[i] * x[i]^(j+k))  (so it only takes the 2*deg+1 sums S[m] = sum(v[i] * x[i]^m))
+	ATy[j]    = sum(v[i] * y[i] * x[i]^j)
+	ATA is symmetric positive definite, so it is solved with Cholesky (see matrices.h). Coefficients
+	are solved lowest power first and reversed for the polynomial representation (highest first).
 */
 
-void polyfit(double* x, double* y, int size, int deg, double* coeffs) {
-	int n = deg + 1; // Number of polynomial coefficients
+PolyfitWorkspace::PolyfitWorkspace(int max_deg, int max_size): _max_deg{max_deg}, _max_size{max_size} {
+	int n = max_deg + 1;
+	size_t n_doubles = (size_t)n * n + n + (2 * n - 1) + n + 2 * (size_t)max_size;
+	_block = malloc(n * sizeof(double*) + n_doubles * sizeof(double));
+	if (!_block) return;
+	_ATA = (double**)_block;
+	double* d = (double*)(_ATA + n);
+	for (int i = 0; i < n; i++, d += n) _ATA[i] = d;
+	_ATy = d;           d += n;
+	_sums = d;          d += 2 * n - 1;
+	_coeffs_prev = d;   d += n;
+	_weights = d;       d += max_size;
+	_scratch = d;
+}
+
+PolyfitWorkspace::~PolyfitWorkspace() {
+	free(_block);
+}
+
+static void reverseCoeffs(double* c, int n) {
+	for (int i = 0; i < n / 2; i++) {
+		double temp = c[i];
+		c[i] = c[n - 1 - i];
+		c[n - 1 - i] = temp;
+	}
+}
 
-	// Construct Vandermonde matrix A
-	double** A = (double**)malloc(size * sizeof(double*));
+// fills ws._ATA (lower triangle) from the weighted power sums and factors it
+static SolveStatus normalMatrix(double* x, double* w, double* robust_w, int size, int n, PolyfitWorkspace& ws) {
+	int n_sums = 2 * n - 1;
+	double* S = ws._sums;
+#if IS_HAS_CPU_DISPATCH
+	cpuKernels().powerSums(x, w, robust_w, size, n_sums, S);
+#else
+	powerSumsKernel<IS_KERNEL_LANES>(x, w, robust_w, size, n_sums, S);
+#endif
+	for (int j = 0; j < n; j++) {
+		for (int k = 0; k <= j; k++) ws._ATA[j][k] = S[j + k];
+	}
+	return choleskyFactor(ws._ATA, n);
+}
+
+// solves for coefficients (lowest power first) against the factor from normalMatrix()
+static void normalSolve(double* x, double* y, double* w, double* robust_w, int size, int n, PolyfitWorkspace& ws, double* c) {
+	double* ATy = ws._ATy;
+	for (int j = 0; j < n; j++) ATy[j] = 0;
 	for (int i = 0; i < size; i++) {
-		A[i] = (double*)malloc(n * sizeof(double));
+		double q = y[i];
+		if (w) q *= w[i] * w[i];
+		if (robust_w) q *= robust_w[i];
+		for (int j = 0; j < n; j++, q *= x[i]) ATy[j] += q;
+	}
+	choleskySolve(ws._ATA, ATy, c, n);
+}
+
+static SolveStatus weightedFit(double* x, double* y, double* w, double* robust_w, int size, int n, PolyfitWorkspace& ws, double* c) {
+	SolveStatus status = normalMatrix(x, w, robust_w, size, n, ws);
+	if (status == SOLVE_NOT_POSITIVE_DEFINITE) { // can't happen for real data, but don't return garbage
+		for (int i = 0; i < n; i++) c[i] = 0;
+		return status;
+	}
+	normalSolve(x, y, w, robust_w, size, n, ws, c);
+	return status;
+}
+
+SolveStatus polyfit(double* x, double* y, int size, int deg, double* coeffs) {
+	return polyfitWeighted(x, y, nullptr, size, deg, coeffs);
+}
+
+SolveStatus polyfitMany(double* x, double** ys, int n_ys, int size, int deg, double** coeffs) {
+	int n = deg + 1; // Number of polynomial coefficients
+	PolyfitWorkspace ws(deg);
+	if (!ws.valid()) return SOLVE_NOT_POSITIVE_DEFINITE;
+
+	SolveStatus status = normalMatrix(x, nullptr, nullptr, size, n, ws); // factored once...
+	for (int r = 0; r < n_ys; r++) {
+		if (status == SOLVE_NOT_POSITIVE_DEFINITE) {
+			for (int i = 0; i < n; i++) coeffs[r][i] = 0;
+			continue;
+		}
+		normalSolve(x, ys[r], nullptr, nullptr, size, n, ws, coeffs[r]); // ...solved per data set
+		reverseCoeffs(coeffs[r], n);
+	}
+	return status;
+}
+
+SolveStatus polyfitWeighted(double* x, double* y, double* w, int size, int deg, double* coeffs, PolyfitWorkspace* ws) {
+	int n = deg + 1;
+	if (ws && ws->fits(size, deg)) {
+		SolveStatus status = weightedFit(x, y, w, nullptr, size, n, *ws, coeffs);
+		reverseCoeffs(coeffs, n);
+		return status;
+	}
+	PolyfitWorkspace local(deg);
+	if (!local.valid()) return SOLVE_NOT_POSITIVE_DEFINITE;
+	SolveStatus status = weightedFit(x, y, w, nullptr, size, n, local, coeffs);
+	reverseCoeffs(coeffs, n);
+	return status;
+}
+
+// k-th smallest of a[0...n-1] (quickselect; reorders a)
+static double selectKth(double* a, int n, int k) {
+	int lo = 0, hi = n - 1;
+	while (lo < hi) {
+		double pivot = a[(lo + hi) / 2];
+		int i = lo, j = hi;
+		while (i <= j) {
+			while (a[i] < pivot) i++;
+			while (a[j] > pivot) j--;
+			if (i <= j) {
+				double temp = a[i];
+				a[i++] = a[j];
+				a[j--] = temp;
+			}
+		}
+		if (k <= j) hi = j;
+		else if (k >= i) lo = i;
+		else break;
+	}
+	return a[k];
+}
+
+// p(x) with coefficients lowest power first
+static double polyvalAscending(const double* c, int n, double x) {
+	double y = c[n - 1];
+	for (int i = n - 2; i >= 0; i--) y = y * x + c[i];
+	return y;
+}
+
+SolveStatus polyfitRobust(double* x, double* y, double* w, int size, int deg, double* coeffs, PolyfitWorkspace& ws,
+	PolyfitLoss loss, double tuning, int max_iter, double tol) {
+	int n = deg + 1;
+	ws._iterations = 0;
+	ws._scale = 0;
+	if (!ws.fits(size, deg, true)) return SOLVE_NOT_POSITIVE_DEFINITE;
+	if (tuning <= 0) tuning = loss == POLYFIT_TUKEY ? 4.685 : 1.345;
+
+	for (int i = 0; i < size; i++) ws._weights[i] = 1;
+	SolveStatus status = weightedFit(x, y, w, nullptr, size, n, ws, coeffs);
+
+	for (int iter = 0; iter < max_iter && status != SOLVE_NOT_POSITIVE_DEFINITE; iter++) {
+		// robust scale: the median absolute (weighted) residual, scaled to a Gaussian sigma
+		for (int i = 0; i < size; i++) {
+			double r = fabs(y[i] - polyvalAscending(coeffs, n, x[i]));
+			ws._scratch[i] = w ? r * fabs(w[i]) : r;
+		}
+		double scale = 1.4826 * selectKth(ws._scratch, size, (size - 1) / 2);
+		if (scale <= 0) break; // most points fit exactly: nothing left to reweight
+		ws._scale = scale;
+
+		double cutoff = tuning * scale;
+		for (int i = 0; i < size; i++) {
+			double r = fabs(y[i] - polyvalAscending(coeffs, n, x[i]));
+			if (w) r *= fabs(w[i]);
+			if (loss == POLYFIT_HUBER) {
+				ws._weights[i] = r <= cutoff ? 1 : cutoff / r;
+			} else {
+				double u = r / cutoff;
+				ws._weights[i] = u < 1 ? (1 - u * u) * (1 - u * u) : 0;
+			}
+		}
+
+		for (int j = 0; j < n; j++) ws._coeffs_prev[j] = coeffs[j];
+		status = weightedFit(x, y, w, ws._weights, size, n, ws, coeffs);
+		ws._iterations = iter + 1;
+
+		double max_change = 0, max_coeff = 0;
 		for (int j = 0; j < n; j++) {
-			A[i][j] = pow(x[i], j); // Each element is x[i]^j
+			double change = fabs(coeffs[j] - ws._coeffs_prev[j]);
+			if (change > max_change) max_change = change;
+			if (fabs(coeffs[j]) > max_coeff) max_coeff = fabs(coeffs[j]);
 		}
+		if (max_change <= tol * max_coeff) break;
 	}
+	reverseCoeffs(coeffs, n);
+	return status;
+}
+
+// polyfitSelect(): one fold's buffers, all carved from one allocation
+struct PolyfitSelectFold {
+	double* sums;    // 2*max_deg+1 power sums of this fold's points
+	double* moments; // max_deg+1 sums of y*x^j of this fold's points
+	double* tsums;   // 2*max_deg+1 power sums of the training points (every other fold)
+	double* ATy;     // max_deg+1 moments of the training points
+	double** L;      // (max_deg+1) x (max_deg+1) training normal matrix, then its Cholesky factor
+	double* c;       // max_deg blocks of max_deg+1 coefficients (lowest power first), one per degree
+	double* sse;     // max_deg squared errors on this fold's points (on all points for the full fit), one per degree
+	SolveStatus status;
+};
+
+struct PolyfitSelectJob {
+	double* x;
+	double* y;
+	int size;
+	int max_deg;
+	int folds;
+	int first;             // first fold to solve: 0 for cross-validation, folds for just the full fit
+	PolyfitSelectFold* f;  // folds + 1 entries, the last is the fit to all the data
+};
 
-	// Transpose of A
-	double** AT = (double**)malloc(n * sizeof(double*));
-	for (int i = 0; i < n; i++) {
-		AT[i] = (double*)malloc(size * sizeof(double));
+// accumulates fold k's power sums and moments (points k, k + folds, ...)
+static void polyfitSelectSums(int k, void* ctx) {
+	PolyfitSelectJob& job = *(PolyfitSelectJob*)ctx;
+	PolyfitSelectFold& f = job.f[k];
+	int n = job.max_deg + 1, n_sums = 2 * n - 1;
+	for (int m = 0; m < n_sums; m++) f.sums[m] = 0;
+	for (int j = 0; j < n; j++) f.moments[j] = 0;
+	for (int i = k; i < job.size; i += job.folds) {
+		double p = 1, q = job.y[i];
+		for (int m = 0; m < n_sums; m++, p *= job.x[i]) f.sums[m] += p;
+		for (int j = 0; j < n; j++, q *= job.x[i]) f.moments[j] += q;
+	}
+}
+
+// fits every degree to all folds but k (all of them for k == folds) and measures each one's squared error
+static void polyfitSelectFit(int t, void* ctx) {
+	PolyfitSelectJob& job = *(PolyfitSelectJob*)ctx;
+	int k = job.first + t;
+	PolyfitSelectFold& f = job.f[k];
+	int n = job.max_deg + 1, n_sums = 2 * n - 1;
+
+	// training sums: add up the other folds' (rather than subtracting this fold's, which cancels)
+	for (int m = 0; m < n_sums; m++) f.tsums[m] = 0;
+	for (int j = 0; j < n; j++) f.ATy[j] = 0;
+	for (int g = 0; g < job.folds; g++) {
+		if (g == k) continue;
+		for (int m = 0; m < n_sums; m++) f.tsums[m] += job.f[g].sums[m];
+		for (int j = 0; j < n; j++) f.ATy[j] += job.f[g].moments[j];
 	}
-	transposeMatrices(A, AT, size, n);
 
-	// ATA = AT * A
-	double** ATA = (double**)malloc(n * sizeof(double*));
-	for (int i = 0; i < n; i++) {
-		ATA[i] = (double*)malloc(n * sizeof(double));
+	// factor the max_deg normal matrix once; degree d uses its leading (d+1) x (d+1) block
+	for (int j = 0; j < n; j++) {
+		for (int l = 0; l <= j; l++) f.L[j][l] = f.tsums[j + l];
+	}
+	f.status = choleskyFactor(f.L, n);
+	if (f.status == SOLVE_NOT_POSITIVE_DEFINITE) {
+		for (int d = 1; d < n; d++) f.sse[d - 1] = HUGE_VAL;
+		return;
+	}
+	for (int d = 1; d < n; d++) {
+		double* c = f.c + (d - 1) * n;
+		choleskySolve(f.L, f.ATy, c, d + 1);
+		double sse = 0;
+		for (int i = k < job.folds ? k : 0; i < job.size; i += k < job.folds ? job.folds : 1) {
+			double r = job.y[i] - polyvalAscending(c, d + 1, job.x[i]);
+			sse += r * r;
+		}
+		f.sse[d - 1] = sse;
 	}
-	multiplyMatrices(AT, A, ATA, n, size, n);
+}
+
+int polyfitSelect(double* x, double* y, int size, int max_deg, double* coeffs, PolyfitDegreeStats* stats,
+	PolyfitCriterion criterion, int folds, int max_threads) {
+	if (size <= 1 || max_deg < 1) return -1;
+	int n = max_deg + 1, n_sums = 2 * n - 1;
+	bool cv = criterion == POLYFIT_CV;
+	if (!cv) folds = 1;
+	if (folds < 2 && cv) folds = 2;
+	if (folds > size) folds = size;
 
-	// ATy = AT * y
-	double* ATy = (double*)malloc(n * sizeof(double));
-	multiplyMatrixWithVector(AT, y, ATy, n, size);
+	size_t doubles_per_fold = 2 * (size_t)n_sums + 2 * n + (size_t)n * n + (size_t)max_deg * n + max_deg;
+	size_t bytes_per_fold = doubles_per_fold * sizeof(double) + n * sizeof(double*);
+	void* block = malloc((folds + 1) * (sizeof(PolyfitSelectFold) + bytes_per_fold));
+	if (!block) return -1;
+	PolyfitSelectFold* f = (PolyfitSelectFold*)block;
+	double** ptrs = (double**)(f + folds + 1);
+	double* d = (double*)(ptrs + (size_t)(folds + 1) * n);
+	for (int k = 0; k <= folds; k++) {
+		f[k].L = ptrs + (size_t)k * n;
+		f[k].sums = d;     d += n_sums;
+		f[k].moments = d;  d += n;
+		f[k].tsums = d;    d += n_sums;
+		f[k].ATy = d;      d += n;
+		for (int j = 0; j < n; j++, d += n) f[k].L[j] = d;
+		f[k].c = d;        d += (size_t)max_deg * n;
+		f[k].sse = d;      d += max_deg;
+	}
 
-	// Solve ATA * coeffs = ATy using Gaussian elimination
-	gaussianElimination(ATA, ATy, coeffs, n);
+	PolyfitSelectJob job = {x, y, size, max_deg, folds, cv ? 0 : folds, f};
+#if IS_HAS_THREADPOOL
+	ThreadPool::shared().parallelFor(folds, polyfitSelectSums, &job, max_threads);
+	ThreadPool::shared().parallelFor(folds + 1 - job.first, polyfitSelectFit, &job, max_threads);
+#else
+	(void)max_threads;
+	for (int k = 0; k < folds; k++) polyfitSelectSums(k, &job);
+	for (int t = 0; t < folds + 1 - job.first; t++) polyfitSelectFit(t, &job);
+#endif
 
-	// Reverse the coefficients for consistency with polynomial representation
-	for (int i = 0; i < n / 2; i++) {
-		double temp = coeffs[i];
-		coeffs[i] = coeffs[n - 1 - i];
-		coeffs[n - 1 - i] = temp;
+	// pick the degree with the lowest criterion
+	PolyfitSelectFold& full = f[folds];
+	if (full.status == SOLVE_NOT_POSITIVE_DEFINITE) { // can't happen for real data
+		free(block);
+		return -1;
 	}
+	int best = -1;
+	double best_score = HUGE_VAL;
+	double pivot_min = HUGE_VAL, pivot_max = 0; // over the leading block, for each degree's status
+	bool deficient = false;
+	for (int j = 0; j < n; j++) {
+		double p = full.L[j][j] * full.L[j][j];
+		if (p == 0) deficient = true;
+		if (p != 0 && p < pivot_min) pivot_min = p;
+		if (p > pivot_max) pivot_max = p;
+		if (j == 0) continue;
 
-	// Free dynamically allocated memory
-	for (int i = 0; i < size; i++) { free(A[i]); }
-	free(A);
+		int deg = j;
+		double rss = full.sse[deg - 1];
+		double cv_sse = 0;
+		for (int k = 0; cv && k < folds; k++) cv_sse += f[k].sse[deg - 1];
+		double log_mse = log(rss / size > DBL_MIN ? rss / size : DBL_MIN);
 
-	for (int i = 0; i < n; i++) { free(AT[i]); }
-	free(AT);
+		PolyfitDegreeStats st;
+		st.deg = deg;
+		st.status = deficient ? SOLVE_RANK_DEFICIENT : (pivot_min / pivot_max < MATRICES_RCOND_WARN ? SOLVE_ILL_CONDITIONED : SOLVE_OK);
+		st.rmse = sqrt(rss / size);
+		st.cv_rmse = cv ? sqrt(cv_sse / size) : 0;
+		st.aic = size * log_mse + 2.0 * (deg + 1);
+		st.bic = size * log_mse + log((double)size) * (deg + 1);
+		if (stats) stats[deg - 1] = st;
 
-	for (int i = 0; i < n; i++) { free(ATA[i]); }
-	free(ATA);
+		double score = criterion == POLYFIT_CV ? st.cv_rmse : (criterion == POLYFIT_AIC ? st.aic : st.bic);
+		if (score < best_score) {
+			best_score = score;
+			best = deg;
+		}
+	}
 
-	free(ATy);
+	if (best > 0) {
+		for (int j = 0; j <= best; j++) coeffs[j] = full.c[(best - 1) * n + j];
+		reverseCoeffs(coeffs, best + 1);
+	}
+	free(block);
+	return best;
 }
 
-} // end namespace
\ No newline at end of file
+} // end namespace
@@ -5,6 +5,14 @@
  * @brief polynomial fitting and related functions
  */
 
+#include "matrices.h"
+
+#if __cplusplus >= 201402L
+#define IS_CONSTEXPR14 constexpr ///< for functions with loops, which C++11 (e.g. avr-gcc's default) can't make constexpr
+#else
+#define IS_CONSTEXPR14
+#endif
+
 namespace is {
 
 /**
@@ -15,7 +23,434 @@ namespace is {
  * @param size The number of sample points
  * @param deg The degree of the fitting polynomial
  * @param coeffs The array to store the resulting polynomial coefficients
+ * @return SolveStatus of the normal equations' Cholesky solve (e.g. SOLVE_RANK_DEFICIENT if there
+ * are fewer distinct x than coefficients)
+ */
+SolveStatus polyfit(double* x, double* y, int size, int deg, double* coeffs);
+
+/**
+ * @brief polyfit() of several data sets that share the same x-coordinates. The normal equations
+ * are built and factored once, then solved for each set.
+ * 
+ * @param ys ys[0]...ys[n_ys-1] are the y-coordinates of each data set (size each)
+ * @param n_ys The number of data sets
+ * @param coeffs coeffs[0]...coeffs[n_ys-1] receive each set's coefficients (deg + 1 each)
+ */
+SolveStatus polyfitMany(double* x, double** ys, int n_ys, int size, int deg, double** coeffs);
+
+/**
+ * Preallocated scratch memory for the polyfit functions (one malloc, in the constructor), so that
+ * repeated fits, and every iteration of polyfitRobust(), allocate nothing. The fits it is passed to
+ * must have deg <= max_deg, and for polyfitRobust() size <= max_size.
+ */
+class PolyfitWorkspace {
+ public:
+	int _max_deg;
+	int _max_size;
+	void* _block = nullptr;    // everything below lives in this one allocation
+	double** _ATA;             // (max_deg+1) x (max_deg+1) normal matrix, then its Cholesky factor
+	double* _ATy;              // max_deg+1
+	double* _sums;             // 2*max_deg+1 weighted power sums
+	double* _coeffs_prev;      // max_deg+1, polyfitRobust() convergence test
+	double* _weights;          // max_size robust weights (0...1) from the last polyfitRobust()
+	double* _scratch;          // max_size, for the median of the residuals
+	int _iterations = 0;
+	double _scale = 0;
+
+	/**
+	 * @param max_deg the highest degree that will be fitted
+	 * @param max_size (default=0) the most points polyfitRobust() will be given (0 if it isn't used)
+	 */
+	PolyfitWorkspace(int max_deg, int max_size=0);
+	~PolyfitWorkspace();
+	PolyfitWorkspace(const PolyfitWorkspace&) = delete;
+	PolyfitWorkspace& operator=(const PolyfitWorkspace&) = delete;
+
+	/// @return bool false if the allocation failed
+	bool valid() const { return _block != nullptr; }
+
+	/// @return bool true if a fit of size points and degree deg (robust if robust) fits in this workspace
+	bool fits(int size, int deg, bool robust=false) const { return valid() && deg <= _max_deg && (!robust || size <= _max_size); }
+
+	/// @return const double* each point's robust weight (0 = rejected, 1 = fully trusted) from the last polyfitRobust()
+	const double* robustWeights() const { return _weights; }
+
+	/// @return int IRLS iterations the last polyfitRobust() took
+	int iterations() const { return _iterations; }
+
+	/// @return double the robust residual scale (1.4826 * median absolute residual) from the last polyfitRobust()
+	double scale() const { return _scale; }
+};
+
+/**
+ * @brief Weighted least-squares fit of a polynomial, like numpy's polyfit(x, y, deg, w=w): minimizes
+ * sum((w[i] * (y[i] - p(x[i])))^2), so for Gaussian noise use w[i] = 1/sigma[i].
+ * 
+ * @param w The weights (size), or nullptr for an unweighted fit
+ * @param ws (optional) scratch memory for fits that shouldn't allocate; if nullptr one is allocated
+ * for the call
+ * @return SolveStatus as polyfit()
+ */
+SolveStatus polyfitWeighted(double* x, double* y, double* w, int size, int deg, double* coeffs, PolyfitWorkspace* ws=nullptr);
+
+enum PolyfitLoss {
+	POLYFIT_HUBER,  ///< large residuals are down-weighted (linear, not quadratic, loss): tolerates noise with heavy tails
+	POLYFIT_TUKEY   ///< residuals beyond the tuning constant get weight 0: rejects glitches outright
+};
+
+/**
+ * @brief Robust polynomial fit by iteratively reweighted least squares (IRLS). Starting from the
+ * (weighted) least-squares fit, each iteration scales the residuals by a robust estimate of their
+ * spread (1.4826 * their median absolute value), turns them into weights with the loss function,
+ * and refits, until the coefficients stop changing. Afterwards ws.robustWeights() shows which
+ * points were down-weighted or rejected. Everything happens in ws: no allocation.
+ * 
+ * @param w The weights (size) as polyfitWeighted(), or nullptr
+ * @param ws scratch memory; ws.fits(size, deg, true) must be true
+ * @param loss (default=POLYFIT_HUBER)
+ * @param tuning (default=0) the loss's tuning constant in units of the residual scale; 0 uses
+ * 1.345 for Huber and 4.685 for Tukey (95% efficiency for Gaussian noise)
+ * @param max_iter (default=20) the most reweighting iterations
+ * @param tol (default=1e-8) stop once no coefficient changes by more than tol * (largest coefficient)
+ * @return SolveStatus of the last solve (SOLVE_NOT_POSITIVE_DEFINITE if the workspace is too small)
+ */
+SolveStatus polyfitRobust(double* x, double* y, double* w, int size, int deg, double* coeffs, PolyfitWorkspace& ws,
+	PolyfitLoss loss=POLYFIT_HUBER, double tuning=0, int max_iter=20, double tol=1e-8);
+
+enum PolyfitCriterion {
+	POLYFIT_CV,   ///< k-fold cross-validated RMS prediction error
+	POLYFIT_AIC,  ///< Akaike information criterion: size*ln(RSS/size) + 2*(deg+1)
+	POLYFIT_BIC   ///< Bayesian information criterion: size*ln(RSS/size) + ln(size)*(deg+1) (favors lower degrees)
+};
+
+/// @brief per-degree results from polyfitSelect()
+struct PolyfitDegreeStats {
+	int deg;
+	SolveStatus status;  ///< of the fit to all the data
+	double rmse;         ///< RMS residual of the fit to all the data
+	double cv_rmse;      ///< k-fold cross-validated RMS prediction error (0 unless POLYFIT_CV)
+	double aic;
+	double bic;
+};
+
+/**
+ * @brief fits degrees 1...max_deg and returns the one with the best criterion (lowest; ties go
+ * to the lower degree).
+ * 
+ * The weighted power sums are accumulated once per fold and shared by every degree: the normal
+ * matrix of degree d is the leading (d+1) x (d+1) block of the max_deg one, and so is its Cholesky
+ * factor, so each fold is factored once and solved per degree. Point i is in fold i % folds, so
+ * folds interleave along sorted x rather than leaving gaps to extrapolate across. On the host the
+ * folds run on ThreadPool::shared().
+ * 
+ * @param coeffs receives the chosen degree's coefficients, highest power first (room for max_deg + 1)
+ * @param stats (optional) receives max_deg entries, for degrees 1...max_deg
+ * @param criterion (default=POLYFIT_CV)
+ * @param folds (default=5) for POLYFIT_CV, clamped to 2...size
+ * @param max_threads (default=0) if >0, run the folds on at most this many threads
+ * @return int the chosen degree, or -1 if size <= 1 or max_deg < 1 (or allocation failed)
+ */
+int polyfitSelect(double* x, double* y, int size, int max_deg, double* coeffs, PolyfitDegreeStats* stats=nullptr,
+	PolyfitCriterion criterion=POLYFIT_CV, int folds=5, int max_threads=0);
+
+/**
+ * @brief Evaluates a polynomial at x using Horner's method (like numpy's polyval)
+ * 
+ * @param coeffs The polynomial coefficients, highest power first (as returned by polyfit)
+ * @param deg The degree of the polynomial (coeffs has deg + 1 elements)
+ * @param x The point at which to evaluate the polynomial
+ * @return double The value of the polynomial at x
+ */
+template <typename T>
+IS_CONSTEXPR14 T polyval(const T* coeffs, int deg, T x) {
+	T y = coeffs[0];
+	for (int i = 1; i <= deg; i++) y = y * x + coeffs[i];
+	return y;
+}
+
+/**
+ * @brief Evaluates a polynomial and its first derivative at x in one Horner pass
+ * 
+ * @param dy receives the derivative at x
+ * @return T The value of the polynomial at x
+ */
+template <typename T>
+T polyvalDeriv(const T* coeffs, int deg, T x, T* dy) {
+	T y = coeffs[0], d = 0;
+	for (int i = 1; i <= deg; i++) {
+		d = d * x + y;
+		y = y * x + coeffs[i];
+	}
+	*dy = d;
+	return y;
+}
+
+//**** polynomial algebra ****************************************************
+
+/*
+	Operations on coefficient arrays (highest power first, like polyval()), so that a fit can be
+	transformed instead of refitted: e.g. when a channel's gain or offset changes, polyAffine() gives
+	the curve in the new units in O(deg^2) instead of an O(size * deg^2) polyfit(). Unless noted,
+	out may be the same array as the input.
+*/
+
+/**
+ * @brief Taylor shift: out(x) = p(x + a), by repeated synthetic division (Horner) by (x - a)
+ * 
+ * @param out receives deg + 1 coefficients (may be coeffs)
  */
-void polyfit(double* x, double* y, int size, int deg, double* coeffs);
+template <typename T>
+IS_CONSTEXPR14 void polyShift(const T* coeffs, int deg, T a, T* out) {
+	if (out != coeffs) for (int i = 0; i <= deg; i++) out[i] = coeffs[i];
+	// after pass k, out[deg - k] is the k-th Taylor coefficient p^(k)(a) / k!
+	for (int k = 0; k < deg; k++) {
+		for (int i = 1; i <= deg - k; i++) out[i] += a * out[i - 1];
+	}
+}
+
+/**
+ * @brief scales the variable: out(x) = p(s * x)
+ * 
+ * @param out receives deg + 1 coefficients (may be coeffs)
+ */
+template <typename T>
+IS_CONSTEXPR14 void polyScale(const T* coeffs, int deg, T s, T* out) {
+	T s_k = 1;
+	for (int i = deg; i >= 0; i--) {
+		out[i] = coeffs[i] * s_k;
+		s_k *= s;
+	}
+}
+
+/**
+ * @brief affine change of variable: out(x) = p(s * x + a), i.e. polyShift() by a then polyScale()
+ * by s. For a curve p(v) fitted in old units where v = s * v_new + a, out is the same curve in new
+ * units.
+ * 
+ * @param out receives deg + 1 coefficients (may be coeffs)
+ */
+template <typename T>
+IS_CONSTEXPR14 void polyAffine(const T* coeffs, int deg, T s, T a, T* out) {
+	polyShift(coeffs, deg, a, out);
+	polyScale(out, deg, s, out);
+}
+
+/**
+ * @brief derivative: out = p'
+ * 
+ * @param out receives max(deg, 1) coefficients (may be coeffs)
+ * @return int the derivative's degree: deg - 1, or 0 for a constant (out = {0})
+ */
+template <typename T>
+IS_CONSTEXPR14 int polyDeriv(const T* coeffs, int deg, T* out) {
+	if (deg < 1) {
+		out[0] = 0;
+		return 0;
+	}
+	for (int i = 0; i < deg; i++) out[i] = coeffs[i] * (T)(deg - i);
+	return deg - 1;
+}
+
+/**
+ * @brief antiderivative: out = the integral of p, with out(0) = c
+ * 
+ * @param out receives deg + 2 coefficients (may be coeffs if it has room)
+ * @param c (default=0) the constant of integration
+ * @return int the integral's degree, deg + 1
+ */
+template <typename T>
+IS_CONSTEXPR14 int polyInteg(const T* coeffs, int deg, T* out, T c=0) {
+	for (int i = deg; i >= 0; i--) out[i] = coeffs[i] / (T)(deg + 1 - i); // backwards so out may be coeffs
+	out[deg + 1] = c;
+	return deg + 1;
+}
+
+/**
+ * @brief sum: out = p + q (aligned at the constant term)
+ * 
+ * @param out receives max(deg_p, deg_q) + 1 coefficients (may be p or q, if it is the longer one)
+ * @return int the sum's degree, max(deg_p, deg_q) (leading zeros aren't trimmed)
+ */
+template <typename T>
+IS_CONSTEXPR14 int polyAdd(const T* p, int deg_p, const T* q, int deg_q, T* out) {
+	int deg = deg_p > deg_q ? deg_p : deg_q;
+	for (int i = deg; i >= 0; i--) { // constant term first so out may be the longer input
+		int ip = i - (deg - deg_p), iq = i - (deg - deg_q);
+		out[i] = (ip >= 0 ? p[ip] : (T)0) + (iq >= 0 ? q[iq] : (T)0);
+	}
+	return deg;
+}
+
+/**
+ * @brief product: out = p * q (convolution of the coefficients)
+ * 
+ * @param out receives deg_p + deg_q + 1 coefficients. It may be p (if it has room) but not q.
+ * @return int the product's degree, deg_p + deg_q
+ */
+template <typename T>
+IS_CONSTEXPR14 int polyMul(const T* p, int deg_p, const T* q, int deg_q, T* out) {
+	int deg = deg_p + deg_q;
+	// out[k] only needs p[k - deg_q]...p[k], so filling it from the constant term up lets out be p
+	for (int k = deg; k >= 0; k--) {
+		T sum = 0;
+		int i_lo = k - deg_q > 0 ? k - deg_q : 0, i_hi = k < deg_p ? k : deg_p;
+		for (int i = i_lo; i <= i_hi; i++) sum += p[i] * q[k - i];
+		out[k] = sum;
+	}
+	return deg;
+}
+
+/**
+ * @brief composition: out(x) = p(q(x)), by Horner's method with polynomial steps
+ * 
+ * @param out receives deg_p * deg_q + 1 coefficients (may not be p or q)
+ * @return int the composition's degree, deg_p * deg_q
+ */
+template <typename T>
+IS_CONSTEXPR14 int polyCompose(const T* p, int deg_p, const T* q, int deg_q, T* out) {
+	out[0] = p[0];
+	int deg = 0;
+	for (int i = 1; i <= deg_p; i++) {
+		deg = polyMul(out, deg, q, deg_q, out);
+		out[deg] += p[i];
+	}
+	return deg;
+}
+
+enum PolyInverseStatus {
+	INVERSE_OK = 0,
+	INVERSE_NOT_MONOTONIC,  ///< the derivative changes sign in the domain: the table covers the longest monotonic part
+	INVERSE_INVALID         ///< no usable domain (x_max <= x_min, size < 2, degree < 1 or a flat polynomial)
+};
+
+/**
+ * Inverse of a polynomial over a domain: solve() returns the x in [xMin(), xMax()] where p(x) = y.
+ * build() checks that p is monotonic over the domain, then tabulates x at evenly spaced y (found
+ * by bisection, so building is slow but exact). solve() interpolates the table in O(1) and refines
+ * with newton_steps Newton steps using p and p' from one Horner pass, so its error falls
+ * quadratically per step from the table's interpolation error.
+ * 
+ * If p isn't monotonic over the requested domain, build() returns INVERSE_NOT_MONOTONIC with the
+ * x where the derivative first changes sign (located to 1/(8*size) of the domain), and tabulates
+ * the longest monotonic part of the domain instead, which xMin()/xMax() then report.
+ *
+ * @tparam T the numeric type of the coefficients and table (normally float or double)
+ */
+template <typename T>
+class PolyInverse {
+ public:
+	T * _coeffs = nullptr;   // highest power first
+	int _deg = -1;
+	T * _x_table = nullptr;  // x at y = _y_first + i * (_y_last - _y_first) / (_size - 1)
+	int _size = 0;
+	T _x_min = 0, _x_max = 0;
+	T _y_first = 0, _y_last = 0, _y_step_inv = 0;
+	int _newton_steps = 2;
+
+	PolyInverse() {}
+
+	~PolyInverse() {
+		delete[] _coeffs;
+		delete[] _x_table;
+	}
+
+	PolyInverse(const PolyInverse&) = delete;
+	PolyInverse& operator=(const PolyInverse&) = delete;
+
+	/**
+	 * @brief tabulates the inverse of the polynomial coeffs (highest power first) over x_min...x_max
+	 * 
+	 * @param size number of table entries (more entries: a better first guess for Newton)
+	 * @param newton_steps (default=2) refinement steps per solve()
+	 * @param at_x (default=nullptr) if not null and the result is INVERSE_NOT_MONOTONIC, receives
+	 * where monotonicity first breaks
+	 * @return PolyInverseStatus (nothing is changed if INVERSE_INVALID)
+	 */
+	PolyInverseStatus build(const T * coeffs, int deg, T x_min, T x_max, int size, int newton_steps=2, T * at_x=nullptr) {
+		if (!(x_max > x_min) || size < 2 || deg < 1) return INVERSE_INVALID;
+
+		// find the sign changes of p' on a fine grid and keep the longest monotonic run
+		PolyInverseStatus status = INVERSE_OK;
+		int n_checks = 8 * size;
+		T step = (x_max - x_min) / n_checks;
+		T run_start = x_min, best_lo = x_min, best_hi = x_min;
+		int run_sign = 0;
+		for (int i = 0; i <= n_checks; i++) {
+			T x = i == n_checks ? x_max : x_min + i * step, d;
+			polyvalDeriv(coeffs, deg, x, &d);
+			int sign = d > 0 ? 1 : (d < 0 ? -1 : 0);
+			if (sign && run_sign && sign != run_sign) {
+				if (status == INVERSE_OK && at_x) *at_x = x - step / 2;
+				status = INVERSE_NOT_MONOTONIC;
+				run_start = x; // the turning point is between the previous sample and this one
+			}
+			if (sign) run_sign = sign;
+			if (x - run_start > best_hi - best_lo) { best_lo = run_start; best_hi = x; }
+		}
+		if (!run_sign || !(best_hi > best_lo)) return INVERSE_INVALID;
+
+		if (deg != _deg) {
+			delete[] _coeffs;
+			_coeffs = new T[deg + 1];
+			_deg = deg;
+		}
+		for (int i = 0; i <= deg; i++) _coeffs[i] = coeffs[i];
+		if (size != _size) {
+			delete[] _x_table;
+			_x_table = new T[size];
+			_size = size;
+		}
+		_x_min = best_lo;
+		_x_max = best_hi;
+		_newton_steps = newton_steps;
+		_y_first = polyval(_coeffs, _deg, _x_min);
+		_y_last = polyval(_coeffs, _deg, _x_max);
+		_y_step_inv = (size - 1) / (_y_last - _y_first);
+
+		bool increasing = _y_last > _y_first;
+		for (int i = 0; i < size; i++) {
+			T y = _y_first + (_y_last - _y_first) * i / (size - 1);
+			T lo = _x_min, hi = _x_max;
+			for (int k = 0; k < 64 && lo < hi; k++) {
+				T mid = lo + (hi - lo) / 2;
+				if (mid <= lo || mid >= hi) break; // no more resolution in T
+				if ((polyval(_coeffs, _deg, mid) < y) == increasing) lo = mid;
+				else hi = mid;
+			}
+			_x_table[i] = lo + (hi - lo) / 2;
+		}
+		_x_table[0] = _x_min;
+		_x_table[size - 1] = _x_max;
+		return status;
+	}
+
+	T xMin() const { return _x_min; }
+
+	T xMax() const { return _x_max; }
+
+	/**
+	 * @brief the x in [xMin(), xMax()] where p(x) = y. y beyond the curve's range returns the
+	 * nearer end of the domain. build() must have succeeded.
+	 */
+	T solve(T y) const {
+		T pos = (y - _y_first) * _y_step_inv;
+		if (!(pos > 0)) return _x_min;
+		if (pos >= _size - 1) return _x_max;
+		int i = (int)pos;
+		T x = _x_table[i] + (pos - i) * (_x_table[i + 1] - _x_table[i]);
+		for (int k = 0; k < _newton_steps; k++) {
+			T d;
+			T err = polyvalDeriv(_coeffs, _deg, x, &d) - y;
+			if (d == 0) break;
+			x -= err / d;
+		}
+		return x < _x_min ? _x_min : (x > _x_max ? _x_max : x);
+	}
+
+	/// @brief solve() of n targets
+	void solveBlock(const T * y, T * x, int n) const {
+		for (int i = 0; i < n; i++) x[i] = solve(y[i]);
+	}
+};
 
 } // end namespace
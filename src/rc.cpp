@@ -1,3 +1,5 @@
+#include "rc.h"
+#include "approx.h"
 
 #include <math.h> // for: log, exp
 // NOTE: double log(double) performs natural log only: it might as well be called ln
@@ -10,4 +12,12 @@ double nTauOfPcnt01(double pcnt01) {
 double pcnt01OfnTau(double ntau) {
 	// note that exp is e^(its_argument)
 	return 1 - exp(-ntau);
-}
\ No newline at end of file
+}
+
+float nTauOfPcnt01Fast(float pcnt01) {
+	return -logApprox(1 - pcnt01);
+}
+
+float pcnt01OfnTauFast(float ntau) {
+	return 1 - expApprox(-ntau);
+}
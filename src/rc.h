@@ -28,3 +28,16 @@ double nTauOfPcnt01(double pcnt01);
  * @return double of percent complete as 0...1, i.e. (v_now-v_start)/(v_goal-v_start)
  */
 double pcnt01OfnTau(double ntau);
+
+/**
+ * @brief nTauOfPcnt01() in float using logApprox() (approx.h): absolute error under
+ * APPROX_NTAUOFPCNT01_MAX_ERROR (approx_coeffs.h) for pcnt01 in 0...0.999, and much faster than
+ * libm's log on targets without an FPU.
+ */
+float nTauOfPcnt01Fast(float pcnt01);
+
+/**
+ * @brief pcnt01OfnTau() in float using expApprox() (approx.h): absolute error under
+ * APPROX_PCNT01OFNTAU_MAX_ERROR (approx_coeffs.h) for ntau >= 0.
+ */
+float pcnt01OfnTauFast(float ntau);
@@ -1,11 +1,30 @@
 #include "sigmoid.h"
+#include "approx.h"
+#include "cpu_dispatch.h"
+#include "cpu_kernels.h"
 
 #include <math.h>
 
-double sigmoid(double x, double x_val_at_y_eq_0p5=0.5, double steepness=10.0) {
+double sigmoid(double x, double x_val_at_y_eq_0p5, double steepness) {
 	return 1.0 / (1.0 + exp(-fabs(steepness) * (x - x_val_at_y_eq_0p5)));
 }
 
-double sigmoid_n1_p1(double x, double steepness=5.7) {
+double sigmoid_n1_p1(double x, double steepness) {
 	return 2.0 / (1.0 + exp(-fabs(steepness) * x)) - 1.0;
 }
+
+float sigmoidFast(float x, float x_val_at_y_eq_0p5, float steepness) {
+	return 1.0f / (1.0f + expApprox(-fabsf(steepness) * (x - x_val_at_y_eq_0p5)));
+}
+
+float sigmoid_n1_p1Fast(float x, float steepness) {
+	return 2.0f / (1.0f + expApprox(-fabsf(steepness) * x)) - 1.0f;
+}
+
+void sigmoidBlock(const float* x, float* y, int n, float x_val_at_y_eq_0p5, float steepness) {
+#if IS_HAS_CPU_DISPATCH
+	cpuKernels().sigmoidBlock(x, y, n, x_val_at_y_eq_0p5, steepness);
+#else
+	is::sigmoidBlockKernel(x, y, n, x_val_at_y_eq_0p5, steepness);
+#endif
+}
@@ -21,4 +21,22 @@ double sigmoid(double x, double x_val_at_y_eq_0p5 = 0.5, double steepness = 10.0
  */
 double sigmoid_n1_p1(double x, double steepness = 5.7);
 
+/**
+ * @brief sigmoid() in float using expApprox() (approx.h): absolute error under
+ * APPROX_SIGMOID_MAX_ERROR (approx_coeffs.h), and much faster than libm's exp on targets without
+ * an FPU.
+ */
+float sigmoidFast(float x, float x_val_at_y_eq_0p5 = 0.5f, float steepness = 10.0f);
+
+/// @brief sigmoid_n1_p1() in float using expApprox(): absolute error under APPROX_SIGMOID_N1_P1_MAX_ERROR
+float sigmoid_n1_p1Fast(float x, float steepness = 5.7f);
 
+/**
+ * @brief sigmoidFast() of n inputs, branch-free so it vectorizes (on x86 hosts with the best
+ * instruction set available, see cpu_dispatch.h). Inputs more than ~87/steepness from
+ * x_val_at_y_eq_0p5 saturate to within 1e-38 of 0 or 1.
+ * 
+ * @param x Input values (n).
+ * @param y Output values (n), may be x.
+ */
+void sigmoidBlock(const float* x, float* y, int n, float x_val_at_y_eq_0p5 = 0.5f, float steepness = 10.0f);
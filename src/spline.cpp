@@ -0,0 +1,142 @@
+#include <stdlib.h>
+#include "spline.h"
+
+namespace is {
+
+static bool strictlyIncreasing(const double* x, int n) {
+	for (int i = 1; i < n; i++) {
+		if (!(x[i] > x[i - 1])) return false;
+	}
+	return true;
+}
+
+// segment coefficients from the values f and second derivatives M at the knots
+static void segmentsFromSecondDerivatives(const double* x, const double* f, const double* M, int n, double* coeffs) {
+	for (int i = 0; i < n - 1; i++) {
+		double h = x[i + 1] - x[i];
+		double* c = coeffs + 4 * i;
+		c[0] = f[i];
+		c[1] = (f[i + 1] - f[i]) / h - h * (2 * M[i] + M[i + 1]) / 6;
+		c[2] = M[i] / 2;
+		c[3] = (M[i + 1] - M[i]) / (6 * h);
+	}
+}
+
+bool splineInterpolate(const double* x, const double* y, int n, double* coeffs, SplineBoundary boundary, double dy0, double dyn) {
+	if (n < 2 || !strictlyIncreasing(x, n)) return false;
+	double* work = (double*)malloc(4 * n * sizeof(double));
+	if (!work) return false;
+	double* sub = work;
+	double* diag = work + n;
+	double* sup = work + 2 * n;
+	double* M = work + 3 * n; // right-hand side, then the second derivatives
+
+	// h[i-1]*M[i-1] + 2*(h[i-1] + h[i])*M[i] + h[i]*M[i+1] = 6*(slope[i] - slope[i-1])
+	for (int i = 1; i < n - 1; i++) {
+		double h0 = x[i] - x[i - 1], h1 = x[i + 1] - x[i];
+		sub[i] = h0;
+		diag[i] = 2 * (h0 + h1);
+		sup[i] = h1;
+		M[i] = 6 * ((y[i + 1] - y[i]) / h1 - (y[i] - y[i - 1]) / h0);
+	}
+	double h_first = x[1] - x[0], h_last = x[n - 1] - x[n - 2];
+	sub[0] = sup[n - 1] = 0;
+	if (boundary == SPLINE_CLAMPED) {
+		diag[0] = 2 * h_first;
+		sup[0] = h_first;
+		M[0] = 6 * ((y[1] - y[0]) / h_first - dy0);
+		sub[n - 1] = h_last;
+		diag[n - 1] = 2 * h_last;
+		M[n - 1] = 6 * (dyn - (y[n - 1] - y[n - 2]) / h_last);
+	} else { // natural: M[0] = M[n-1] = 0
+		diag[0] = diag[n - 1] = 1;
+		sup[0] = sub[n - 1] = 0;
+		M[0] = M[n - 1] = 0;
+	}
+	tridiagonalSolve(sub, diag, sup, M, n); // diagonally dominant, so every pivot is > 0
+
+	segmentsFromSecondDerivatives(x, y, M, n, coeffs);
+	free(work);
+	return true;
+}
+
+/*
+	Reinsch's algorithm (see Green & Silverman, "Nonparametric Regression and Generalized Linear
+	Models", 2.3). With h[i] = x[i+1] - x[i] and gamma the second derivatives at the interior knots,
+	Q (n x (n-2)) and R ((n-2) x (n-2), tridiagonal) are
+		Q[j][j] = 1/h[j],  Q[j+1][j] = -1/h[j] - 1/h[j+1],  Q[j+2][j] = 1/h[j+1]
+		R[j][j] = (h[j] + h[j+1])/3,  R[j][j+1] = R[j+1][j] = h[j+1]/6
+	and the smoothing spline's values g and gamma solve
+		(R + lambda * Q^T * W^-1 * Q) * gamma = Q^T * y,   g = y - lambda * W^-1 * Q * gamma
+	where W = diag(w^2). The matrix is pentadiagonal and SPD, factored below as L*D*L^T with L unit
+	lower triangular with two subdiagonals (u, v).
+*/
+bool splineSmooth(const double* x, const double* y, const double* w, int n, double lambda, double* coeffs) {
+	if (n < 3 || !strictlyIncreasing(x, n)) return false;
+	for (int i = 0; w && i < n; i++) {
+		if (!(w[i] > 0)) return false;
+	}
+	int m = n - 2;
+	double* work = (double*)malloc((6 * (size_t)m + 2 * n) * sizeof(double));
+	if (!work) return false;
+	double* q0 = work;          // Q[j][j]
+	double* q1 = q0 + m;        // Q[j+1][j]
+	double* q2 = q1 + m;        // Q[j+2][j]
+	double* D = q2 + m;         // the pentadiagonal matrix's diagonal, then the factor's D
+	double* u = D + m;          // its first off-diagonal, then the factor's L[j+1][j]
+	double* v = u + m;          // its second off-diagonal, then the factor's L[j+2][j]
+	double* g = v + m;          // n values, starts as Q^T*y (m), then gamma
+	double* M = g + n;          // n second derivatives
+	#define W_INV(i) (w ? 1 / (w[i] * w[i]) : 1.0)
+
+	for (int j = 0; j < m; j++) {
+		double h0 = x[j + 1] - x[j], h1 = x[j + 2] - x[j + 1];
+		q0[j] = 1 / h0;
+		q1[j] = -1 / h0 - 1 / h1;
+		q2[j] = 1 / h1;
+	}
+	for (int j = 0; j < m; j++) {
+		double h0 = x[j + 1] - x[j], h1 = x[j + 2] - x[j + 1];
+		D[j] = (h0 + h1) / 3 + lambda * (q0[j] * q0[j] * W_INV(j) + q1[j] * q1[j] * W_INV(j + 1) + q2[j] * q2[j] * W_INV(j + 2));
+		u[j] = j + 1 < m ? h1 / 6 + lambda * (q1[j] * q0[j + 1] * W_INV(j + 1) + q2[j] * q1[j + 1] * W_INV(j + 2)) : 0;
+		v[j] = j + 2 < m ? lambda * q2[j] * q0[j + 2] * W_INV(j + 2) : 0;
+		g[j] = q0[j] * y[j] + q1[j] * y[j + 1] + q2[j] * y[j + 2];
+	}
+
+	// banded LDL^T, in place: D[j] -= ..., u[j] = L[j+1][j], v[j] = L[j+2][j]
+	for (int j = 0; j < m; j++) {
+		if (j >= 1) D[j] -= u[j - 1] * u[j - 1] * D[j - 1];
+		if (j >= 2) D[j] -= v[j - 2] * v[j - 2] * D[j - 2];
+		if (j >= 1 && j + 1 < m) u[j] -= u[j - 1] * v[j - 1] * D[j - 1];
+		u[j] /= D[j];
+		v[j] /= D[j];
+	}
+	// solve for gamma (in g)
+	for (int j = 0; j < m; j++) {
+		if (j >= 1) g[j] -= u[j - 1] * g[j - 1];
+		if (j >= 2) g[j] -= v[j - 2] * g[j - 2];
+	}
+	for (int j = 0; j < m; j++) g[j] /= D[j];
+	for (int j = m - 1; j >= 0; j--) {
+		if (j + 1 < m) g[j] -= u[j] * g[j + 1];
+		if (j + 2 < m) g[j] -= v[j] * g[j + 2];
+	}
+
+	// second derivatives (0 at the ends: natural), then values g = y - lambda * W^-1 * Q * gamma
+	M[0] = M[n - 1] = 0;
+	for (int j = 0; j < m; j++) M[j + 1] = g[j];
+	for (int i = 0; i < n; i++) {
+		double Qgamma = 0;
+		if (i < m) Qgamma += q0[i] * M[i + 1];
+		if (i >= 1 && i - 1 < m) Qgamma += q1[i - 1] * M[i];
+		if (i >= 2) Qgamma += q2[i - 2] * M[i - 1];
+		g[i] = y[i] - lambda * W_INV(i) * Qgamma; // g[i] (i < m) was gamma[i] = M[i+1], already copied
+	}
+	#undef W_INV
+
+	segmentsFromSecondDerivatives(x, g, M, n, coeffs);
+	free(work);
+	return true;
+}
+
+} // end namespace
@@ -0,0 +1,190 @@
+#pragma once
+
+/**
+ * @file spline.h
+ * @brief cubic spline interpolation and smoothing, stored as contiguous per-segment polynomials
+ */
+
+#include <stdlib.h>
+#include <math.h>
+#include "matrices.h"
+
+namespace is {
+
+/*
+	A spline through knots x[0] < x[1] < ... < x[n-1] has n-1 segments. Segment i covers
+	x[i] <= x <= x[i+1] and is stored as 4 coefficients, lowest power first, in one contiguous block:
+		coeffs[4*i...4*i+3] = a, b, c, d    s(x) = a + t*(b + t*(c + t*d)),  t = x - x[i]
+	so evaluating touches one knot and one 32-byte (double) block. Both fitters solve for the second
+	derivatives at the knots with an O(n) banded solve and allocate their scratch memory once per fit.
+*/
+
+enum SplineBoundary {
+	SPLINE_NATURAL,  ///< zero second derivative at both ends
+	SPLINE_CLAMPED   ///< given first derivatives at both ends
+};
+
+/**
+ * @brief Interpolating cubic spline (passes through every point)
+ * 
+ * @param x The knots, strictly increasing (n)
+ * @param y The values at the knots (n)
+ * @param n The number of knots (at least 2)
+ * @param coeffs The segment coefficients (4 * (n - 1)), see above
+ * @param boundary (default=SPLINE_NATURAL)
+ * @param dy0 (default=0) the first derivative at x[0] (SPLINE_CLAMPED only)
+ * @param dyn (default=0) the first derivative at x[n-1] (SPLINE_CLAMPED only)
+ * @return bool false if n < 2, x isn't strictly increasing or the allocation failed
+ */
+bool splineInterpolate(const double* x, const double* y, int n, double* coeffs, SplineBoundary boundary=SPLINE_NATURAL, double dy0=0, double dyn=0);
+
+/**
+ * @brief Natural cubic smoothing spline (Reinsch): minimizes
+ * sum((w[i] * (y[i] - s(x[i])))^2) + lambda * integral(s''(x)^2 dx). lambda = 0 interpolates, and
+ * as lambda grows the spline tends to the least-squares straight line. lambda depends on the scales of
+ * x and y, so try values a decade apart. The system for the second derivatives is pentadiagonal and
+ * symmetric positive definite; it is solved by a banded LDL^T in O(n).
+ * 
+ * @param w The weights (n, like polyfitWeighted(): 1/sigma), or nullptr for all 1
+ * @param n The number of knots (at least 3)
+ * @return bool false if n < 3, x isn't strictly increasing, a weight isn't > 0 or the allocation failed
+ */
+bool splineSmooth(const double* x, const double* y, const double* w, int n, double lambda, double* coeffs);
+
+/**
+ * A fitted cubic spline ready for evaluation. The knots and segment coefficients are stored as T
+ * (normally float on a microcontroller, double on the host). If the knots are evenly spaced the
+ * segment holding x is found in O(1) by arithmetic, otherwise by binary search (O(log n)).
+ * Outside the knots the end segments' cubics are extrapolated.
+ *
+ * @tparam T the numeric type of the knots and coefficients
+ */
+template <typename T>
+class CubicSpline {
+ public:
+	T * _knots = nullptr;   // n_knots
+	T * _coeffs = nullptr;  // 4 * (n_knots - 1), see splineInterpolate()
+	int _n_knots = 0;
+	bool _uniform = false;  // evenly spaced knots: segment(x) is (x - _knots[0]) * _h_inv
+	T _h_inv = 0;
+
+	CubicSpline() {}
+
+	~CubicSpline() {
+		delete[] _knots;
+		delete[] _coeffs;
+	}
+
+	CubicSpline(const CubicSpline&) = delete;
+	CubicSpline& operator=(const CubicSpline&) = delete;
+
+	/// @brief fits an interpolating spline, see is::splineInterpolate()
+	bool interpolate(const double* x, const double* y, int n, SplineBoundary boundary=SPLINE_NATURAL, double dy0=0, double dyn=0) {
+		return _fit(x, n, [&](double* coeffs) { return splineInterpolate(x, y, n, coeffs, boundary, dy0, dyn); });
+	}
+
+	/// @brief fits a smoothing spline, see is::splineSmooth()
+	bool smooth(const double* x, const double* y, const double* w, int n, double lambda) {
+		return _fit(x, n, [&](double* coeffs) { return splineSmooth(x, y, w, n, lambda, coeffs); });
+	}
+
+	/// @brief copies knots (n) and segment coefficients (4 * (n - 1)) that were fitted elsewhere
+	bool setSegments(const double* x, const double* coeffs, int n) {
+		return _fit(x, n, [&](double* c) {
+			for (int i = 0; i < 4 * (n - 1); i++) c[i] = coeffs[i];
+			return true;
+		});
+	}
+
+	int knots() const { return _n_knots; }
+
+	int segments() const { return _n_knots - 1; }
+
+	/// @return int the segment x falls in, clamped to 0...segments()-1
+	int segment(T x) const {
+		int last = _n_knots - 2;
+		if (_uniform) {
+			T pos = (x - _knots[0]) * _h_inv;
+			if (!(pos > 0)) return 0;
+			return pos >= last ? last : (int)pos;
+		}
+		int lo = 0, hi = last;
+		while (lo < hi) { // the last segment whose knot is <= x
+			int mid = (lo + hi + 1) / 2;
+			if (_knots[mid] <= x) lo = mid;
+			else hi = mid - 1;
+		}
+		return lo;
+	}
+
+	/// @brief the spline's value at x. A spline must have been fitted.
+	T eval(T x) const {
+		return _evalSegment(segment(x), x);
+	}
+
+	/// @brief the spline's first derivative at x
+	T derivative(T x) const {
+		int i = segment(x);
+		const T * c = _coeffs + 4 * i;
+		T t = x - _knots[i];
+		return c[1] + t * (2 * c[2] + t * 3 * c[3]);
+	}
+
+	/**
+	 * @brief eval() of n points. With non-uniform knots the search starts from the previous
+	 * point's segment, so ascending (or clustered) x costs O(1) per point rather than O(log n).
+	 */
+	void evalBlock(const T * x, T * out, int n) const {
+		if (_uniform) {
+			for (int i = 0; i < n; i++) out[i] = _evalSegment(segment(x[i]), x[i]);
+			return;
+		}
+		int seg = 0, last = _n_knots - 2;
+		for (int i = 0; i < n; i++) {
+			T xi = x[i];
+			if (xi < _knots[seg] || (seg < last && _knots[seg + 1] <= xi)) {
+				if (seg < last && _knots[seg + 1] <= xi && (seg + 1 == last || xi < _knots[seg + 2])) seg++; // the next one
+				else seg = segment(xi);
+			}
+			out[i] = _evalSegment(seg, xi);
+		}
+	}
+
+	//**** internals *******************************************************
+
+	T _evalSegment(int i, T x) const {
+		const T * c = _coeffs + 4 * i;
+		T t = x - _knots[i];
+		return c[0] + t * (c[1] + t * (c[2] + t * c[3]));
+	}
+
+	// runs fitter(double coeffs[4*(n-1)]) and stores the knots and coefficients as T; nothing changes on failure
+	template <typename Fitter>
+	bool _fit(const double* x, int n, Fitter fitter) {
+		if (n < 2) return false;
+		double * coeffs = (double*)malloc(4 * (n - 1) * sizeof(double));
+		if (!coeffs) return false;
+		if (!fitter(coeffs)) {
+			free(coeffs);
+			return false;
+		}
+		if (n != _n_knots) {
+			delete[] _knots;
+			delete[] _coeffs;
+			_knots = new T[n];
+			_coeffs = new T[4 * (n - 1)];
+			_n_knots = n;
+		}
+		for (int i = 0; i < n; i++) _knots[i] = (T)x[i];
+		for (int i = 0; i < 4 * (n - 1); i++) _coeffs[i] = (T)coeffs[i];
+		free(coeffs);
+
+		double h = (x[n - 1] - x[0]) / (n - 1);
+		_uniform = true;
+		for (int i = 0; i < n - 1 && _uniform; i++) _uniform = fabs((x[i + 1] - x[i]) - h) <= 1e-6 * h;
+		_h_inv = (T)(1 / h);
+		return true;
+	}
+};
+
+} // end namespace
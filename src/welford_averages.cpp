@@ -0,0 +1,194 @@
+#include "welford_averages.h"
+#include "cpu_dispatch.h"
+#include "cpu_kernels.h"
+
+#include <math.h>
+#include <limits.h>
+
+//**** WelfordOnlineStats ****************************************************
+
+WelfordOnlineStats::WelfordOnlineStats() : _mean(0.0), m2(0.0), _count(0) {}
+
+void WelfordOnlineStats::update(float new_value) {
+	_count++;
+	float delta = new_value - _mean;
+	_mean += delta / _count;
+	float delta2 = new_value - _mean;
+	m2 += delta * delta2;
+}
+
+void WelfordOnlineStats::updateBlock(const float* values, int n) {
+	if (n <= 0) return;
+	float block_mean, block_m2;
+#if IS_HAS_CPU_DISPATCH
+	cpuKernels().blockMoments(values, n, &block_mean, &block_m2);
+#else
+	is::blockMomentsKernel<2 * IS_KERNEL_LANES>(values, n, &block_mean, &block_m2);
+#endif
+	unsigned long total = _count + n;
+	float delta = block_mean - _mean;
+	_mean += delta * ((float)n / total);
+	m2 += block_m2 + delta * delta * ((float)_count * n / total);
+	_count = total;
+}
+
+float WelfordOnlineStats::mean() const {
+	return _mean;
+}
+
+float WelfordOnlineStats::variance() const {
+	return (_count > 1) ? (m2 / (_count - 1)) : 0.0;
+}
+
+float WelfordOnlineStats::stddev() const {
+	return sqrt(variance());
+}
+
+float WelfordOnlineStats::standardError() const {
+	return (_count > 1) ? sqrt(variance() / _count) : 0.0;
+}
+
+unsigned long WelfordOnlineStats::count() const {
+	return _count;
+}
+
+void WelfordOnlineStats::clear() {
+	_mean = m2 = 0.0;
+	_count = 0;
+}
+
+//**** AdaptiveWelford *******************************************************
+
+AdaptiveWelford::AdaptiveWelford(float threshold) : count(0), _mean(0.0), m2(0.0), threshold(threshold) {
+	for(int i = 0; i < max_data_points; ++i) {
+		data_points[i] = 0.0;
+	}
+}
+
+void AdaptiveWelford::update(float new_value) {
+	if(count < max_data_points) {
+		data_points[count] = new_value;
+		count++;
+	} else {
+		// If the buffer is full, we can either ignore new values or implement a sliding window
+		// Here, we'll just replace the oldest value (simple FIFO buffer)
+		for(int i = 0; i < max_data_points - 1; ++i) {
+			data_points[i] = data_points[i + 1];
+		}
+		data_points[max_data_points - 1] = new_value;
+	}
+	recalculate();
+}
+
+void AdaptiveWelford::remove_outliers() {
+	float current_mean = _mean;
+	float current_stddev = stddev();
+	for(int i = 0; i < (int)count; ++i) {
+		if(fabs(data_points[i] - current_mean) > threshold * current_stddev) {
+			for(int j = i; j < (int)count - 1; ++j) {
+				data_points[j] = data_points[j + 1];
+			}
+			count--;
+			i--; // Re-check the new value at this index
+		}
+	}
+	recalculate();
+}
+
+float AdaptiveWelford::mean() const {
+	return _mean;
+}
+
+float AdaptiveWelford::variance() const {
+	return (count > 1) ? (m2 / (count - 1)) : 0.0;
+}
+
+float AdaptiveWelford::stddev() const {
+	return sqrt(variance());
+}
+
+void AdaptiveWelford::recalculate() {
+	_mean = 0.0;
+	m2 = 0.0;
+	for(int i = 0; i < (int)count; ++i) {
+		float delta = data_points[i] - _mean;
+		_mean += delta / (i + 1);
+		float delta2 = data_points[i] - _mean;
+		m2 += delta * delta2;
+	}
+}
+
+//**** DecayingAverage *******************************************************
+
+DecayingAverage::DecayingAverage(float alpha) : alpha(sigmoid(alpha)), average(0.0), datapoint_count(0), alpha_incr(0.0), min_datapoints_for_outlier(ULONG_MAX), outlier_min_delta(0.0), outlier_max_delta(0.0) {}
+
+void DecayingAverage::setAlpha(float alpha, float alpha_incr) {
+	this->alpha = sigmoid(alpha);
+	setAlphaIncr(alpha_incr);
+}
+
+void DecayingAverage::setAlphaIncr(float alpha_incr) {
+	if (alpha_incr == 0) {
+		this->alpha_incr = 0.0;
+	} else {
+		this->alpha_incr = sigmoid(alpha_incr, true);
+	}
+}
+
+void DecayingAverage::defineOutlierMinMax(float outlier_min_delta, float outlier_max_delta, unsigned long min_datapoints) {
+	this->min_datapoints_for_outlier = min_datapoints;
+	if (outlier_min_delta > outlier_max_delta) {
+		// Invalid input; reset
+		defineOutlierMinMax();
+	} else {
+		this->outlier_min_delta = outlier_min_delta;
+		this->outlier_max_delta = outlier_max_delta;
+	}
+}
+
+void DecayingAverage::clearAverage() {
+	average = 0.0;
+	datapoint_count = 0;
+}
+
+float DecayingAverage::getAverage() const {
+	return average;
+}
+
+float DecayingAverage::accumulate(float num) {
+	datapoint_count++;
+	if (datapoint_count == 1) {
+		average = num;
+		return average;
+	}
+	if (alpha_incr) alpha = sigmoid(alpha + alpha_incr);
+
+	float current_alpha = alpha;
+	if (datapoint_count >= min_datapoints_for_outlier) {
+		float delta = fabs(num - average);
+		if (delta > outlier_max_delta) {
+			datapoint_count--;
+			return average;
+		}
+		if (delta >= outlier_min_delta) {
+			float scaler = (delta - outlier_min_delta) / (outlier_max_delta - outlier_min_delta);
+			current_alpha *= scaler;
+		}
+	}
+	average = current_alpha * num + (1 - current_alpha) * average;
+	return average;
+}
+
+float DecayingAverage::sigmoid(float x, bool bipolar) const {
+	if (!bipolar) {
+		return 1.0 / (1.0 + exp(-10.0 * (x - 0.5)));
+	} else {
+		return 2.0 / (1.0 + exp(-5.7 * x)) - 1.0;
+	}
+}
+
+void DecayingAverage::defineOutlierMinMax() {
+	min_datapoints_for_outlier = ULONG_MAX;
+	outlier_min_delta = 0.0;
+	outlier_max_delta = 0.0;
+}
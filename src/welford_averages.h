@@ -1,5 +1,10 @@
 #pragma once
 
+/**
+ * @file welford_averages.h
+ * @brief online (streaming) averaging: Welford mean/variance and decaying averages
+ */
+
 /**
  * @brief Class to maintain online statistics (mean and variance) using Welford's Algorithm.
  * 
@@ -18,6 +23,16 @@ public:
 	 */
 	void update(float new_value);
 
+	/**
+	 * @brief Incorporates n data points at once: their mean and squared deviations are computed
+	 * in two vectorizable passes (on x86 hosts with the best instruction set available, see
+	 * cpu_dispatch.h), then merged with Chan's parallel formula. Same statistics as n update()s,
+	 * up to rounding (usually a little more accurate, since the block is summed in lanes).
+	 * @param values The data points.
+	 * @param n The number of data points.
+	 */
+	void updateBlock(const float* values, int n);
+
 	/**
 	 * @brief Gets the mean of the data stream seen so far.
 	 * @return The mean of the data stream.
@@ -38,10 +53,30 @@ public:
 	 */
 	float stddev() const;
 
+	/**
+	 * @brief Calculates and returns the standard error of the mean, i.e. stddev()/sqrt(count()). 
+	 * This shrinks as more data points are added, so it tells you how far the mean() is likely to be 
+	 * from the true mean, which makes it a good stopping condition for calibration loops.
+	 * 
+	 * @return The standard error of the mean (0 if less than 2 data points).
+	 */
+	float standardError() const;
+
+	/**
+	 * @brief Gets the number of data points seen so far.
+	 * @return The number of data points.
+	 */
+	unsigned long count() const;
+
+	/**
+	 * @brief Clears the statistics so the object can be reused for a new data stream.
+	 */
+	void clear();
+
 private:
 	float _mean;   ///< Mean of the data points
 	float m2;      ///< Sum of squared deviations from the mean
-	unsigned long count; ///< Number of data points seen so far
+	unsigned long _count; ///< Number of data points seen so far
 };
 
 /**
@@ -0,0 +1,248 @@
+/**************************************************************************************************
+* @file  approxgen.cpp
+*
+* @brief prints polynomial approximations (is::approxRemez / approxChebyshev) as C arrays
+***************************************************************************************************/
+
+/*
+	approxgen --library
+		regenerates src/approx_coeffs.h (the coefficients behind expApprox() and logApprox())
+	approxgen FUNC --min A --max B (--error E | --deg N) [--relative] [--chebyshev] [--float]
+		prints an approximation of one of the built-in functions below. For other functions call
+		is::approxToError() from your own host code.
+
+	Built with the host benchmarks: cmake --build build --target is_eeMath_approxgen
+*/
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <float.h>
+
+#include "approx.h"
+#include "rc.h"
+#include "sigmoid.h"
+
+struct NamedFunc {
+	const char* name;
+	is::ApproxFunc f;
+	const char* description;
+};
+
+static double fExp(double x) { return exp(x); }
+static double fLog(double x) { return log(x); }
+static double fPcnt01OfnTau(double x) { return pcnt01OfnTau(x); }
+static double fNTauOfPcnt01(double x) { return nTauOfPcnt01(x); }
+static double fSigmoid(double x) { return sigmoid(x, 0, 1); }
+static double fSin(double x) { return sin(x); }
+
+static const NamedFunc funcs[] = {
+	{"exp", fExp, "e^x"},
+	{"log", fLog, "ln(x)"},
+	{"pcnt01OfnTau", fPcnt01OfnTau, "1 - e^-x"},
+	{"nTauOfPcnt01", fNTauOfPcnt01, "-ln(1 - x)"},
+	{"sigmoid", fSigmoid, "1 / (1 + e^-x)"},
+	{"sin", fSin, "sin(x)"},
+};
+
+// v as a float literal (always with a '.' or exponent, and no "-0")
+static const char* floatLiteral(double v) {
+	static char buf[8][40];
+	static int next = 0;
+	char* b = buf[next++ % 8];
+	snprintf(b, 32, "%.9g", v == 0 ? 0.0 : v);
+	if (!strpbrk(b, ".e")) strcat(b, ".0");
+	strcat(b, "f");
+	return b;
+}
+
+static void printApprox(const char* name, const is::PolyApprox& a, const char* method, bool as_float) {
+	const char* type = as_float ? "float" : "double";
+	printf("// %s on [%.17g, %.17g]: degree %d %s, max %s error %.3g\n", name, a.x_min, a.x_max, a.deg, method,
+		a.error_type == is::APPROX_RELATIVE ? "relative" : "absolute", a.max_error);
+	printf("// evaluate: is::polyval(%s_coeffs, %d, x * %.17g + %.17g)\n", name, a.deg, a.t_scale, a.t_offset);
+	printf("static const %s %s_coeffs[%d] = {\n", type, name, a.deg + 1);
+	for (int i = 0; i <= a.deg; i++) {
+		if (as_float) printf("\t%s,\n", floatLiteral(a.coeffs[i]));
+		else printf("\t%.17g,\n", a.coeffs[i]);
+	}
+	printf("};\n");
+}
+
+//**** --library ***********************************************************
+
+// a library polynomial as approx_coeffs.h stores it: float coefficients, t_scale and t_offset
+struct FloatPoly {
+	int deg = 0;
+	float coeffs[APPROX_MAX_DEG + 1] = {0};
+	float t_scale = 1;
+	float t_offset = 0;
+	double double_error = 0; // of the polynomial in double, before rounding to float
+};
+
+static bool fitLibraryPoly(const char* prefix, is::ApproxFunc f, double x_min, double x_max, double target,
+	is::ApproxErrorType error_type, FloatPoly* out) {
+	is::PolyApprox a;
+	if (is::approxToError(f, x_min, x_max, target, &a, is::APPROX_REMEZ, error_type) < 0) {
+		fprintf(stderr, "approxgen: %s didn't reach %g\n", prefix, target);
+		return false;
+	}
+	out->deg = a.deg;
+	for (int i = 0; i <= a.deg; i++) out->coeffs[i] = (float)a.coeffs[i];
+	out->t_scale = (float)a.t_scale;
+	out->t_offset = (float)a.t_offset;
+	out->double_error = a.max_error;
+	return true;
+}
+
+static float expWith(const FloatPoly& p, float x) { return expApproxWith(x, p.coeffs, p.deg, p.t_scale, p.t_offset); }
+static float logWith(const FloatPoly& p, float x) { return logApproxWith(x, p.coeffs, p.deg, p.t_scale, p.t_offset); }
+
+/*
+	The MAX_ERRORs are measured, not derived: the library functions are evaluated in float, with
+	the float coefficients, through the same code as approx.h (the ...With() functions), compared
+	with libm in double, and rounded up to two digits. So they include every float rounding, not
+	just the polynomial's. Every float of magnitude 2^-8 and up in each range is tried (the worst
+	cases are single inputs, which sampling misses), plus LIBRARY_SAMPLES evenly spaced points for
+	the smaller ones. Takes a few seconds.
+*/
+#define LIBRARY_SAMPLES (1 << 22)
+#define LIBRARY_EVERY_FLOAT_FROM 0.00390625f
+
+// 2 significant digits, rounded up
+static double roundUp2(double v) {
+	if (!(v > 0)) return 0;
+	double step = pow(10, floor(log10(v)) - 1);
+	return ceil(v / step * (1 - 1e-12)) * step;
+}
+
+// the worst error(x) over x_min...x_max (see above)
+template <typename Error>
+static double measureFloats(float x_min, float x_max, Error error) {
+	double worst = 0;
+	for (int i = 0; i <= LIBRARY_SAMPLES; i++) worst = fmax(worst, error((float)(x_min + ((double)x_max - x_min) * i / LIBRARY_SAMPLES)));
+	for (int sign = -1; sign <= 1; sign += 2) {
+		float a_max = sign < 0 ? -x_min : x_max;
+		for (float a = LIBRARY_EVERY_FLOAT_FROM; a <= a_max; a = nextafterf(a, INFINITY)) {
+			float x = sign * a;
+			if (x >= x_min && x <= x_max) worst = fmax(worst, error(x));
+		}
+	}
+	return worst;
+}
+
+// expApprox(): relative error wherever e^x is a normal float
+static double measureExp(const FloatPoly& p) {
+	return measureFloats(-87.3f, 88.7f, [&](float x) {
+		double want = exp((double)x);
+		return want < FLT_MIN ? 0 : fabs(expWith(p, x) - want) / want;
+	});
+}
+
+// logApprox(): absolute error for x in 1/e...e, relative to ln(x) outside it (every float near 1, where
+// the error peaks, and samples evenly spaced in ln(x) beyond)
+static double measureLog(const FloatPoly& p) {
+	auto error = [&](float x) {
+		double want = log((double)x);
+		return fabs(logWith(p, x) - want) / fmax(1, fabs(want));
+	};
+	double worst = measureFloats(0.0625f, 16.0f, error);
+	const double ln_min = log(FLT_MIN), ln_max = log(FLT_MAX);
+	for (int i = 0; i <= LIBRARY_SAMPLES; i++) worst = fmax(worst, error((float)exp(ln_min + (ln_max - ln_min) * i / LIBRARY_SAMPLES)));
+	return worst;
+}
+
+// the worst absolute error of fast(x) vs exact(x) over x_min...x_max
+template <typename Fast, typename Exact>
+static double measureAbsolute(float x_min, float x_max, Fast fast, Exact exact) {
+	return measureFloats(x_min, x_max, [&](float x) { return fabs(fast(x) - exact((double)x)); });
+}
+
+static void printLibraryPoly(const char* prefix, const char* name, const char* comment, double x_min, double x_max,
+	is::ApproxErrorType error_type, const FloatPoly& p, double max_error) {
+	printf("// %s on [%.9g, %.9g]: degree %d minimax, max %s error %.3g in double\n", comment, x_min, x_max, p.deg,
+		error_type == is::APPROX_RELATIVE ? "relative" : "absolute", p.double_error);
+	printf("#define APPROX_%s_DEG %d\n", prefix, p.deg);
+	printf("#define APPROX_%s_T_SCALE %s\n", prefix, floatLiteral(p.t_scale));
+	printf("#define APPROX_%s_T_OFFSET %s\n", prefix, floatLiteral(p.t_offset));
+	printf("#define APPROX_%s_MAX_ERROR %.2g\n", prefix, roundUp2(max_error));
+	printf("static const float approx_%s_coeffs[APPROX_%s_DEG + 1] = {", name, prefix);
+	for (int i = 0; i <= p.deg; i++) printf("%s%s", i ? ", " : "", floatLiteral(p.coeffs[i]));
+	printf("};\n\n");
+}
+
+static int generateLibrary() {
+	FloatPoly pexp, plog;
+	const double exp_min = -M_LN2 / 2, exp_max = M_LN2 / 2, log_min = M_SQRT1_2, log_max = M_SQRT2;
+	if (!fitLibraryPoly("EXP", fExp, exp_min, exp_max, 5e-8, is::APPROX_RELATIVE, &pexp)
+		|| !fitLibraryPoly("LOG", fLog, log_min, log_max, 5e-8, is::APPROX_ABSOLUTE, &plog)) return 1;
+
+	printf("#pragma once\n\n");
+	printf("// Generated by tools/approxgen.cpp (approxgen --library): minimax coefficients for expApprox() and\n");
+	printf("// logApprox() in approx.h. Regenerate rather than edit. The MAX_ERRORs are measured in float, through\n");
+	printf("// approx.h's own code, over each function's whole range (see approxgen.cpp).\n\n");
+	printf("// expApprox(): max relative error APPROX_EXP_MAX_ERROR where e^x is a normal float\n");
+	printLibraryPoly("EXP", "exp", "e^r", exp_min, exp_max, is::APPROX_RELATIVE, pexp, measureExp(pexp));
+	printf("// logApprox(): max error APPROX_LOG_MAX_ERROR, absolute for x in 1/e...e, relative to ln(x) outside it\n");
+	printLibraryPoly("LOG", "log", "ln(m)", log_min, log_max, is::APPROX_ABSOLUTE, plog, measureLog(plog));
+
+	// the float functions built on them, written as in rc.cpp and sigmoid.cpp
+	printf("// max absolute errors of pcnt01OfnTauFast() for ntau >= 0 and nTauOfPcnt01Fast() for pcnt01 in 0...0.999 (rc.h)\n");
+	printf("#define APPROX_PCNT01OFNTAU_MAX_ERROR %.2g\n", roundUp2(measureAbsolute(0, 88.7,
+		[&](float ntau) { return 1 - expWith(pexp, -ntau); }, [](double ntau) { return -expm1(-ntau); })));
+	printf("#define APPROX_NTAUOFPCNT01_MAX_ERROR %.2g\n", roundUp2(measureAbsolute(0, 0.999,
+		[&](float pcnt01) { return -logWith(plog, 1 - pcnt01); }, [](double pcnt01) { return -log1p(-pcnt01); })));
+	printf("// max absolute errors of sigmoidFast() and sigmoid_n1_p1Fast() (sigmoid.h)\n");
+	printf("#define APPROX_SIGMOID_MAX_ERROR %.2g\n", roundUp2(measureAbsolute(-90, 90,
+		[&](float z) { return 1.0f / (1.0f + expWith(pexp, -z)); }, [](double z) { return 1 / (1 + exp(-z)); })));
+	printf("#define APPROX_SIGMOID_N1_P1_MAX_ERROR %.2g\n", roundUp2(measureAbsolute(-90, 90,
+		[&](float z) { return 2.0f / (1.0f + expWith(pexp, -z)) - 1.0f; }, [](double z) { return tanh(z / 2); })));
+	return 0;
+}
+
+static void usage() {
+	fprintf(stderr, "usage: approxgen --library\n"
+		"       approxgen FUNC --min A --max B (--error E | --deg N) [--relative] [--chebyshev] [--float]\n"
+		"FUNC is one of:");
+	for (const NamedFunc& nf : funcs) fprintf(stderr, " %s (%s),", nf.name, nf.description);
+	fprintf(stderr, "\n");
+}
+
+int main(int argc, char** argv) {
+	if (argc == 2 && !strcmp(argv[1], "--library")) return generateLibrary();
+	if (argc < 2) { usage(); return 1; }
+
+	const NamedFunc* nf = nullptr;
+	for (const NamedFunc& f : funcs) if (!strcmp(argv[1], f.name)) nf = &f;
+	if (!nf) { usage(); return 1; }
+
+	double x_min = NAN, x_max = NAN, target = 0;
+	int deg = -1;
+	bool relative = false, chebyshev = false, as_float = false;
+	for (int i = 2; i < argc; i++) {
+		if (!strcmp(argv[i], "--min") && i + 1 < argc) x_min = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--max") && i + 1 < argc) x_max = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--error") && i + 1 < argc) target = atof(argv[++i]);
+		else if (!strcmp(argv[i], "--deg") && i + 1 < argc) deg = atoi(argv[++i]);
+		else if (!strcmp(argv[i], "--relative")) relative = true;
+		else if (!strcmp(argv[i], "--chebyshev")) chebyshev = true;
+		else if (!strcmp(argv[i], "--float")) as_float = true;
+		else { usage(); return 1; }
+	}
+	if (!(x_max > x_min) || (deg < 0 && !(target > 0))) { usage(); return 1; }
+
+	is::ApproxErrorType type = relative ? is::APPROX_RELATIVE : is::APPROX_ABSOLUTE;
+	is::ApproxMethod method = chebyshev ? is::APPROX_CHEBYSHEV : is::APPROX_REMEZ;
+	is::PolyApprox a;
+	bool ok;
+	if (deg >= 0) {
+		ok = chebyshev ? is::approxChebyshev(nf->f, x_min, x_max, deg, &a, type) : is::approxRemez(nf->f, x_min, x_max, deg, &a, type);
+	} else {
+		ok = is::approxToError(nf->f, x_min, x_max, target, &a, method, type) >= 0;
+		if (!ok) fprintf(stderr, "approxgen: degree %d doesn't reach %g (best %.3g)\n", APPROX_MAX_DEG, target, a.max_error);
+	}
+	if (!ok && a.deg < 0) return 1;
+	printApprox(nf->name, a, chebyshev ? "Chebyshev" : "minimax", as_float);
+	return ok ? 0 : 1;
+}
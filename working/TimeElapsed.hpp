@@ -154,14 +154,6 @@ class TimeElapsed {
    * A) the .state() was not PAUSED or 
    * B) there was an overflow falure at some point (verify by ._elapsedOverflows() returning >0)*/ // DONE
   TimeElapsed_t resume(TimeElapsed_t time_now=1) {
-    if (update == 0) {
-      if (_elapsed_overflows) return 0;
-      else return _elapsed;
-    }
-    TimeElapsed_t tn;
-    if (update > 1) tn = update;
-    else tn = (*_time_func)();
-
     if (_state != PAUSED) return 0;
 
     // resume means we move all _tn_minus_t1 to _prev_elapsed
@@ -173,6 +165,7 @@ class TimeElapsed {
     // and start a new span of time starting now:
     if (time_now > 1) _t1 = _tn = time_now;
     else _t1 = _tn = (*_time_func)();
+    _state = RESUMED;
 
     return _elapsed_overflows ? 0 : _elapsed;
   }